@@ -29,6 +29,13 @@ def createParser():
                         default = False,
                         help = "Enable performance logging in target",
                         dest = "perf")
+    myParser.add_argument("-c",
+                        type = int,
+                        choices = range(1, 13),
+                        default = 6,
+                        help = "Number of cylinders, i.e. injection and ignition channels (default is 6)",
+                        metavar = "CYLINDERS",
+                        dest = "cylinders")
 
     return myParser
 
@@ -36,6 +43,7 @@ def createParser():
 
 def checkArgs(args):
     log.info("Building for platform " + args.platform)
+    log.info("Building for " + str(args.cylinders) + " cylinders")
     if args.upload == '0':
         log.info("No upload")
     else:
@@ -51,7 +59,7 @@ checkArgs(args)
 # create ems build directory
 log.status("Creating EMS build directory...")
 buildPath = buildpath.ensureBuildPath(args.platform, app, appHal)
-buildpath.writeMakefile(os.path.basename(__file__), args.platform, app, "", appHal, args.log, args.debug, args.perf, args.speed)
+buildpath.writeMakefile(os.path.basename(__file__), args.platform, app, ["CPPFLAGS += -D__CYLINDERS__=" + str(args.cylinders)], appHal, args.log, args.debug, args.perf, args.speed)
 
 # build arch-dep
 # build BSP for ems
@@ -51,6 +51,8 @@ checkArgs(args)
 # create ems build directory
 log.status("Creating uBench build directory...")
 buildPath = buildpath.ensureBuildPath(args.platform, app, appHal)
+# uBench builds the EMS sources as well, see embedded/ubench/files.mk
+buildpath.ensureDirectoryExists(buildPath + '/ems')
 buildpath.writeMakefile(os.path.basename(__file__), args.platform, app, "", appHal, args.log, args.debug, args.perf)
 
 # build arch-dep
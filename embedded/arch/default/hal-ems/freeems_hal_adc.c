@@ -0,0 +1,164 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief Scripted stand-in for the ADC acquisition.
+ * There is no ADC on the host. Instead every scan is taken from the next line
+ * of the text file named by the environment variable EMS_ADC_SCRIPT, each line
+ * holding up to HAL_ADC_CHANNELS readings separated by white space. Lines
+ * starting with '#' are skipped and the script starts over at its end.
+ * Without a script all readings are zero. The script is read completely by
+ * hal_system_init(), the scans taken in ISR context only copy from memory.
+ * @file freeems_hal_adc.c
+ */
+#include <hal/ems/freeems_hal.h>
+#include <hal/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freeems_hal_globals.h"
+
+#define HAL_ADC_SCRIPT_ENV "EMS_ADC_SCRIPT"
+#define HAL_ADC_LINE_LENGTH 256
+
+static uint16_t hal_adc_buffers[HAL_ADC_BUFFERS][HAL_ADC_CHANNELS];
+static uint8_t hal_adc_holds[HAL_ADC_BUFFERS];
+static uint8_t hal_adc_latest;
+
+#define HAL_ADC_SCRIPT_CHUNK 64
+
+/* The data lines of the script, loaded at start-up */
+static uint16_t (*hal_adc_script)[HAL_ADC_CHANNELS];
+static size_t hal_adc_script_lines;
+static size_t hal_adc_script_next;
+
+
+/**
+ * Parses one data line of the script, missing readings are zero and readings
+ * above HAL_ADC_MAX are clamped to it.
+ */
+static void hal_priv_adc_script_parse(const char* line, uint16_t* dest) {
+  const char* pos = line;
+  uint8_t channel;
+  for (channel = 0; channel < HAL_ADC_CHANNELS; channel++) {
+    char* end;
+    unsigned long value = strtoul(pos, &end, 0);
+    if (end == pos) {
+      value = 0;
+    }
+    if (value > HAL_ADC_MAX) {
+      value = HAL_ADC_MAX;
+    }
+    dest[channel] = (uint16_t)value;
+    pos = end;
+  }
+}
+
+
+void hal_priv_adc_setup(void) {
+  const char* name = getenv(HAL_ADC_SCRIPT_ENV);
+  if (name == NULL) {
+    return;
+  }
+  FILE* script = fopen(name, "r");
+  if (script == NULL) {
+    log_printf("Cannot open ADC script %s\n", name);
+    return;
+  }
+
+  char line[HAL_ADC_LINE_LENGTH];
+  size_t capacity = 0;
+  while (fgets(line, sizeof(line), script) != NULL) {
+    if ((line[0] == '#') || (line[0] == '\n')) {
+      continue;
+    }
+    if (hal_adc_script_lines == capacity) {
+      capacity += HAL_ADC_SCRIPT_CHUNK;
+      void* grown = realloc(hal_adc_script, capacity * sizeof(*hal_adc_script));
+      if (grown == NULL) {
+        log_printf("ADC script %s truncated to %lu lines\n", name,
+                   (unsigned long)hal_adc_script_lines);
+        break;
+      }
+      hal_adc_script = grown;
+    }
+    hal_priv_adc_script_parse(line, hal_adc_script[hal_adc_script_lines++]);
+  }
+  fclose(script);
+}
+
+
+/**
+ * Copies the next scan of the script into dest, leaves dest untouched if
+ * there is no script.
+ */
+static void hal_priv_adc_script_next(uint16_t* dest) {
+  if (hal_adc_script_lines == 0) {
+    return;
+  }
+  memcpy(dest, hal_adc_script[hal_adc_script_next], sizeof(*hal_adc_script));
+  if (++hal_adc_script_next == hal_adc_script_lines) {
+    hal_adc_script_next = 0;
+  }
+}
+
+
+/**
+ * Performs one "scan" into a buffer that is neither latest nor held.
+ */
+static void hal_priv_adc_scan(void) {
+  uint8_t index;
+  for (index = 0; index < HAL_ADC_BUFFERS; index++) {
+    if ((index != hal_adc_latest) && (hal_adc_holds[index] == 0)) {
+      break;
+    }
+  }
+  if (index == HAL_ADC_BUFFERS) {
+    log_printf("ADC buffers exhausted\n");
+    return;
+  }
+  memcpy(hal_adc_buffers[index], hal_adc_buffers[hal_adc_latest],
+         sizeof(hal_adc_buffers[index]));
+  hal_priv_adc_script_next(hal_adc_buffers[index]);
+  hal_adc_latest = index;
+}
+
+
+uint8_t hal_adc_acquire(void) {
+  hal_priv_adc_scan();
+  hal_adc_holds[hal_adc_latest]++;
+  return hal_adc_latest;
+}
+
+
+void hal_adc_release(uint8_t index) {
+  if ((index < HAL_ADC_BUFFERS) && (hal_adc_holds[index] > 0)) {
+    hal_adc_holds[index]--;
+  }
+}
+
+
+const volatile uint16_t* hal_adc_buffer(uint8_t index) {
+  return hal_adc_buffers[index];
+}
+
+
+void hal_adc_read(uint16_t* dest) {
+  hal_priv_adc_scan();
+  memcpy(dest, hal_adc_buffers[hal_adc_latest], sizeof(hal_adc_buffers[0]));
+}
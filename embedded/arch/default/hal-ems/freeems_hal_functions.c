@@ -24,8 +24,11 @@
  * Florian Kluge <kluge@informatik.uni-augsburg.de>
  */
 #include <hal/ems/freeems_hal.h>
+#include <hal/trace.h>
+#include <time.h>
 #include "freeems_hal_globals.h"
 #include "freeems_hal_macros.h"
+#include "hal_freeems_interface.h"
 
 /**
  * This array is used to store the current interval times of the ignition
@@ -68,6 +71,41 @@ hal_timer_ic_capture_get (channelid_t channel_id) {
   return 0;
 }
 
+/**
+ * Extend a 16 bit time stamp that lies in the past (at most one timer period)
+ * to 32 bit by subtracting its age from the current 32 bit time. This is the
+ * software fallback for platforms without a 32 bit reference timer.
+ */
+static uint32_t
+hal_internal_time_extend (uint16_t timeStamp) {
+  uint32_t now = hal_timer_time_get32();
+  return now - (uint16_t)((uint16_t)now - timeStamp);
+}
+
+uint32_t
+hal_timer_time_get32 (void) {
+  uint16_t high;
+  uint16_t low;
+  bool pending;
+  /* retry if TimerOverflow() ran in between */
+  do {
+    high = timerExtensionClock;
+    low = hal_timer_time_get();
+    pending = hal_timer_overflow_get();
+  } while (high != timerExtensionClock);
+  /* the counter wrapped before it was read, but the overflow is not yet
+   * accounted for */
+  if (pending && !(low & 0x8000)) {
+    high++;
+  }
+  return ((uint32_t)high << 16) | low;
+}
+
+uint32_t
+hal_timer_ic_capture_get32 (channelid_t channel_id) {
+  return hal_internal_time_extend(hal_timer_ic_capture_get(channel_id));
+}
+
 pinstate_t
 hal_timer_ic_pin_get (channelid_t channel_id) {
   return false;
@@ -87,8 +125,36 @@ void
 hal_timer_oc_active_set (channelid_t channel_id, bool active) {
 }
 
+/*
+ * There is no output compare hardware. The level an injection output is
+ * programmed to is traced when its compare value is set, see hal/trace.h.
+ */
+static ocmode_t hal_trace_oc_modes[HAL_INJECTION_CHANNELS_MAX];
+static bool hal_trace_oc_levels[HAL_INJECTION_CHANNELS_MAX];
+
 void
 hal_timer_oc_compare_set (channelid_t channel_id, uint16_t value) {
+  uint8_t signal = hal_priv_trace_signal(channel_id);
+  if ((signal == HAL_TRACE_NO_SIGNAL)
+      || (signal < HAL_TRACE_SIGNAL_INJECTION1)) {
+    return;
+  }
+  uint8_t channel = signal - HAL_TRACE_SIGNAL_INJECTION1;
+  switch (hal_trace_oc_modes[channel]) {
+  case OC_MODE_TO_HIGH:
+    hal_trace_oc_levels[channel] = true;
+    break;
+  case OC_MODE_TO_LOW:
+    hal_trace_oc_levels[channel] = false;
+    break;
+  case OC_MODE_TOGGLE:
+    hal_trace_oc_levels[channel] = !hal_trace_oc_levels[channel];
+    break;
+  default:
+    return;
+  }
+  hal_trace_vcd_set(signal, hal_trace_oc_levels[channel],
+                    hal_trace_host_time());
 }
 
 uint16_t
@@ -96,8 +162,18 @@ hal_timer_oc_compare_get (channelid_t channel_id) {
   return 0;
 }
 
+uint32_t
+hal_timer_oc_compare_get32 (channelid_t channel_id) {
+  return hal_internal_time_extend(hal_timer_oc_compare_get(channel_id));
+}
+
 void
 hal_timer_oc_output_set (channelid_t channel_id, ocmode_t mode) {
+  uint8_t signal = hal_priv_trace_signal(channel_id);
+  if ((signal != HAL_TRACE_NO_SIGNAL)
+      && (signal >= HAL_TRACE_SIGNAL_INJECTION1)) {
+    hal_trace_oc_modes[signal - HAL_TRACE_SIGNAL_INJECTION1] = mode;
+  }
 }
 
 void
@@ -130,6 +206,22 @@ hal_io_get (channelid_t channel_id) {
 
 void
 hal_io_set (channelid_t channel_id, pinstate_t value) {
+  uint8_t signal = hal_priv_trace_signal(channel_id);
+  if (signal != HAL_TRACE_NO_SIGNAL) {
+    hal_trace_vcd_set(signal, value == HIGH, hal_trace_host_time());
+  }
+}
+
+/**
+ * The host HAL never calls an ISR, so there is nothing to wake up early for.
+ * Sleeping one RTC period keeps the main loop polling at that rate. The
+ * monotonic clock is used so that changes of the wall clock do not stretch
+ * or skip the wait.
+ */
+void
+hal_system_idle (void) {
+  static const struct timespec period = { 0, 125000 }; /* one RTC period */
+  clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
 }
 
 void
@@ -141,3 +233,45 @@ hal_performance_stopCounter () {
   return 0;
 }
 
+unsigned int
+hal_performance_stopCounterNested (unsigned int* inclusive) {
+  if (inclusive != NULL) {
+    *inclusive = 0;
+  }
+  return 0;
+}
+
+/*
+ * The regions are shown as slices in the trace event file, the ISRs on one
+ * track and the main loop stages on another.
+ */
+static const char* const hal_trace_region_names[PERF_REGIONS] = PERF_REGION_NAMES;
+
+static uint8_t
+hal_priv_trace_thread (uint8_t region) {
+  return (region >= PERF_REGION_PRIMARY_RPM) ? HAL_TRACE_THREAD_ISR
+         : HAL_TRACE_THREAD_MAIN;
+}
+
+void
+hal_performance_regionBegin (uint8_t region) {
+  if ((region != PERF_REGION_NONE) && (region < PERF_REGIONS)) {
+    hal_trace_events_begin(hal_trace_region_names[region],
+                           (region >= PERF_REGION_PRIMARY_RPM) ? "isr" : "main",
+                           hal_priv_trace_thread(region), hal_trace_host_time());
+  }
+}
+
+void
+hal_performance_regionEnd (uint8_t region) {
+  if ((region != PERF_REGION_NONE) && (region < PERF_REGIONS)) {
+    hal_trace_events_end(hal_priv_trace_thread(region), hal_trace_host_time());
+  }
+}
+
+bool
+hal_performance_regionRead (uint8_t region, uint64_t* cycles,
+                            uint32_t* entries) {
+  return false;
+}
+
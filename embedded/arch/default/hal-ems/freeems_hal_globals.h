@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <hal/ems/hal_io.h>
 
 volatile uint16_t TIM2_CCR3_LAST;
 volatile uint16_t TIM2_CCR3_NEXT;
@@ -37,6 +38,28 @@ volatile uint16_t TIM2_CCR4_LAST;
 volatile uint16_t TIM2_CCR4_NEXT;
 volatile bool TIM2_CCR4_SET;
 
+/**
+ * Loads the ADC script named by EMS_ADC_SCRIPT, see freeems_hal_adc.c.
+ */
+void hal_priv_adc_setup(void);
+
+/*
+ * VCD signals: the ignition outputs, DEBUG_OUTPUT_1 to DEBUG_OUTPUT_8, then
+ * the injection outputs
+ */
+#define HAL_TRACE_SIGNALS ((2 * HAL_INJECTION_CHANNELS_MAX) + 8)
+#define HAL_TRACE_SIGNAL_INJECTION1 (HAL_INJECTION_CHANNELS_MAX + 8)
+#define HAL_TRACE_NO_SIGNAL 0xFF
+
+/* Tracks of the trace event file */
+#define HAL_TRACE_THREAD_MAIN 1
+#define HAL_TRACE_THREAD_ISR 2
+
+/**
+ * @return the VCD signal of an output, HAL_TRACE_NO_SIGNAL if it has none
+ */
+uint8_t hal_priv_trace_signal(channelid_t channel_id);
+
 //channelid_t injectionOutputChannels[] = {INJECTION1_OUTPUT,INJECTION2_OUTPUT,INJECTION3_OUTPUT,INJECTION4_OUTPUT,INJECTION5_OUTPUT,INJECTION6_OUTPUT,INJECTION7_OUTPUT,INJECTION8_OUTPUT};
 //channelid_t ignitionChannels[] = {IGNITION1_OUTPUT,IGNITION2_OUTPUT,IGNITION3_OUTPUT,IGNITION4_OUTPUT,IGNITION5_OUTPUT,IGNITION6_OUTPUT,IGNITION7_OUTPUT,IGNITION8_OUTPUT};
 
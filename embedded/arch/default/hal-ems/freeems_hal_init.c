@@ -24,6 +24,11 @@
  * Florian Kluge <kluge@informatik.uni-augsburg.de>
  */
 #include <hal/ems/freeems_hal.h>
+#include <hal/trace.h>
+#include "freeems_hal_globals.h"
+
+#define HAL_TRACE_VCD_ENV "EMS_VCD_OUT"
+#define HAL_TRACE_EVENTS_ENV "EMS_TRACE_OUT"
 
 /**** Setup functions */
 
@@ -39,13 +44,57 @@ static void hal_priv_gpio_setup() {
 static void hal_priv_isr_setup() {
 }
 
+/*
+ * Optional VCD and trace event files, see hal/trace.h. The VCD has the
+ * outputs driven through hal_io_set(): first the ignition channels, then the
+ * debug outputs. The injection channels follow, driven by the programmed
+ * output compares.
+ */
+static const char* const hal_trace_signal_names[HAL_TRACE_SIGNALS] = {
+  "ignition1", "ignition2", "ignition3", "ignition4", "ignition5",
+  "ignition6", "ignition7", "ignition8", "ignition9", "ignition10",
+  "ignition11", "ignition12",
+  "debug1", "debug2", "debug3", "debug4", "debug5", "debug6", "debug7",
+  "debug8",
+  "injection1", "injection2", "injection3", "injection4", "injection5",
+  "injection6", "injection7", "injection8", "injection9", "injection10",
+  "injection11", "injection12"
+};
+
+static void hal_priv_trace_setup() {
+  hal_trace_host_time();
+  hal_trace_vcd_open(HAL_TRACE_VCD_ENV, "ems", hal_trace_signal_names,
+                     HAL_TRACE_SIGNALS);
+  if (hal_trace_events_open(HAL_TRACE_EVENTS_ENV)) {
+    hal_trace_events_thread(HAL_TRACE_THREAD_MAIN, "main loop");
+    hal_trace_events_thread(HAL_TRACE_THREAD_ISR, "ISRs");
+  }
+}
+
+uint8_t hal_priv_trace_signal(channelid_t channel_id) {
+  if ((channel_id >= IGNITION1_OUTPUT)
+      && (channel_id < IGNITION1_OUTPUT + HAL_INJECTION_CHANNELS_MAX)) {
+    return channel_id - IGNITION1_OUTPUT;
+  }
+  if ((channel_id >= DEBUG_OUTPUT_1) && (channel_id <= DEBUG_OUTPUT_8)) {
+    return HAL_INJECTION_CHANNELS_MAX + (channel_id - DEBUG_OUTPUT_1);
+  }
+  if ((channel_id >= INJECTION1_OUTPUT)
+      && (channel_id < INJECTION1_OUTPUT + HAL_INJECTION_CHANNELS_MAX)) {
+    return HAL_TRACE_SIGNAL_INJECTION1 + (channel_id - INJECTION1_OUTPUT);
+  }
+  return HAL_TRACE_NO_SIGNAL;
+}
+
 void hal_system_clock(void) {
 }
 
 void hal_system_init(void) {
+  hal_priv_adc_setup();
 }
 
 void hal_system_start(void) {
+  hal_priv_trace_setup();
   hal_priv_timer_setup();
   hal_priv_gpio_setup();
   hal_priv_isr_setup();
@@ -0,0 +1,55 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief Stand-in for the serial transmission.
+ * Frames are appended to the file named by the environment variable
+ * EMS_SERIAL_OUT, or dropped without it. Either way the transmission is
+ * complete before hal_serial_transmit() returns.
+ * @file freeems_hal_serial.c
+ */
+#include <hal/ems/freeems_hal.h>
+#include <hal/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_freeems_interface.h"
+
+#define HAL_SERIAL_OUT_ENV "EMS_SERIAL_OUT"
+
+static FILE* hal_serial_out;
+static bool hal_serial_out_opened;
+
+
+void hal_serial_transmit(const uint8_t* data, uint16_t length) {
+  if (!hal_serial_out_opened) {
+    hal_serial_out_opened = true;
+    const char* name = getenv(HAL_SERIAL_OUT_ENV);
+    if (name != NULL) {
+      hal_serial_out = fopen(name, "wb");
+      if (hal_serial_out == NULL) {
+        log_printf("Cannot open serial output %s\n", name);
+      }
+    }
+  }
+  if (hal_serial_out != NULL) {
+    fwrite(data, 1, length, hal_serial_out);
+    fflush(hal_serial_out);
+  }
+  SCI0TXCompleteISR();
+}
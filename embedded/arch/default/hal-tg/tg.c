@@ -26,6 +26,7 @@
  */
 #include <hal/tg/tg.h>
 #include <hal/log.h>
+#include <hal/trace.h>
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -42,6 +43,23 @@ static bool state_secondary = false;
 
 static bool finished = false;
 
+/* Counter ticks before time_current, which wraps */
+static uint64_t time_epoch = 0;
+
+#define TG_VCD_ENV "TG_VCD_OUT"
+#define TG_TRACE_ENV "TG_TRACE_OUT"
+#define TG_SIGNAL_PRIMARY 0
+#define TG_SIGNAL_SECONDARY 1
+#define TG_THREAD 1
+
+static const char* const tg_signal_names[] = { "primary", "secondary" };
+
+
+/* Simulated time in ns, the handlers do not advance it */
+static uint64_t trace_time() {
+  return ((time_epoch + time_current) * 1000000000ULL) / TICKS_PER_SECOND;
+}
+
 
 static void set_state(bool *state, oc_mode_t mode) {
   switch (mode) {
@@ -62,6 +80,9 @@ static void set_state(bool *state, oc_mode_t mode) {
 
 void hal_tg_setup() {
   printf("HAL-TG setup\n");
+  hal_trace_vcd_open(TG_VCD_ENV, "tg", tg_signal_names, 2);
+  hal_trace_events_open(TG_TRACE_ENV);
+  hal_trace_events_thread(TG_THREAD, "tg");
 }
 
 
@@ -75,6 +96,8 @@ void hal_tg_run() {
          ( time_secondary <= time_current || time_primary <= time_secondary) ) {
       time_current = time_primary;
       set_state(&state_primary, mode_primary);
+      hal_trace_vcd_set(TG_SIGNAL_PRIMARY, state_primary, trace_time());
+      hal_trace_events_instant("primary", "isr", TG_THREAD, trace_time());
       handle_primary(state_primary);
     }
     else
@@ -82,10 +105,13 @@ void hal_tg_run() {
           time_secondary < time_primary ) { // 2nd condition should be true anyway if we come here
         time_current = time_secondary;
         set_state(&state_secondary, mode_secondary);
+        hal_trace_vcd_set(TG_SIGNAL_SECONDARY, state_secondary, trace_time());
+        hal_trace_events_instant("secondary", "isr", TG_THREAD, trace_time());
         handle_secondary(state_secondary);
       }
       else {
         // nothing found, seems we are running into an overflow, so reset time
+        time_epoch += (uint64_t)UINT16_MAX + 1;
         time_current = 0;
       }
     //if (++ctr > 40) return;
@@ -1,6 +1,6 @@
 # $Id: files.mk 366 2015-09-09 09:36:11Z klugeflo $
 # List all hal source files
 
-HAL_C_SRC = hal.c
+HAL_C_SRC = hal.c trace.c
 HAL_S_SRC = 
 HAL_SUPP_S_SRC = 
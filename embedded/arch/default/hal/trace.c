@@ -0,0 +1,233 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file trace.c
+ * @brief Writers for VCD and trace event files, see hal/trace.h
+ */
+
+#include <hal/trace.h>
+#include <hal/log.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* VCD identifiers are printable characters from '!' on */
+#define HAL_TRACE_VCD_ID(signal) ((char)('!' + (signal)))
+
+static FILE* hal_trace_vcd;
+static uint8_t hal_trace_vcd_count;
+static int8_t hal_trace_vcd_levels[HAL_TRACE_VCD_SIGNALS];
+static uint64_t hal_trace_vcd_time;
+
+static FILE* hal_trace_events;
+static bool hal_trace_events_first = true;
+
+static bool hal_trace_exit_registered;
+static unsigned int hal_trace_records;
+static uint64_t hal_trace_flushed;
+
+
+static void hal_trace_close(void) {
+  if (hal_trace_vcd != NULL) {
+    fclose(hal_trace_vcd);
+    hal_trace_vcd = NULL;
+  }
+  if (hal_trace_events != NULL) {
+    fputs("\n]\n", hal_trace_events);
+    fclose(hal_trace_events);
+    hal_trace_events = NULL;
+  }
+}
+
+
+static FILE* hal_trace_open(const char* env) {
+  const char* name = getenv(env);
+  if (name == NULL) {
+    return NULL;
+  }
+  FILE* file = fopen(name, "w");
+  if (file == NULL) {
+    log_printf("Cannot open trace output %s\n", name);
+    return NULL;
+  }
+  setvbuf(file, NULL, _IOFBF, HAL_TRACE_BUFFER_SIZE);
+  if (!hal_trace_exit_registered) {
+    atexit(hal_trace_close);
+    hal_trace_exit_registered = true;
+  }
+  return file;
+}
+
+
+/* Flush both files if the last flush is more than a second ago */
+static void hal_trace_record(void) {
+  if (++hal_trace_records < HAL_TRACE_FLUSH_CHECK) {
+    return;
+  }
+  hal_trace_records = 0;
+  uint64_t now = hal_trace_host_time();
+  if (now - hal_trace_flushed >= 1000000000ULL) {
+    hal_trace_flushed = now;
+    if (hal_trace_vcd != NULL) {
+      fflush(hal_trace_vcd);
+    }
+    if (hal_trace_events != NULL) {
+      fflush(hal_trace_events);
+    }
+  }
+}
+
+
+bool hal_trace_vcd_open(const char* env, const char* scope,
+                        const char* const* names, uint8_t count) {
+  if (count > HAL_TRACE_VCD_SIGNALS) {
+    count = HAL_TRACE_VCD_SIGNALS;
+  }
+  hal_trace_vcd = hal_trace_open(env);
+  if (hal_trace_vcd == NULL) {
+    return false;
+  }
+  hal_trace_vcd_count = count;
+
+  fputs("$timescale 1 ns $end\n", hal_trace_vcd);
+  fprintf(hal_trace_vcd, "$scope module %s $end\n", scope);
+  uint8_t signal;
+  for (signal = 0; signal < count; signal++) {
+    fprintf(hal_trace_vcd, "$var wire 1 %c %s $end\n",
+            HAL_TRACE_VCD_ID(signal), names[signal]);
+  }
+  fputs("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n", hal_trace_vcd);
+  for (signal = 0; signal < count; signal++) {
+    fprintf(hal_trace_vcd, "0%c\n", HAL_TRACE_VCD_ID(signal));
+    hal_trace_vcd_levels[signal] = 0;
+  }
+  fputs("$end\n", hal_trace_vcd);
+  hal_trace_vcd_time = 0;
+  return true;
+}
+
+
+void hal_trace_vcd_set(uint8_t signal, bool level, uint64_t time) {
+  if ((hal_trace_vcd == NULL) || (signal >= hal_trace_vcd_count)
+      || (hal_trace_vcd_levels[signal] == level)) {
+    return;
+  }
+  if (time > hal_trace_vcd_time) {
+    fprintf(hal_trace_vcd, "#%llu\n", (unsigned long long)time);
+    hal_trace_vcd_time = time;
+  }
+  fprintf(hal_trace_vcd, "%c%c\n", level ? '1' : '0', HAL_TRACE_VCD_ID(signal));
+  hal_trace_vcd_levels[signal] = level;
+  hal_trace_record();
+}
+
+
+bool hal_trace_events_open(const char* env) {
+  hal_trace_events = hal_trace_open(env);
+  if (hal_trace_events == NULL) {
+    return false;
+  }
+  fputs("[\n", hal_trace_events);
+  hal_trace_events_first = true;
+  return true;
+}
+
+
+static void hal_trace_events_separate(void) {
+  if (!hal_trace_events_first) {
+    fputs(",\n", hal_trace_events);
+  }
+  hal_trace_events_first = false;
+}
+
+
+void hal_trace_events_begin(const char* name, const char* category,
+                            uint8_t thread, uint64_t time) {
+  if (hal_trace_events == NULL) {
+    return;
+  }
+  hal_trace_events_separate();
+  /* ts is in microseconds */
+  fprintf(hal_trace_events,
+          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"B\",\"ts\":%llu.%03u,"
+          "\"pid\":1,\"tid\":%u}",
+          name, category, (unsigned long long)(time / 1000),
+          (unsigned int)(time % 1000), thread);
+  hal_trace_record();
+}
+
+
+void hal_trace_events_end(uint8_t thread, uint64_t time) {
+  if (hal_trace_events == NULL) {
+    return;
+  }
+  hal_trace_events_separate();
+  fprintf(hal_trace_events,
+          "{\"ph\":\"E\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u}",
+          (unsigned long long)(time / 1000), (unsigned int)(time % 1000),
+          thread);
+  hal_trace_record();
+}
+
+
+void hal_trace_events_instant(const char* name, const char* category,
+                              uint8_t thread, uint64_t time) {
+  if (hal_trace_events == NULL) {
+    return;
+  }
+  hal_trace_events_separate();
+  fprintf(hal_trace_events,
+          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+          "\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u}",
+          name, category, (unsigned long long)(time / 1000),
+          (unsigned int)(time % 1000), thread);
+  hal_trace_record();
+}
+
+
+void hal_trace_events_thread(uint8_t thread, const char* name) {
+  if (hal_trace_events == NULL) {
+    return;
+  }
+  hal_trace_events_separate();
+  fprintf(hal_trace_events,
+          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+          "\"args\":{\"name\":\"%s\"}}", thread, name);
+}
+
+
+bool hal_trace_enabled(void) {
+  return (hal_trace_vcd != NULL) || (hal_trace_events != NULL);
+}
+
+
+uint64_t hal_trace_host_time(void) {
+  static bool started;
+  static struct timespec start;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!started) {
+    start = now;
+    started = true;
+  }
+  return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL
+         + (uint64_t)now.tv_nsec - (uint64_t)start.tv_nsec;
+}
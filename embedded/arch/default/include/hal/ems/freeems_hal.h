@@ -42,6 +42,8 @@
 #include "hal_timer_pit.h"
 #include "hal_logging.h"
 #include "hal_performance.h"
+#include "hal_adc.h"
+#include "hal_serial.h"
 
 /**
  * @author Andreas Meixner
@@ -91,6 +91,16 @@ extern void hal_timer_oc_active_set(channelid_t channel_id, bool active);
  */
 extern uint16_t hal_timer_oc_compare_get(channelid_t channel_id);
 
+/**
+ * Returns the compare value of the output compare channel in the 32 bit time
+ * base of hal_timer_time_get32(). Only meaningful for a compare event that
+ * has already happened, e.g. from within the channel's ISR, and that is not
+ * older than one period of the 16 bit timer.
+ * @param channel_id The output compare channel id.
+ * @return 32 bit time stamp of the compare event.
+ */
+extern uint32_t hal_timer_oc_compare_get32(channelid_t channel_id);
+
 /**
  * @author Andreas Meixner
  * Changes the output compare value of a channel.
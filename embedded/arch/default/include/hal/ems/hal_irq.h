@@ -38,4 +38,14 @@
  */
 #define ATOMIC_END()
 
+/**
+ * @brief Wait for the next interrupt.
+ * Has to be called between ATOMIC_START() and ATOMIC_END() after checking
+ * that there is nothing left to do. Returns as soon as an interrupt is
+ * pending, with interrupts still locked; the interrupt is served after
+ * ATOMIC_END(). Locking prevents an interrupt that arrives between the check
+ * and the wait from being missed. May return early.
+ */
+extern void hal_system_idle(void);
+
 #endif // !HAL_EMS_HAL_IRQ_H
@@ -80,7 +80,13 @@
 #define perf_printf(args...) ((void)0)
 #endif
 
+#ifdef __PERF__
+/* Drains the ring filled by the PERF_WRAP wrappers, see ems/performance.h */
+extern void perf_ring_output(void);
+#define output_performance_log() perf_ring_output()
+#else
 #define output_performance_log() ((void)0)
+#endif
 
 
 #endif // !HAL_LOG_H
@@ -0,0 +1,140 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief Waveform and trace event files written by the host HALs.
+ *
+ * Both writers are optional, each is enabled by an environment variable that
+ * names its output file. The files are written through large stdio buffers
+ * while the program runs, so long simulations are not slowed down by the
+ * output. The buffers are flushed about once a second, so a program that is
+ * killed loses at most the last second; the closing bracket of the trace
+ * event file is then missing, which the viewers accept. The writers are not
+ * thread safe.
+ *
+ * - VCD: one wire per signal, timescale 1 ns, for any waveform viewer.
+ * - Trace events: begin/end slices and instant events in the JSON format of
+ *   chrome://tracing and Perfetto.
+ *
+ * The trace generator writes its files in simulated time, derived from its
+ * timer ticks. Its edges are instant events, the handlers take no simulated
+ * time.
+ *
+ * The EMS writes its files in host time, see hal_trace_host_time(), so the
+ * files of both cannot be aligned. The host EMS HAL never calls an ISR, so
+ * the EMS trace only shows the main loop stages (built with -D__PERF__) and
+ * the debug outputs. The ISR track and the ignition and injection wires stay
+ * empty. The injection wires show the level an output compare was programmed
+ * to, at the host time it was programmed, not at its compare time.
+ */
+
+#ifndef HAL_TRACE_H
+#define HAL_TRACE_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Size of the stdio buffer of each file
+ */
+#ifndef HAL_TRACE_BUFFER_SIZE
+#define HAL_TRACE_BUFFER_SIZE (1024 * 1024)
+#endif
+
+/**
+ * @brief Number of records after which the time since the last flush is
+ *        checked
+ */
+#define HAL_TRACE_FLUSH_CHECK 4096
+
+/**
+ * @brief Largest number of VCD signals
+ */
+#define HAL_TRACE_VCD_SIGNALS 64
+
+/**
+ * @brief Open the VCD file named by the environment variable env
+ * @param env name of the environment variable
+ * @param scope name of the scope the signals are put in
+ * @param names signal names, the index is the signal number
+ * @param count number of signals, at most HAL_TRACE_VCD_SIGNALS
+ * @return true if the file is written
+ */
+bool hal_trace_vcd_open(const char* env, const char* scope,
+                        const char* const* names, uint8_t count);
+
+/**
+ * @brief Record the level of a signal, nothing is written if it did not
+ *        change. Times must not decrease.
+ * @param signal signal number
+ * @param level new level
+ * @param time time stamp in ns
+ */
+void hal_trace_vcd_set(uint8_t signal, bool level, uint64_t time);
+
+/**
+ * @brief Open the trace event file named by the environment variable env
+ * @param env name of the environment variable
+ * @return true if the file is written
+ */
+bool hal_trace_events_open(const char* env);
+
+/**
+ * @brief Begin a slice, slices on the same thread must nest
+ * @param name name of the slice
+ * @param category category of the slice
+ * @param thread thread (track) the slice is shown on
+ * @param time time stamp in ns
+ */
+void hal_trace_events_begin(const char* name, const char* category,
+                            uint8_t thread, uint64_t time);
+
+/**
+ * @brief End the innermost open slice of a thread
+ * @param thread thread (track) given to hal_trace_events_begin()
+ * @param time time stamp in ns
+ */
+void hal_trace_events_end(uint8_t thread, uint64_t time);
+
+/**
+ * @brief Record an instant event
+ * @param name name of the event
+ * @param category category of the event
+ * @param thread thread (track) the event is shown on
+ * @param time time stamp in ns
+ */
+void hal_trace_events_instant(const char* name, const char* category,
+                              uint8_t thread, uint64_t time);
+
+/**
+ * @brief Name a thread (track) in the trace event file
+ */
+void hal_trace_events_thread(uint8_t thread, const char* name);
+
+/**
+ * @return true if one of the files is written
+ */
+bool hal_trace_enabled(void);
+
+/**
+ * @return nanoseconds since the first call, from the monotonic host clock
+ */
+uint64_t hal_trace_host_time(void);
+
+#endif // !HAL_TRACE_H
@@ -157,34 +157,42 @@ extern "C" {
  * @brief Starts the specified counter.
  * @param counter Specifies the counter to start.
  */
-#define PCC_START(counter) IOWR32(A_PCC, ((counter * 4) + 1)*4, 0)
+#define PCC_START(counter) IOWR32(A_PCC, (((counter) * 4) + 1) * 4, 0)
 /**
  * @author Andreas Meixner
  * @brief Stops the specified counter.
  * @param counter Specifies the counter to stop.
  */
-#define PCC_STOP(counter) IOWR32(A_PCC, counter * 4, 0)
+#define PCC_STOP(counter) IOWR32(A_PCC, (counter) * 16, 0)
 /**
  * @author Andreas Meixner
  * @brief Gets the lower 31 bits of the current value of the specified counter.
  * @param counter Specifies the counter to for which to return the current value.
  * @return The lower portion (31bit) of the current counter value.
  */
-#define PCC_GET_LOW(counter) (unsigned int)IORD32(A_PCC, counter * 4)
+#define PCC_GET_LOW(counter) (unsigned int)IORD32(A_PCC, (counter) * 16)
 /**
  * @author Andreas Meixner
  * @brief Gets the higher 31 bits of the current value of the specified counter.
  * @param counter Specifies the counter to for which to return the current value.
  * @return The higher portion (31bit) of the current counter value.
  */
-#define PCC_GET_HIGH(counter) (unsigned int)IORD32(A_PCC, counter * 4)
+#define PCC_GET_HIGH(counter) (unsigned int)IORD32(A_PCC, ((counter) * 16) + 4)
 /**
  * @author Andreas Meixner
  * @brief Gets the current value of the specified counter.
  * @param counter Specifies the counter to for which to return the current value.
  * @return The full 62 bit value of the current counter.
  */
-#define PCC_GET(counter) ((unsigned long int)PCC_GET_HIGH(counter) << 32) | PCC_GET_LOW(counter)
+#define PCC_GET(counter) (((unsigned long long)PCC_GET_HIGH(counter) << 32) | PCC_GET_LOW(counter))
+/**
+ * @brief Gets the event count of the specified counter.
+ * The event count of a section is incremented every time the section is
+ * started.
+ * @param counter Specifies the counter to for which to return the event count.
+ * @return The number of events counted.
+ */
+#define PCC_GET_EVENTS(counter) (unsigned int)IORD32(A_PCC, ((counter) * 16) + 8)
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 # $Id: files.mk 201 2015-02-17 13:56:40Z klugeflo $
 # List all hal source files
 
-HAP_C_SRC = freeems_hal_functions.c freeems_hal_globals.c freeems_hal_init.c freeems_hal_interrupts.c
+HAP_C_SRC = freeems_hal_adc.c freeems_hal_functions.c freeems_hal_globals.c freeems_hal_init.c freeems_hal_interrupts.c freeems_hal_serial.c
 HAP_S_SRC = freeems_hal_ubench.S
@@ -0,0 +1,56 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief ADC acquisition.
+ * The system has no ADC, so no scans ever complete and all readings stay
+ * zero, just like the dummy ATD registers used before. Only the buffer
+ * bookkeeping is kept so the interface behaves as on the other platforms.
+ * @file freeems_hal_adc.c
+ */
+#include <hal/ems/freeems_hal.h>
+
+static uint16_t hal_adc_buffers[HAL_ADC_BUFFERS][HAL_ADC_CHANNELS];
+static uint8_t hal_adc_holds[HAL_ADC_BUFFERS];
+static uint8_t hal_adc_latest;
+
+
+uint8_t hal_adc_acquire(void) {
+  hal_adc_holds[hal_adc_latest]++;
+  return hal_adc_latest;
+}
+
+
+void hal_adc_release(uint8_t index) {
+  if ((index < HAL_ADC_BUFFERS) && (hal_adc_holds[index] > 0)) {
+    hal_adc_holds[index]--;
+  }
+}
+
+
+const volatile uint16_t* hal_adc_buffer(uint8_t index) {
+  return hal_adc_buffers[index];
+}
+
+
+void hal_adc_read(uint16_t* dest) {
+  uint8_t channel;
+  for (channel = 0; channel < HAL_ADC_CHANNELS; channel++) {
+    dest[channel] = hal_adc_buffers[hal_adc_latest][channel];
+  }
+}
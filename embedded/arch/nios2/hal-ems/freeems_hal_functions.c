@@ -26,6 +26,7 @@
 #include <hal/log.h>
 #include <hal/ems/freeems_hal.h>
 #include <driver/pcc.h>
+#include <stddef.h>
 #include <arch/nios2/io.h>
 #include "freeems_hal_globals.h"
 
@@ -52,6 +53,11 @@ uint16_t hal_timer_time_get(void) {
   return 0;
 }
 
+uint32_t hal_timer_time_get32(void) {
+  // the SCCT counter is 32 bit wide, no software extension needed
+  return IORD32(A_SCCT, SCCT_CTR);
+}
+
 bool hal_timer_overflow_get(void) {
   // see freeems_hal_globals.h for documentation of lastTickHighWord
   return (lastTickHighWord != IORD16(A_TIMER, NIOS2_TIMER_SNAPH));
@@ -80,6 +86,21 @@ uint16_t hal_timer_ic_capture_get(channelid_t channel_id) {
   return 0;
 }
 
+uint32_t hal_timer_ic_capture_get32(channelid_t channel_id) {
+  switch (channel_id) {
+  case PRIMARY_RPM_INPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR0);
+  case SECONDARY_RPM_INPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR1);
+  default:
+    log_printf(
+      "ERROR: invalid channel ID (%d) for hal_timer_ic_capture_get32\r\n",
+      channel_id);
+    break;
+  }
+  return 0;
+}
+
 pinstate_t hal_timer_ic_pin_get(channelid_t channel_id) {
   switch (channel_id) {
   case PRIMARY_RPM_INPUT:
@@ -325,6 +346,30 @@ uint16_t hal_timer_oc_compare_get(channelid_t channel_id) {
   }
 }
 
+uint32_t hal_timer_oc_compare_get32(channelid_t channel_id) {
+  // the compare registers hold the full 32 bit value, see
+  // hal_internal_set_oc_compare
+  switch (channel_id) {
+  case INJECTION1_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR2);
+  case INJECTION2_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR3);
+  case INJECTION3_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR4);
+  case INJECTION4_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR5);
+  case INJECTION5_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR6);
+  case INJECTION6_OUTPUT:
+    return IORD32(A_SCCT, SCCT_CH_CCR7);
+  default:
+    log_printf(
+      "ERROR: invalid channel ID (%d) for hal_timer_oc_compare_get32\r\n",
+      channel_id);
+    return 0;
+  }
+}
+
 /**
  * @author Andreas Meixner
  * @brief Set the mode flags for the given channel according to the value of
@@ -698,13 +743,149 @@ void hal_irq_atomic_end() {
   __wrctl_status(sr);
 }
 
+void hal_system_idle(void) {
+  // nios2 has no sleep instruction, so poll for a pending interrupt instead.
+  // ipending does not depend on PIE, so this works inside ATOMIC_START/END.
+  while (__rdctl_ipending() == 0) {
+#ifdef __PERF__
+    // the main loop drains the performance log, don't stall it
+    if (circular_buffer_available_data(&performance_log_buffer) > 0) {
+      break;
+    }
+#endif
+  }
+}
+
+/*
+ * The global PCC counter runs freely from hal_system_init() on, because the
+ * section counters only count while it runs. Runtime measurements take the
+ * difference of its lower 32 bits. ISRs are not nested on nios2, see do_irq(),
+ * but a measurement in the main loop may be interrupted by a measured ISR.
+ * So like on stm32 every measurement gets a frame on a small stack, and the
+ * time of nested measurements is subtracted.
+ */
+#define HAL_PERFORMANCE_STACK_DEPTH 4
+
+typedef struct {
+  uint32_t start;
+  uint32_t preempted;
+} hal_performance_frame_t;
+
+static hal_performance_frame_t hal_performance_stack[HAL_PERFORMANCE_STACK_DEPTH];
+static uint8_t hal_performance_depth;
+
+/* Masks interrupts, returns the status to be restored */
+static inline uint32_t hal_priv_performance_lock(void) {
+  uint32_t status = __rdctl_status();
+  __wrctl_status(status & ~SPR_SR_PIE);
+  return status;
+}
+
 void hal_performance_startCounter() {
-  PCC_RESET();
-  PCC_START(PCC_GLOBAL);
+  uint32_t status = hal_priv_performance_lock();
+  uint8_t depth = hal_performance_depth;
+  if (depth < HAL_PERFORMANCE_STACK_DEPTH) {
+    hal_performance_stack[depth].preempted = 0;
+    hal_performance_stack[depth].start = PCC_GET_LOW(PCC_GLOBAL);
+  }
+  hal_performance_depth = depth + 1;
+  __wrctl_status(status);
+}
+
+unsigned int hal_performance_stopCounterNested(unsigned int* inclusive) {
+  uint32_t now = PCC_GET_LOW(PCC_GLOBAL);
+  uint32_t total = 0;
+  uint32_t own = 0;
+  uint32_t status = hal_priv_performance_lock();
+  uint8_t depth = hal_performance_depth;
+  if (depth > 0) {
+    depth--;
+    hal_performance_depth = depth;
+    if (depth < HAL_PERFORMANCE_STACK_DEPTH) {
+      total = now - hal_performance_stack[depth].start;
+      own = total - hal_performance_stack[depth].preempted;
+      if (depth > 0) {
+        hal_performance_stack[depth - 1].preempted += total;
+      }
+    }
+  }
+  __wrctl_status(status);
+  if (inclusive != NULL) {
+    *inclusive = total;
+  }
+  return own;
 }
 
 unsigned int hal_performance_stopCounter() {
-  PCC_STOP(PCC_GLOBAL);
-  unsigned int retVal = PCC_GET_LOW(PCC_GLOBAL);
-  return retVal;
+  return hal_performance_stopCounterNested(NULL);
+}
+
+/*
+ * Profiling regions are mapped onto the four PCC sections. Which regions are
+ * counted can be chosen at build time, e.g. -DHAL_PERFORMANCE_SECTION4=
+ * PERF_REGION_COMMS. A region must not be mapped to more than one section.
+ */
+#ifndef HAL_PERFORMANCE_SECTION1
+#define HAL_PERFORMANCE_SECTION1 PERF_REGION_CORE_VARS
+#endif
+#ifndef HAL_PERFORMANCE_SECTION2
+#define HAL_PERFORMANCE_SECTION2 PERF_REGION_DERIVED_VARS
+#endif
+#ifndef HAL_PERFORMANCE_SECTION3
+#define HAL_PERFORMANCE_SECTION3 PERF_REGION_FUEL_IGNITION
+#endif
+#ifndef HAL_PERFORMANCE_SECTION4
+#define HAL_PERFORMANCE_SECTION4 PERF_REGION_PRIMARY_RPM
+#endif
+
+/* Returns the section of a region, PCC_GLOBAL if it is not counted */
+static inline uint8_t hal_priv_performance_section(uint8_t region) {
+  if (region == PERF_REGION_NONE) {
+    return PCC_GLOBAL;
+  }
+  if (region == HAL_PERFORMANCE_SECTION1) {
+    return PCC_SECTION1;
+  }
+  if (region == HAL_PERFORMANCE_SECTION2) {
+    return PCC_SECTION2;
+  }
+  if (region == HAL_PERFORMANCE_SECTION3) {
+    return PCC_SECTION3;
+  }
+  if (region == HAL_PERFORMANCE_SECTION4) {
+    return PCC_SECTION4;
+  }
+  return PCC_GLOBAL;
+}
+
+void hal_performance_regionBegin(uint8_t region) {
+  uint8_t section = hal_priv_performance_section(region);
+  if (section != PCC_GLOBAL) {
+    PCC_START(section);
+  }
+}
+
+void hal_performance_regionEnd(uint8_t region) {
+  uint8_t section = hal_priv_performance_section(region);
+  if (section != PCC_GLOBAL) {
+    PCC_STOP(section);
+  }
+}
+
+bool hal_performance_regionRead(uint8_t region, uint64_t* cycles,
+                                uint32_t* entries) {
+  uint8_t section = hal_priv_performance_section(region);
+  if (section == PCC_GLOBAL) {
+    return false;
+  }
+  /* Read again if the lower half overflowed in between */
+  uint32_t high;
+  uint32_t low;
+  do {
+    high = PCC_GET_HIGH(section);
+    low = PCC_GET_LOW(section);
+  } while (high != PCC_GET_HIGH(section));
+  *cycles = ((uint64_t)high << 32) | low;
+  *entries = PCC_GET_EVENTS(section);
+  return true;
 }
@@ -30,13 +30,13 @@
  * @author Andreas Meixner
  * @see hal_io.h INJECTIONX_OUTPUT(channelNumber)
  */
-channelid_t injectionOutputChannels[] = {INJECTION1_OUTPUT,INJECTION2_OUTPUT,INJECTION3_OUTPUT,INJECTION4_OUTPUT,INJECTION5_OUTPUT,INJECTION6_OUTPUT,INJECTION7_OUTPUT,INJECTION8_OUTPUT};
+channelid_t injectionOutputChannels[] = {INJECTION1_OUTPUT,INJECTION2_OUTPUT,INJECTION3_OUTPUT,INJECTION4_OUTPUT,INJECTION5_OUTPUT,INJECTION6_OUTPUT,INJECTION7_OUTPUT,INJECTION8_OUTPUT,INJECTION9_OUTPUT,INJECTION10_OUTPUT,INJECTION11_OUTPUT,INJECTION12_OUTPUT};
 
 /**
  * @author Andreas Meixner
  * @see hal_io.h IGNITIONX_OUTPUT(channelNumber)
  */
-channelid_t ignitionChannels[] = {IGNITION1_OUTPUT,IGNITION2_OUTPUT,IGNITION3_OUTPUT,IGNITION4_OUTPUT,IGNITION5_OUTPUT,IGNITION6_OUTPUT,IGNITION7_OUTPUT,IGNITION8_OUTPUT};
+channelid_t ignitionChannels[] = {IGNITION1_OUTPUT,IGNITION2_OUTPUT,IGNITION3_OUTPUT,IGNITION4_OUTPUT,IGNITION5_OUTPUT,IGNITION6_OUTPUT,IGNITION7_OUTPUT,IGNITION8_OUTPUT,IGNITION9_OUTPUT,IGNITION10_OUTPUT,IGNITION11_OUTPUT,IGNITION12_OUTPUT};
 
 /**
  * @author Andreas Mexiner
@@ -78,4 +78,10 @@ uint16_t lastTickHighWord;
 #error "SPEED" defined in config.h was set neither SPEED_NORMAL nor SPEED_SLOW
 #endif
 
+/*
+ * Serial transmission, see freeems_hal_serial.c
+ */
+void hal_priv_serial_setup(void);
+void hal_priv_serial_isr(void);
+
 #endif /* FILE_FREEEMS_HAL_GLOBALS_H_SEEN */
@@ -24,6 +24,7 @@
  * Florian Kluge <kluge@informatik.uni-augsburg.de>
  */
 #include <hal/ems/freeems_hal.h>
+#include <driver/pcc.h>
 #include "freeems_hal_globals.h"
 /**** Setup functions */
 
@@ -89,8 +90,13 @@ void hal_system_clock(void) {
 }
 
 void hal_system_init(void) {
+  // the global performance counter runs all the time, see
+  // hal_performance_startCounter()
+  PCC_RESET();
+  PCC_START(PCC_GLOBAL);
   hal_priv_timer_setup();
   hal_priv_gpio_setup();
+  hal_priv_serial_setup();
   hal_priv_isr_setup();
 }
 
@@ -119,36 +119,50 @@ void do_irq() {
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(2,1));
       Injector1ISR();
     }
+#if EMS_CHANNELS > 1
     // if OC channel 3 has a pending interrupt, call Injector2ISR
     if(isFlags & SCCT_CH_BITS_1(3,1)) {
       // clear interrupt flags
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(3,1));
       Injector2ISR();
     }
+#endif
+#if EMS_CHANNELS > 2
     // if OC channel 4 has a pending interrupt, call Injector3ISR
     if(isFlags & SCCT_CH_BITS_1(4,1)) {
       // clear interrupt flags
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(4,1));
       Injector3ISR();
     }
+#endif
+#if EMS_CHANNELS > 3
     // if OC channel 5 has a pending interrupt, call Injector4ISR
     if(isFlags & SCCT_CH_BITS_1(5,1)) {
       // clear interrupt flags
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(5,1));
       Injector4ISR();
     }
+#endif
+#if EMS_CHANNELS > 4
     // if OC channel 6 has a pending interrupt, call Injector5ISR
     if(isFlags & SCCT_CH_BITS_1(6,1)) {
       // clear interrupt flags
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(6,1));
       Injector5ISR();
     }
+#endif
+#if EMS_CHANNELS > 5
     // if OC channel 7 has a pending interrupt, call Injector6ISR
     if(isFlags & SCCT_CH_BITS_1(7,1)) {
       // clear interrupt flags
       IOWR32(A_SCCT, SCCT_CH_IS, SCCT_CH_BITS_1(7,1));
       Injector6ISR();
     }
+#endif
+  }
+  // the UART is ready for the next bytes of a frame
+  if(pending & IRQ_UART_BIT) {
+    hal_priv_serial_isr();
   }
 }
 
@@ -0,0 +1,73 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief Interrupt driven serial transmission.
+ * The system has no DMA controller, so frames are fed to the UART from its
+ * transmit ready interrupt. Framing and escaping are done by FreeEMS up front,
+ * the interrupt only moves bytes and the main loop never waits for the UART.
+ * The board has only one UART, unlike the stm32 HAL the frames share it with
+ * the performance log. The log drain pauses while a frame is in flight, so
+ * frames are never interleaved with log bytes, but a frame may end up between
+ * two parts of a log line. Frames start with 0xAA and end with 0xCC and can be
+ * cut out of the log by the receiver.
+ * @file freeems_hal_serial.c
+ */
+#include <hal/ems/freeems_hal.h>
+#include <driver/uart.h>
+
+#include "freeems_hal_globals.h"
+#include "hal_freeems_interface.h"
+
+static const uint8_t* volatile hal_serial_data;
+static volatile uint16_t hal_serial_remaining;
+
+
+void hal_priv_serial_setup(void) {
+  IOWR32(A_UART, UART_CT, 0);
+  uint32_t ienable_register = __rdctl_ienable();
+  ienable_register |= IRQ_UART_BIT;
+  __wrctl_ienable(ienable_register);
+}
+
+
+void hal_priv_serial_isr(void) {
+  while ((hal_serial_remaining > 0)
+         && (htonl(IORD8(A_UART, UART_ST)) & UART_ST_TRDY)) {
+    IOWR8(A_UART, UART_TX, *hal_serial_data);
+    hal_serial_data++;
+    hal_serial_remaining--;
+  }
+  if (hal_serial_remaining == 0) {
+    IOWR32(A_UART, UART_CT, 0);
+    SCI0TXCompleteISR();
+  }
+}
+
+
+bool hal_priv_serial_busy(void) {
+  return hal_serial_remaining > 0;
+}
+
+
+void hal_serial_transmit(const uint8_t* data, uint16_t length) {
+  hal_serial_data = data;
+  hal_serial_remaining = length;
+  /* The transmit ready interrupt fires right away if the UART is idle */
+  IOWR32(A_UART, UART_CT, UART_CT_ITRDY);
+}
@@ -51,6 +51,8 @@
 #include "hal/ems/hal_logging.h"
 #include "hal/ems/hal_irq.h"
 #include "hal/ems/hal_performance.h"
+#include "hal/ems/hal_adc.h"
+#include "hal/ems/hal_serial.h"
 
 /**
  * @author Andreas Meixner
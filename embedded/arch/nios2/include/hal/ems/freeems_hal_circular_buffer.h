@@ -20,6 +20,13 @@
  * $Id: freeems_hal_circular_buffer.h 546 2016-07-15 06:51:19Z klugeflo $
  * @brief Implementation of a circular buffer needed for performance logging on
  *        nios2 architecture.
+ *
+ * The buffer has a single producer and a single consumer and needs no locks:
+ * only the producer writes head and the statistics, only the consumer writes
+ * tail. Both indices run freely and are masked on access only. Data is copied
+ * in blocks, at most two memcpy() per block because of the wrap around. A
+ * block that does not fit into the free space is dropped as a whole and
+ * counted, the data already in the buffer is never overwritten.
  * @file freeems_hal_circular_buffer.h
  * @author Andreas Meixner, Claudius Heine,
  * Florian Kluge <kluge@informatik.uni-augsburg.de>
@@ -29,10 +36,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <math.h>
+#include <basic/gprintf.h>
 #include <driver/board.h>
+#include <driver/uart.h>
 #include <arch/nios2/io.h>
 #include <hal/ems/hal_irq.h>
+#include <ems/barrier.h>
 
 
 /*
@@ -50,9 +61,14 @@
  * @brief Defines the size of the circular buffers in bytes.
  * This value defines how big the the buffers ar in bytes. It has to be a power
  * of 2 e.g. 1024 (1kb), 4096 (4kb), 4194304 (4M), ....
- * This value may be changed.
+ * This value may be changed, e.g. with -DBUFFER_SIZE=65536.
  */
+#ifndef BUFFER_SIZE
 #define BUFFER_SIZE 16777216
+#endif
+#if (BUFFER_SIZE & (BUFFER_SIZE - 1)) != 0
+#error "BUFFER_SIZE has to be a power of 2"
+#endif
 /**
  * @autorh Andreas Meixner
  * @brief Defines the bitmask for fast modula calculations.
@@ -64,6 +80,15 @@
  */
 #define BUFFER_MODULO_FACTOR (BUFFER_SIZE - 1)
 
+/**
+ * @brief Largest number of bytes output_next_from_buffer() passes to the UART
+ * in one call. It never waits for the UART, so this only bounds the time spent
+ * when the UART is faster than expected.
+ */
+#ifndef BUFFER_DRAIN_BATCH
+#define BUFFER_DRAIN_BATCH 64
+#endif
+
 /**
  * @autorh Andreas Meixner
  * @brief Defines a circular buffer
@@ -72,15 +97,25 @@
 typedef struct {
   /**
    * @autorh Andreas Meixner
-   * Points to the index where to write the next byte.
+   * Counts the bytes written, the next byte goes to head & BUFFER_MODULO_FACTOR.
    */
-  uint32_t head;
+  volatile uint32_t head;
   /**
    * @autorh Andreas Meixner
-   * Points to the index where to read the next byte.
+   * Counts the bytes read, the next byte comes from tail & BUFFER_MODULO_FACTOR.
    * If head == tail the buffer is empty.
    */
-  uint32_t tail;
+  volatile uint32_t tail;
+  /** Bytes accepted so far */
+  uint32_t written;
+  /** Bytes dropped so far because the buffer was full */
+  uint32_t dropped;
+  /** Blocks dropped so far, each counted in dropped as well */
+  uint32_t drops;
+  /** Largest fill level seen by the producer */
+  uint32_t highWater;
+  /** Value of drops last reported by circular_buffer_report_drops() */
+  uint32_t dropsReported;
   /**
    * @autorh Andreas Meixner
    * The byte array where the buffered data is stored.
@@ -104,6 +139,21 @@ typedef struct {
  */
 #define CIRCULAR_BUFFER_FULL 2
 
+/**
+ * @autorh Andreas Meixner
+ * @brief Empties the buffer and clears the statistics, while nobody uses it.
+ * @param buffer A pointer to the buffer.
+ */
+static inline void circular_buffer_init(circularbuffer_t* buffer) {
+  buffer->head = 0;
+  buffer->tail = 0;
+  buffer->written = 0;
+  buffer->dropped = 0;
+  buffer->drops = 0;
+  buffer->highWater = 0;
+  buffer->dropsReported = 0;
+}
+
 /**
  * @autorh Andreas Meixner
  * @brief Checks how many bytes are in the buffer.
@@ -112,17 +162,12 @@ typedef struct {
  */
 static inline uint32_t circular_buffer_available_data(
   circularbuffer_t* buffer) {
-  if (buffer->tail <= buffer->head) {
-    return buffer->head - buffer->tail;
-  }
-  else {
-    return BUFFER_SIZE - (buffer->tail - buffer->head);
-  }
+  return buffer->head - buffer->tail;
 }
 
 /**
  * @autorh Andreas Meixner
- * @brief Reads the next byte from the buffer.
+ * @brief Reads the next byte from the buffer, consumer only.
  * @param buffer A pointer to the buffer to read from.
  * @param outData A pointer to the variable where the read byte will be stored.
  * @return CIRCULAR_BUFFER_OK if reading was successfull or
@@ -130,98 +175,140 @@ static inline uint32_t circular_buffer_available_data(
  */
 static inline uint8_t circular_buffer_read(circularbuffer_t* buffer,
     uint8_t* outData) {
-  //if data is available read one byte and advance the tail pointer by one
-  uint8_t ret = CIRCULAR_BUFFER_OK;
-  if (circular_buffer_available_data(buffer) > 0) {
-    *outData = buffer->buffer[buffer->tail];
-    buffer->tail = (buffer->tail + 1) & BUFFER_MODULO_FACTOR;
+  uint32_t tail = buffer->tail;
+  if (buffer->head == tail) {
+    return CIRCULAR_BUFFER_NO_DATA_AVAILABLE;
   }
-  else {
-    ret = CIRCULAR_BUFFER_NO_DATA_AVAILABLE;
+  COMPILER_BARRIER();
+  *outData = buffer->buffer[tail & BUFFER_MODULO_FACTOR];
+  COMPILER_BARRIER();
+  buffer->tail = tail + 1;
+  return CIRCULAR_BUFFER_OK;
+}
+
+/**
+ * @autorh Andreas Meixner
+ * @brief Writes a given number of bytes to the given circular buffer, producer
+ *        only.
+ * The bytes are either all written or all dropped.
+ * @param buffer A pointer to the buffer to write to.
+ * @param values the bytes to write.
+ * @param length the number of bytes.
+ * @return CIRCULAR_BUFFER_OK if writing was successfull or
+ *         CIRCULAR_BUFFER_FULL if the bytes were dropped
+ */
+static inline uint8_t circular_buffer_write_all(circularbuffer_t *buffer,
+    const uint8_t *values, uint32_t length) {
+  uint32_t head = buffer->head;
+  uint32_t used = head - buffer->tail;
+  if (length > BUFFER_SIZE - used) {
+    buffer->dropped += length;
+    buffer->drops++;
+    return CIRCULAR_BUFFER_FULL;
   }
-  return ret;
+  uint32_t index = head & BUFFER_MODULO_FACTOR;
+  uint32_t first = BUFFER_SIZE - index;
+  if (first > length) {
+    first = length;
+  }
+  memcpy(&buffer->buffer[index], values, first);
+  memcpy(&buffer->buffer[0], values + first, length - first);
+  COMPILER_BARRIER();
+  buffer->head = head + length;
+  buffer->written += length;
+  if (used + length > buffer->highWater) {
+    buffer->highWater = used + length;
+  }
+  return CIRCULAR_BUFFER_OK;
 }
 
 /**
  * @autorh Andreas Meixner
- * @brief writes one byte to the buffer.
+ * @brief writes one byte to the buffer, producer only.
  * @param buffer A pointer to the buffer to rite to.
  * @param value the value to write to the buffer.
  * @return CIRCULAR_BUFFER_OK if writing was successfull or
- *         CIRCULAR_BUFFER_NO_DATA_AVAILABLE if the buffer is empty
+ *         CIRCULAR_BUFFER_FULL if the byte was dropped
  */
 static inline uint8_t circular_buffer_write(circularbuffer_t* buffer,
     uint8_t value) {
-  uint8_t ret = CIRCULAR_BUFFER_OK;
-  // write to the buffer
-  buffer->buffer[buffer->head] = value;
-  // advance head to the next position
-  // The modulo calculation is replaced by this & operator.
-  // This only works because BUFFER_SIZE is a power of 2 and
-  // BUFFER_MODULO_FACTOR is BUFFER_SIZE-1.
-  buffer->head = (buffer->head + 1) & BUFFER_MODULO_FACTOR;
-  //if the buffer is full now advance tail by one
-  if (buffer->head == buffer->tail) {
-    buffer->tail = (buffer->tail + 1) & BUFFER_MODULO_FACTOR;
-    ret = CIRCULAR_BUFFER_FULL;
-  }
-  else {
-    ret = CIRCULAR_BUFFER_OK;
-  }
-  return ret;
+  return circular_buffer_write_all(buffer, &value, 1);
 }
 
 /**
  * @autorh Andreas Meixner
- * @brief Writes a given number of bytes to the given circular buffer.
+ * @brief Writes a string to the given circular buffer, producer only.
  */
-static inline uint8_t circular_buffer_write_all(circularbuffer_t *buffer,
-    uint8_t *values, uint32_t length) {
-  uint8_t retVal = CIRCULAR_BUFFER_OK;
-  int i = 0;
-  for (i = 0; i < length; i++) {
-    retVal = circular_buffer_write(buffer, values[i]);
-  }
-  return retVal;
+static inline uint8_t circular_buffer_write_string(circularbuffer_t *buffer,
+    const uint8_t* string) {
+  return circular_buffer_write_all(buffer, string,
+                                   strlen((const char*)string));
 }
 
 /**
- * @autorh Andreas Meixner
- * @brief Writes a string to the given circular buffer.
+ * @brief Writes a line with the number of dropped blocks and bytes to the
+ *        buffer if more were dropped since the last report, producer only.
+ * The line is **LogDropped [N] [B], see doc/log-format.txt.
  */
-static inline uint8_t circular_buffer_write_string(circularbuffer_t *buffer,
-    uint8_t* string) {
-  uint8_t retVal = CIRCULAR_BUFFER_OK;
-  uint32_t index = 0;
-  while (string[index] != 0) {
-    retVal = circular_buffer_write(buffer, string[index]);
-    index++;
+static inline void circular_buffer_report_drops(circularbuffer_t *buffer) {
+  uint32_t drops = buffer->drops;
+  if (drops != buffer->dropsReported) {
+    /* gprintf() does not terminate the string without a put function */
+    char line[48] = {0};
+    gprintf(line, sizeof(line), NULL, "**LogDropped %lu %lu\r\n",
+            drops, buffer->dropped);
+    /* Retried on the next call if this does not fit either */
+    if (circular_buffer_write_string(buffer, (const uint8_t*)line)
+        == CIRCULAR_BUFFER_OK) {
+      buffer->dropsReported = drops;
+    }
   }
-  return retVal;
 }
 
+/**
+ * @brief Tells whether the serial HAL is sending a frame, see
+ *        freeems_hal_serial.c.
+ */
+extern bool hal_priv_serial_busy(void);
+
 /**
  * @autorh Andreas Meixner
- * @brief outputs the next byte from the cricular buffer to the uart.
- * This function takes the next byte from the giver circular buffer and writes
- * it to the uart output. Only call this from within the main loop.
+ * @brief outputs the next bytes from the cricular buffer to the uart.
+ * This function passes at most BUFFER_DRAIN_BATCH bytes of the given circular
+ * buffer to the uart output, as many as the uart takes without waiting. Only
+ * call this from within the main loop, it is the consumer.
+ * The board has a single UART, which the serial HAL uses for the FreeEMS
+ * frames as well. Nothing is drained while a frame is in flight, so a frame
+ * always reaches the line in one piece. Frames are started from the main loop
+ * too, so they cannot begin between the check and the writes below.
  * @param buffer The buffer from which to read.
- * @return Returns the written byte, or 0 if nothing was done.
+ * @return Returns the number of bytes written, 0 if nothing was done.
  */
 static inline int32_t output_next_from_buffer(circularbuffer_t *buffer) {
+  if (hal_priv_serial_busy()) {
+    return 0;
+  }
+  uint32_t tail = buffer->tail;
+  uint32_t available = buffer->head - tail;
+  uint32_t index = tail & BUFFER_MODULO_FACTOR;
+  /* One contiguous segment, the rest follows with the next call */
+  if (available > BUFFER_SIZE - index) {
+    available = BUFFER_SIZE - index;
+  }
+  if (available > BUFFER_DRAIN_BATCH) {
+    available = BUFFER_DRAIN_BATCH;
+  }
+  COMPILER_BARRIER();
 
-  uint8_t nextValue = 0;
-  // do not exectute any interrupts while reading the next byte,
-  // otherwise the circular buffer could be corurpted.
-  ATOMIC_START();
-  uint8_t result = circular_buffer_read(buffer, &nextValue);
-  ATOMIC_END();
-  //if buffer is not empty write the next byte, else do nothing
-  if (result == CIRCULAR_BUFFER_OK) {
-    while (!(htonl(IORD8(A_UART, UART_ST)) & UART_ST_TRDY))
-      ;
-    IOWR8(A_UART, UART_TX, nextValue);
+  uint32_t count = 0;
+  while ((count < available)
+         && (htonl(IORD8(A_UART, UART_ST)) & UART_ST_TRDY)) {
+    IOWR8(A_UART, UART_TX, buffer->buffer[index + count]);
+    count++;
   }
-  return (int32_t) nextValue;
+
+  COMPILER_BARRIER();
+  buffer->tail = tail + count;
+  return (int32_t) count;
 }
 #endif /* FILE_FREEEMS_HAL_CIRCULAR_BUFFER_H_SEEN */
@@ -28,6 +28,10 @@
 #ifndef HAL_PERFORMANCE_H_
 #define HAL_PERFORMANCE_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <ems/perfRegions.h>
+
 /**
  * @author Andreas Meixner
  * @brief Starts code runtime measurement.
@@ -41,9 +45,51 @@ extern void hal_performance_startCounter();
  * @author Andreas Meixner
  * @brief Stops the counter and returns its value.
  * This function stops the counter started by hal_performance_startCounter().
- * Also the counter will be reset to 0 (zero).
+ * Measurements may be nested, e.g. by an ISR preempting a measured one. On
+ * platforms supporting this the time spent in nested measurements is not
+ * included in the result.
  * @return the current value of the counter.
+ * @see hal_performance_stopCounterNested()
  */
 extern unsigned int hal_performance_stopCounter();
 
+/**
+ * @brief Stops the counter and returns its value with and without nested
+ * measurements.
+ * Like hal_performance_stopCounter(), but also stores the time including
+ * nested measurements. Both values are the same on platforms that do not
+ * support nesting.
+ * @param inclusive where to store the time including nested measurements,
+ * may be NULL.
+ * @return the time excluding nested measurements.
+ */
+extern unsigned int hal_performance_stopCounterNested(unsigned int* inclusive);
+
+/**
+ * @brief Enters a profiling region.
+ * From now on the cycles are accounted to the region, until
+ * hal_performance_regionEnd() is called with the same region. Regions may
+ * overlap. Regions the platform does not count are ignored.
+ * @param region one of the PERF_REGION_ IDs from ems/perfRegions.h
+ */
+extern void hal_performance_regionBegin(uint8_t region);
+
+/**
+ * @brief Leaves a profiling region.
+ * @param region the region given to hal_performance_regionBegin()
+ */
+extern void hal_performance_regionEnd(uint8_t region);
+
+/**
+ * @brief Reads the totals of a profiling region.
+ * The totals count from system start. Call between ATOMIC_START() and
+ * ATOMIC_END() to get a consistent set of several regions.
+ * @param region one of the PERF_REGION_ IDs from ems/perfRegions.h
+ * @param cycles where to store the cycles spent in the region
+ * @param entries where to store how often the region was entered
+ * @return false if the platform does not count this region
+ */
+extern bool hal_performance_regionRead(uint8_t region, uint64_t* cycles,
+                                       uint32_t* entries);
+
 #endif /* HAL_PERFORMANCE_H_ */
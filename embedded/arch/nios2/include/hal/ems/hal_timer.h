@@ -36,6 +36,16 @@
  */
 extern uint16_t hal_timer_time_get(void);
 
+/**
+ * @brief Returns the current value of the reference clock extended to 32 bit.
+ * Where the hardware offers a 32 bit counter it is read directly, otherwise
+ * the 16 bit counter is combined with the overflow count maintained by
+ * TimerOverflow(). A pending, not yet handled overflow is taken into account,
+ * so callers need not check hal_timer_overflow_get() themselves.
+ * @return The current value of the reference timer as 32 bit value.
+ */
+extern uint32_t hal_timer_time_get32(void);
+
 /**
  * @author Andreas Meixner
  * Returns if an overflow has occured on the reference timer.
@@ -37,13 +37,18 @@ extern circularbuffer_t performance_log_buffer;
  * This macro initializes everythich needed for logging. After calling this
  * calls to log_printf, debug_printf and perf_printf have to work properly.
  */
-#define log_init() {\
-		performance_log_buffer.head = 0;\
-		performance_log_buffer.tail = 0;\
-	}\
- 
-static inline int32_t write_buffer_gprintf(int32_t value) {
-  return (int32_t) circular_buffer_write(&performance_log_buffer, (uint8_t)(value & 0xff));
+#define log_init() circular_buffer_init(&performance_log_buffer)
+
+/**
+ * @brief Longest line perf_printf writes to the buffer in one block, gprintf
+ *        splits longer lines.
+ */
+#define PERF_PRINTF_LINE_LENGTH 128
+
+/* Called by gprintf with the formatted line */
+static inline int32_t write_buffer_gprintf(int32_t line) {
+  return (int32_t) circular_buffer_write_string(&performance_log_buffer,
+                                                (const uint8_t*)(uintptr_t)line);
 }
 
 #ifdef __LOG__
@@ -78,13 +83,24 @@ static inline int32_t write_buffer_gprintf(int32_t value) {
 #endif
 
 #ifdef __PERF__
-#define perf_printf(args...) gprintf(NULL, 0, write_buffer_gprintf, args)
+/* Formats the line on the stack and writes it to the buffer as one block */
+#define perf_printf(args...) do {					\
+    char perf_printf_line[PERF_PRINTF_LINE_LENGTH];			\
+    perf_printf_line[PERF_PRINTF_LINE_LENGTH - 1] = '\0';		\
+    gprintf(perf_printf_line, PERF_PRINTF_LINE_LENGTH, write_buffer_gprintf, args); \
+  } while (0)
 #else
 #define perf_printf(args...) ((void)0)
 #endif
 
 #ifdef __PERF__
-#define output_performance_log() output_next_from_buffer(&performance_log_buffer)
+/* Drains the ring filled by the PERF_WRAP wrappers, see ems/performance.h */
+extern void perf_ring_output(void);
+#define output_performance_log() do {				\
+    perf_ring_output();						\
+    circular_buffer_report_drops(&performance_log_buffer);	\
+    output_next_from_buffer(&performance_log_buffer);		\
+  } while (0)
 #else
 #define output_performance_log() ((void)0)
 #endif
@@ -0,0 +1,156 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief ADC acquisition by DMA.
+ * ADC1 converts IN0 to IN15 in continuous scan mode. DMA2 stream 0 moves the
+ * results in double buffer mode, so the hardware alternates between the
+ * buffers behind M0AR and M1AR. On every transfer complete the finished buffer
+ * becomes the latest one and the address register just freed is pointed at a
+ * buffer that is neither being written, nor the latest, nor held.
+ *
+ * On the discovery board most of these pins are used by the timers and debug
+ * outputs, so the readings carry no meaning; the ATD registers they replace
+ * were never connected either.
+ * @file freeems_hal_adc.c
+ */
+#include <hal/ems/freeems_hal.h>
+
+#include "freeems_hal_globals.h"
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/adc.h>
+#include <libopencm3/stm32/dma.h>
+
+static volatile uint16_t hal_adc_buffers[HAL_ADC_BUFFERS][HAL_ADC_CHANNELS];
+static volatile uint8_t hal_adc_holds[HAL_ADC_BUFFERS];
+static volatile uint8_t hal_adc_latest;
+/* Buffers behind M0AR and M1AR */
+static volatile uint8_t hal_adc_targets[2];
+/* Incremented with every complete scan, lets hal_adc_read() detect races */
+static volatile uint16_t hal_adc_sequence;
+
+
+void hal_priv_adc_setup(void) {
+  uint8_t channels[HAL_ADC_CHANNELS];
+  uint8_t channel;
+  for (channel = 0; channel < HAL_ADC_CHANNELS; channel++) {
+    channels[channel] = channel;
+  }
+
+  hal_adc_latest = 0;
+  hal_adc_targets[0] = 1;
+  hal_adc_targets[1] = 2;
+
+  rcc_periph_clock_enable(RCC_ADC1);
+  rcc_periph_clock_enable(RCC_DMA2);
+
+  /* DMA2 stream 0 channel 0 is ADC1 */
+  dma_stream_reset(DMA2, DMA_STREAM0);
+  dma_channel_select(DMA2, DMA_STREAM0, DMA_SxCR_CHSEL_0);
+  dma_set_priority(DMA2, DMA_STREAM0, DMA_SxCR_PL_HIGH);
+  dma_set_transfer_mode(DMA2, DMA_STREAM0, DMA_SxCR_DIR_PERIPHERAL_TO_MEM);
+  dma_set_peripheral_size(DMA2, DMA_STREAM0, DMA_SxCR_PSIZE_16BIT);
+  dma_set_memory_size(DMA2, DMA_STREAM0, DMA_SxCR_MSIZE_16BIT);
+  dma_enable_memory_increment_mode(DMA2, DMA_STREAM0);
+  dma_enable_circular_mode(DMA2, DMA_STREAM0);
+  dma_enable_double_buffer_mode(DMA2, DMA_STREAM0);
+  dma_set_peripheral_address(DMA2, DMA_STREAM0, (uint32_t)&ADC_DR(ADC1));
+  dma_set_memory_address(DMA2, DMA_STREAM0,
+                         (uint32_t)hal_adc_buffers[hal_adc_targets[0]]);
+  dma_set_memory_address_1(DMA2, DMA_STREAM0,
+                           (uint32_t)hal_adc_buffers[hal_adc_targets[1]]);
+  dma_set_number_of_data(DMA2, DMA_STREAM0, HAL_ADC_CHANNELS);
+  dma_enable_transfer_complete_interrupt(DMA2, DMA_STREAM0);
+  dma_enable_stream(DMA2, DMA_STREAM0);
+
+  /* 84 MHz / 4 = 21 MHz ADC clock, (480 + 10) cycles per channel, a full
+   * scan takes about 375us */
+  adc_power_off(ADC1);
+  adc_set_clk_prescale(ADC_CCR_ADCPRE_BY4);
+  /* 10 bit, see HAL_ADC_MAX */
+  adc_set_resolution(ADC1, ADC_CR1_RES_10BIT);
+  adc_set_right_aligned(ADC1);
+  adc_set_sample_time_on_all_channels(ADC1, ADC_SMPR_SMP_480CYC);
+  adc_set_regular_sequence(ADC1, HAL_ADC_CHANNELS, channels);
+  adc_enable_scan_mode(ADC1);
+  adc_set_continuous_conversion_mode(ADC1);
+  adc_enable_dma(ADC1);
+  adc_set_dma_continue(ADC1);
+  adc_power_on(ADC1);
+  adc_start_conversion_regular(ADC1);
+}
+
+
+void hal_priv_adc_scan_complete(void) {
+  /* The hardware has already switched to the other address register */
+  uint8_t done = dma_get_target(DMA2, DMA_STREAM0) ? 0 : 1;
+  uint8_t writing = hal_adc_targets[done ^ 1];
+
+  hal_adc_latest = hal_adc_targets[done];
+  hal_adc_sequence++;
+
+  uint8_t next;
+  for (next = 0; next < HAL_ADC_BUFFERS; next++) {
+    if ((next != writing) && (next != hal_adc_latest)
+        && (hal_adc_holds[next] == 0)) {
+      break;
+    }
+  }
+  /* At most HAL_ADC_BUFFERS - 3 buffers can be held, so one is always free */
+  hal_adc_targets[done] = next;
+  if (done) {
+    dma_set_memory_address_1(DMA2, DMA_STREAM0,
+                             (uint32_t)hal_adc_buffers[next]);
+  }
+  else {
+    dma_set_memory_address(DMA2, DMA_STREAM0, (uint32_t)hal_adc_buffers[next]);
+  }
+}
+
+
+uint8_t hal_adc_acquire(void) {
+  uint8_t index = hal_adc_latest;
+  hal_adc_holds[index]++;
+  return index;
+}
+
+
+void hal_adc_release(uint8_t index) {
+  if ((index < HAL_ADC_BUFFERS) && (hal_adc_holds[index] > 0)) {
+    hal_adc_holds[index]--;
+  }
+}
+
+
+const volatile uint16_t* hal_adc_buffer(uint8_t index) {
+  return hal_adc_buffers[index];
+}
+
+
+void hal_adc_read(uint16_t* dest) {
+  uint16_t sequence;
+  do {
+    sequence = hal_adc_sequence;
+    const volatile uint16_t* source = hal_adc_buffers[hal_adc_latest];
+    uint8_t channel;
+    for (channel = 0; channel < HAL_ADC_CHANNELS; channel++) {
+      dest[channel] = source[channel];
+    }
+  } while (sequence != hal_adc_sequence);
+}
@@ -27,11 +27,15 @@
 
 #include "freeems_hal_globals.h"
 #include "freeems_hal_macros.h"
+#include "hal_freeems_interface.h"
 
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/timer.h>
+#include <libopencm3/cm3/cortex.h>
+#include <libopencm3/cm3/dwt.h>
 
 #include <liboutput/output.h>
+#include <stddef.h>
 
 /**
  * This array is used to store the current interval times of the ignition timers.
@@ -67,6 +71,39 @@ void hal_timer_overflow_clear(void) {
   TIM_SR(TIM2) &= ~TIM_SR_UIF;
 }
 
+/**
+ * TIM2 is a 32 bit timer, but it is configured with a period of 0xFFFF so it
+ * stays in step with the 16 bit timers TIM3 and TIM4 and the 16 bit compare
+ * arithmetic of FreeEMS. Therefore the upper half is taken from the overflow
+ * count maintained by TimerOverflow().
+ */
+uint32_t hal_timer_time_get32(void) {
+  uint16_t high;
+  uint16_t low;
+  bool pending;
+  /* retry if TimerOverflow() ran in between */
+  do {
+    high = timerExtensionClock;
+    low = TIM_CNT(TIM2);
+    pending = (TIM_SR(TIM2) & TIM_SR_UIF) != 0;
+  } while (high != timerExtensionClock);
+  /* the counter wrapped before it was read, but the overflow is not yet
+   * accounted for */
+  if (pending && !(low & 0x8000)) {
+    high++;
+  }
+  return ((uint32_t)high << 16) | low;
+}
+
+/**
+ * Extend a 16 bit time stamp that lies in the past (at most one timer period)
+ * to 32 bit by subtracting its age from the current 32 bit time.
+ */
+static uint32_t hal_internal_time_extend(uint16_t timeStamp) {
+  uint32_t now = hal_timer_time_get32();
+  return now - (uint16_t)((uint16_t)now - timeStamp);
+}
+
 uint16_t hal_timer_ic_capture_get(channelid_t channel_id) {
   switch (channel_id) {
   case PRIMARY_RPM_INPUT:
@@ -78,6 +115,10 @@ uint16_t hal_timer_ic_capture_get(channelid_t channel_id) {
   }
 }
 
+uint32_t hal_timer_ic_capture_get32(channelid_t channel_id) {
+  return hal_internal_time_extend(hal_timer_ic_capture_get(channel_id));
+}
+
 pinstate_t hal_timer_ic_pin_get(channelid_t channel_id) {
   switch (channel_id) {
   case PRIMARY_RPM_INPUT:
@@ -110,6 +151,12 @@ pinstate_t hal_timer_oc_pin_get(channelid_t channel_id) {
   case INJECTION6_OUTPUT:
     retVal = gpio_get(GPIOB, GPIO7) & GPIO7 ? HIGH : LOW;
     break;
+  case INJECTION7_OUTPUT:
+    retVal = gpio_get(GPIOB, GPIO9) & GPIO9 ? HIGH : LOW;
+    break;
+  case INJECTION8_OUTPUT:
+    retVal = gpio_get(GPIOA, GPIO15) & GPIO15 ? HIGH : LOW;
+    break;
   default:
     retVal = LOW;
     debug_printf("hal_timer_oc_pin_get unknown channel id %d\r\n",
@@ -133,6 +180,10 @@ bool hal_timer_oc_active_get(channelid_t channel_id) {
     return (TIM_DIER(TIM4) & TIM_DIER_CC1IE) != 0;
   case INJECTION6_OUTPUT:
     return (TIM_DIER(TIM4) & TIM_DIER_CC2IE) != 0;
+  case INJECTION7_OUTPUT:
+    return (TIM_DIER(TIM4) & TIM_DIER_CC4IE) != 0;
+  case INJECTION8_OUTPUT:
+    return (TIM_DIER(TIM2) & TIM_DIER_CC1IE) != 0;
   default:
     return false;
   }
@@ -164,6 +215,14 @@ void hal_timer_oc_active_set(channelid_t channel_id, bool active) {
     OC_ACTIVE_SET(TIM4, 2, active)
     ;
     break;
+  case INJECTION7_OUTPUT:
+    OC_ACTIVE_SET(TIM4, 4, active)
+    ;
+    break;
+  case INJECTION8_OUTPUT:
+    OC_ACTIVE_SET(TIM2, 1, active)
+    ;
+    break;
   default:
     debug_printf("hal_timer_oc_output_set: channel id '%d' unknown.",
                  channel_id);
@@ -184,6 +243,10 @@ uint16_t hal_timer_oc_compare_get(channelid_t channel_id) {
     return TIM_CCR1(TIM4);
   case INJECTION6_OUTPUT:
     return TIM_CCR2(TIM4);
+  case INJECTION7_OUTPUT:
+    return TIM_CCR4(TIM4);
+  case INJECTION8_OUTPUT:
+    return TIM_CCR1(TIM2);
   default:
     debug_printf("hal_timer_oc_output_set: channel id '%d' unknown.",
                  channel_id);
@@ -191,6 +254,10 @@ uint16_t hal_timer_oc_compare_get(channelid_t channel_id) {
   return 0;
 }
 
+uint32_t hal_timer_oc_compare_get32(channelid_t channel_id) {
+  return hal_internal_time_extend(hal_timer_oc_compare_get(channel_id));
+}
+
 void hal_timer_oc_compare_set(channelid_t channel_id, uint16_t value) {
   switch (channel_id) {
   case INJECTION1_OUTPUT:
@@ -211,6 +278,12 @@ void hal_timer_oc_compare_set(channelid_t channel_id, uint16_t value) {
   case INJECTION6_OUTPUT:
     TIM_CCR2 (TIM4) = value;
     break;
+  case INJECTION7_OUTPUT:
+    TIM_CCR4 (TIM4) = value;
+    break;
+  case INJECTION8_OUTPUT:
+    TIM_CCR1 (TIM2) = value;
+    break;
   default:
     debug_printf("hal_timer_oc_output_set: channel id '%d' unknown.",
                  channel_id);
@@ -243,6 +316,14 @@ void hal_timer_oc_output_set(channelid_t channel_id, ocmode_t mode) {
     OC_MODE_SET(TIM4, 1, 2, mode)
     ;
     break;
+  case INJECTION7_OUTPUT:
+    OC_MODE_SET(TIM4, 2, 4, mode)
+    ;
+    break;
+  case INJECTION8_OUTPUT:
+    OC_MODE_SET(TIM2, 1, 1, mode)
+    ;
+    break;
   default:
     debug_printf("hal_timer_oc_output_set: channel id '%d' unknown.",
                  channel_id);
@@ -332,6 +413,12 @@ pinstate_t hal_io_get(channelid_t channel_id) {
   case IGNITION6_OUTPUT:
     retVal = gpio_get(GPIOC, GPIO6) ? HIGH : LOW;
     break;
+  case IGNITION7_OUTPUT:
+    retVal = gpio_get(GPIOC, GPIO7) ? HIGH : LOW;
+    break;
+  case IGNITION8_OUTPUT:
+    retVal = gpio_get(GPIOC, GPIO8) ? HIGH : LOW;
+    break;
   case DEBUG_OUTPUT_1:
     retVal = gpio_get(GPIOC, GPIO9) ? HIGH : LOW;
     break;
@@ -414,6 +501,22 @@ void hal_io_set(channelid_t channel_id, pinstate_t value) {
       gpio_clear(GPIOC, GPIO6);
     }
     break;
+  case IGNITION7_OUTPUT:
+    if (value == HIGH) {
+      gpio_set(GPIOC, GPIO7);
+    }
+    else {
+      gpio_clear(GPIOC, GPIO7);
+    }
+    break;
+  case IGNITION8_OUTPUT:
+    if (value == HIGH) {
+      gpio_set(GPIOC, GPIO8);
+    }
+    else {
+      gpio_clear(GPIOC, GPIO8);
+    }
+    break;
   case DEBUG_OUTPUT_1:
     if (value == HIGH) {
       gpio_set(GPIOC, GPIO9);
@@ -485,13 +588,78 @@ void hal_io_set(channelid_t channel_id, pinstate_t value) {
   }
 }
 
+void hal_system_idle(void) {
+  // WFI also wakes up on interrupts masked by ATOMIC_START (PRIMASK), they are
+  // served as soon as ATOMIC_END is reached
+  __asm__ __volatile__ ("wfi");
+}
+
+/*
+ * Runtime measurement with the DWT cycle counter, which is free running and
+ * never reset. Every measurement gets a frame on a stack holding its start
+ * stamp and the cycles spent in measurements nested into it. A measurement can
+ * only be interrupted by an ISR of higher priority, so the depth is bounded by
+ * the number of NVIC priority levels plus the thread mode.
+ * Only preempting code that is measured itself is subtracted, the exception
+ * entry and exit around it still count for the preempted measurement.
+ */
+#define HAL_PERFORMANCE_STACK_DEPTH 17
+
+typedef struct {
+  uint32_t start;
+  uint32_t preempted;
+} hal_performance_frame_t;
+
+static hal_performance_frame_t hal_performance_stack[HAL_PERFORMANCE_STACK_DEPTH];
+static uint8_t hal_performance_depth;
+
 void hal_performance_startCounter() {
-  timer_reset(TIM5);
-  timer_enable_counter(TIM5);
+  bool masked = cm_mask_interrupts(true);
+  uint8_t depth = hal_performance_depth;
+  if (depth < HAL_PERFORMANCE_STACK_DEPTH) {
+    hal_performance_stack[depth].preempted = 0;
+    hal_performance_stack[depth].start = DWT_CYCCNT;
+  }
+  hal_performance_depth = depth + 1;
+  cm_mask_interrupts(masked);
+}
+
+unsigned int hal_performance_stopCounterNested(unsigned int* inclusive) {
+  uint32_t now = DWT_CYCCNT;
+  uint32_t total = 0;
+  uint32_t own = 0;
+  bool masked = cm_mask_interrupts(true);
+  uint8_t depth = hal_performance_depth;
+  if (depth > 0) {
+    depth--;
+    hal_performance_depth = depth;
+    if (depth < HAL_PERFORMANCE_STACK_DEPTH) {
+      total = now - hal_performance_stack[depth].start;
+      own = total - hal_performance_stack[depth].preempted;
+      if (depth > 0) {
+        hal_performance_stack[depth - 1].preempted += total;
+      }
+    }
+  }
+  cm_mask_interrupts(masked);
+  if (inclusive != NULL) {
+    *inclusive = total;
+  }
+  return own;
 }
 
 unsigned int hal_performance_stopCounter() {
-  unsigned int ret = TIM5_CNT;
-  timer_disable_counter(TIM5);
-  return ret;
+  return hal_performance_stopCounterNested(NULL);
+}
+
+/* There are no section counters, regions are not counted */
+void hal_performance_regionBegin(uint8_t region) {
+}
+
+void hal_performance_regionEnd(uint8_t region) {
+}
+
+bool hal_performance_regionRead(uint8_t region, uint64_t* cycles,
+                                uint32_t* entries) {
+  return false;
 }
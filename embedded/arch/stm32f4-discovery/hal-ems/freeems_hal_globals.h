@@ -46,5 +46,17 @@ extern volatile uint16_t TIM2_CCR4_LAST;
 extern volatile uint16_t TIM2_CCR4_NEXT;
 extern volatile bool TIM2_CCR4_SET;
 
+/*
+ * ADC acquisition, see freeems_hal_adc.c
+ */
+void hal_priv_adc_setup(void);
+void hal_priv_adc_scan_complete(void);
+
+/*
+ * Serial transmission, see freeems_hal_serial.c
+ */
+void hal_priv_serial_setup(void);
+void hal_priv_serial_transmit_complete(void);
+
 
 #endif /* FILE_FREEEMS_HAL_GLOBALS_H_SEEN */
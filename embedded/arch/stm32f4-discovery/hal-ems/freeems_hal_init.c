@@ -29,6 +29,9 @@
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/timer.h>
 #include <libopencm3/cm3/nvic.h>
+#include <libopencm3/cm3/memorymap.h>
+#include <libopencm3/cm3/scs.h>
+#include <libopencm3/cm3/dwt.h>
 #include <libopencmsis/core_cm3.h>
 
 // For system info
@@ -63,7 +66,6 @@ static void hal_priv_timer_setup() {
   rcc_periph_clock_enable(RCC_TIM2);
   rcc_periph_clock_enable(RCC_TIM3);
   rcc_periph_clock_enable(RCC_TIM4);
-  rcc_periph_clock_enable(RCC_TIM5);
   rcc_periph_clock_enable(RCC_TIM7);
 
   /* Reset timer 1 to 5 */
@@ -71,7 +73,6 @@ static void hal_priv_timer_setup() {
   timer_reset(TIM2);
   timer_reset(TIM3);
   timer_reset(TIM4);
-  timer_reset(TIM5);
   timer_reset(TIM7);
 
   /* Initialize timer 1 to 5 */
@@ -79,7 +80,6 @@ static void hal_priv_timer_setup() {
   timer_set_mode(TIM2, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
   timer_set_mode(TIM3, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
   timer_set_mode(TIM4, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
-  timer_set_mode(TIM5, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
   timer_set_mode(TIM7, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE, TIM_CR1_DIR_UP);
 
   /** Timer 1 (master) **/
@@ -149,6 +149,16 @@ static void hal_priv_timer_setup() {
 
   timer_set_oc_mode(TIM4, TIM_OC2, TIM_OCM_FROZEN);
 
+#if EMS_CHANNELS > 6
+  /* Channel 4 of timer 4 for the seventh injector */
+  timer_set_oc_mode(TIM4, TIM_OC4, TIM_OCM_FROZEN);
+#endif
+
+#if EMS_CHANNELS > 7
+  /* Channel 1 of timer 2 for the eighth injector */
+  timer_set_oc_mode(TIM2, TIM_OC1, TIM_OCM_FROZEN);
+#endif
+
   /** Input Capture **/
 
   /* Setting channel 2 of timer 2 as input capture */
@@ -182,10 +192,12 @@ static void hal_priv_timer_setup() {
   timer_enable_irq(TIM7, TIM_DIER_UIE);
 
   /*
-   * timer 5 should just run and count up.
-   * Its counter is only read to measure the runtime of code e.g. all the ISRs
+   * The DWT cycle counter just runs and counts up.
+   * It is only read to measure the runtime of code e.g. all the ISRs
    */
-  timer_disable_irq(TIM5, TIM_DIER_UIE);
+  SCS_DEMCR |= SCS_DEMCR_TRCENA;
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA;
 
   /*
    * Bacause TIM1 is the master/input signal for these three timers
@@ -219,23 +231,23 @@ static void hal_priv_gpio_setup() {
   /** Output Pins **/
 
   /*
-   * PB4 is TIM3_CH1 output
-   * Triggers Injector1ISR
+   * PB4 is TIM3_CH1 output, injection channel 1
+   * Its compare event runs Injector1ISR
    *
-   * PB5 is TIM3_CH2 output
-   * Triggers Injector2ISR
+   * PB5 is TIM3_CH2 output, injection channel 2
+   * Its compare event runs Injector2ISR
    *
-   * PB0 is TIM3_CH3 output
-   * Triggers Injector3ISR
+   * PB0 is TIM3_CH3 output, injection channel 3
+   * Its compare event runs Injector3ISR
    *
-   * PB1 is TIM3_CH4 output
-   * Triggers Injector4ISR
+   * PB1 is TIM3_CH4 output, injection channel 4
+   * Its compare event runs Injector4ISR
    *
-   * PB6 is TIM4_CH1 output
-   * Triggers Injector5ISR
+   * PB6 is TIM4_CH1 output, injection channel 5
+   * Its compare event runs Injector5ISR
    *
-   * PB7 is TIM4_CH2 output
-   * Triggers Injector6ISR
+   * PB7 is TIM4_CH2 output, injection channel 6
+   * Its compare event runs Injector6ISR
    */
 
   //rcc_periph_clock_enable(RCC_GPIOB);
@@ -261,6 +273,26 @@ static void hal_priv_gpio_setup() {
   gpio_set_af(GPIOB, GPIO_AF2, GPIO6);
   gpio_set_af(GPIOB, GPIO_AF2, GPIO7);
 
+#if EMS_CHANNELS > 6
+  /*
+   * PB9 is TIM4_CH4 output, injection channel 7
+   * Its compare event runs Injector7ISR
+   */
+  gpio_mode_setup(GPIOB, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO9);
+  gpio_set_output_options(GPIOB, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO9);
+  gpio_set_af(GPIOB, GPIO_AF2, GPIO9);
+#endif
+
+#if EMS_CHANNELS > 7
+  /*
+   * PA15 is TIM2_CH1 output (JTDI, free as long as only SWD is used), injection channel 8
+   * Its compare event runs Injector8ISR
+   */
+  gpio_mode_setup(GPIOA, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO15);
+  gpio_set_output_options(GPIOA, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO15);
+  gpio_set_af(GPIOA, GPIO_AF1, GPIO15);
+#endif
+
   // init GPIO pins for ignition
   rcc_periph_clock_enable(RCC_GPIOC);
   gpio_mode_setup(GPIOC, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO1);
@@ -275,6 +307,14 @@ static void hal_priv_gpio_setup() {
   gpio_set_output_options(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO4);
   gpio_set_output_options(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO5);
   gpio_set_output_options(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO6);
+#if EMS_CHANNELS > 6
+  gpio_mode_setup(GPIOC, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO7);
+  gpio_set_output_options(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO7);
+#endif
+#if EMS_CHANNELS > 7
+  gpio_mode_setup(GPIOC, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO8);
+  gpio_set_output_options(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, GPIO8);
+#endif
 
   // init GPIO pins for debug output
   gpio_mode_setup(GPIOC, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO9);
@@ -301,8 +341,9 @@ static void hal_priv_isr_setup() {
   nvic_enable_irq(NVIC_TIM2_IRQ); /* enable TIM2 interrupt */
   nvic_enable_irq(NVIC_TIM3_IRQ); /* enable TIM3 interrupt */
   nvic_enable_irq(NVIC_TIM4_IRQ); /* enable TIM4 interrupt */
-  nvic_enable_irq(NVIC_TIM5_IRQ); /* enable TIM5 interrupt */
   nvic_enable_irq(NVIC_TIM7_IRQ); /* enable TIM7 interrupt */
+  nvic_enable_irq(NVIC_DMA2_STREAM0_IRQ); /* enable ADC DMA interrupt */
+  nvic_enable_irq(NVIC_DMA1_STREAM3_IRQ); /* enable serial DMA interrupt */
 }
 
 
@@ -337,6 +378,8 @@ void hal_system_init(void) {
 
   hal_priv_timer_setup();
   hal_priv_gpio_setup();
+  hal_priv_adc_setup();
+  hal_priv_serial_setup();
   hal_priv_isr_setup();
 }
 
@@ -344,7 +387,6 @@ void hal_system_init(void) {
 void hal_system_start(void) {
   timer_enable_counter(TIM7); /* TIM7 is slower than TIM1 therefore it is started before */
   timer_enable_counter(TIM1);
-  timer_enable_counter(TIM5);
 }
 
 
@@ -33,6 +33,7 @@
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/timer.h>
+#include <libopencm3/stm32/dma.h>
 #include <libopencm3/cm3/nvic.h>
 #include <libopencmsis/core_cm3.h>
 
@@ -58,6 +59,16 @@ void TIM2_IRQHandler(void) {
     PrimaryRPMISR();
   });
 
+#if EMS_CHANNELS > 7
+  /*
+   * Channel 1 of timer 2 is the output compare of the eighth injector, see
+   * TIM3_IRQHandler() for the details.
+   */
+  IRQ_HANDLE(TIM2, TIM_SR_CC1IF, TIM2_CCR1, {
+    Injector8ISR();
+  });
+#endif
+
   /*
   * When the timer that handles the ignition dwell events elapses, the function
   * IgnitionDwellISR() is called. This function generates the outputsignal and
@@ -117,6 +128,7 @@ void TIM3_IRQHandler(void) {
     Injector1ISR();
   });
 
+#if EMS_CHANNELS > 1
   /*
      * If the scheduled time when the second injector is to be
      * activated/deactivated is reached, call the function Injector2ISR().
@@ -134,7 +146,9 @@ void TIM3_IRQHandler(void) {
   IRQ_HANDLE(TIM3, TIM_SR_CC2IF, TIM3_CCR2, {
     Injector2ISR();
   });
+#endif
 
+#if EMS_CHANNELS > 2
   /*
      * If the scheduled time when the third injector is to be
      * activated/deactivated is reached, call the function Injector3ISR().
@@ -152,7 +166,9 @@ void TIM3_IRQHandler(void) {
   IRQ_HANDLE(TIM3, TIM_SR_CC3IF, TIM3_CCR3, {
     Injector3ISR();
   });
+#endif
 
+#if EMS_CHANNELS > 3
   /*
      * If the scheduled time when the fourth injector is to be
      * activated/deactivated is reached, call the function Injector4ISR().
@@ -170,16 +186,16 @@ void TIM3_IRQHandler(void) {
   IRQ_HANDLE(TIM3, TIM_SR_CC4IF, TIM3_CCR4, {
     Injector4ISR();
   });
+#endif
 }
 
 /*
  * This is the callback function for interrupts of timer 4. Timer 4 is connected
- * to the GPIO channels for the fifth and sixth injector.
- * @remark FreeEMS can theoretically handle up to eight injectors. The channels
- *         for injector seven and eight would then also be handled by this
- *         timer.
+ * to the GPIO channels for the fifth, sixth and seventh injector and to the
+ * secondary RPM input.
  */
 void TIM4_IRQHandler(void) {
+#if EMS_CHANNELS > 4
   /*
    * If the scheduled time when the fifth injector is to be
    * activated/deactivated is reached, call the function Injector5ISR().
@@ -197,7 +213,9 @@ void TIM4_IRQHandler(void) {
   IRQ_HANDLE(TIM4, TIM_SR_CC1IF, TIM4_CCR1, {
     Injector5ISR();
   });
+#endif
 
+#if EMS_CHANNELS > 5
   /*
    * If the scheduled time when the sixth injector is to be
    * activated/deactivated is reached, call the function Injector6ISR().
@@ -215,6 +233,7 @@ void TIM4_IRQHandler(void) {
   IRQ_HANDLE(TIM4, TIM_SR_CC2IF, TIM4_CCR2, {
     Injector6ISR();
   });
+#endif
 
   /*
    * When the secondyry RPM input channel changes state, call the FreeEMS
@@ -224,14 +243,36 @@ void TIM4_IRQHandler(void) {
   IRQ_HANDLE(TIM4, TIM_SR_CC3IF, TIM4_CCR3, {
     SecondaryRPMISR();
   });
+
+#if EMS_CHANNELS > 6
+  /*
+   * Channel 4 of timer 4 is the output compare of the seventh injector, see
+   * TIM3_IRQHandler() for the details.
+   */
+  IRQ_HANDLE(TIM4, TIM_SR_CC4IF, TIM4_CCR4, {
+    Injector7ISR();
+  });
+#endif
+}
+
+/*
+ * DMA2 stream 0 moves the ADC scans, see freeems_hal_adc.c
+ */
+void DMA2_Stream0_IRQHandler(void) {
+  if (dma_get_interrupt_flag(DMA2, DMA_STREAM0, DMA_TCIF)) {
+    dma_clear_interrupt_flags(DMA2, DMA_STREAM0, DMA_TCIF);
+    hal_priv_adc_scan_complete();
+  }
 }
 
 /*
- * This is the callback for timer 5. Timer 5 should not trigger any interrupts.
- * Its only purpose is that its counter value is used to measure the runtime of
- * different code (e.g.  PrimaryRPMISR(), SecondaryRPMISR(), ...)
+ * DMA1 stream 3 moves serial frames to USART3, see freeems_hal_serial.c
  */
-void TIM5_IRQHandler(void) {
+void DMA1_Stream3_IRQHandler(void) {
+  if (dma_get_interrupt_flag(DMA1, DMA_STREAM3, DMA_TCIF)) {
+    dma_clear_interrupt_flags(DMA1, DMA_STREAM3, DMA_TCIF);
+    hal_priv_serial_transmit_complete();
+  }
 }
 
 /*
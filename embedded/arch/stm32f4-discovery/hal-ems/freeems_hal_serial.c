@@ -0,0 +1,86 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @brief Serial transmission by DMA.
+ * Frames leave on USART3 TX (PD8) at 115200 baud 8N1. DMA1 stream 3 feeds the
+ * data register straight from the frame buffer, its transfer complete
+ * interrupt hands the buffer back to FreeEMS. The USB CDC port stays reserved
+ * for the log and performance output.
+ * @file freeems_hal_serial.c
+ */
+#include <hal/ems/freeems_hal.h>
+
+#include "freeems_hal_globals.h"
+#include "hal_freeems_interface.h"
+
+#include <libopencm3/stm32/rcc.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/usart.h>
+#include <libopencm3/stm32/dma.h>
+
+#define HAL_SERIAL_BAUDRATE 115200
+/* APB1 runs undivided, see hal_system_clock(), so rcc_ppre1_frequency and with
+ * it usart_set_baudrate() are off */
+#define HAL_SERIAL_APB1_FREQUENCY 168000000
+
+
+void hal_priv_serial_setup(void) {
+  rcc_periph_clock_enable(RCC_GPIOD);
+  rcc_periph_clock_enable(RCC_USART3);
+  rcc_periph_clock_enable(RCC_DMA1);
+
+  gpio_mode_setup(GPIOD, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO8);
+  gpio_set_af(GPIOD, GPIO_AF7, GPIO8);
+
+  USART_BRR(USART3) = (HAL_SERIAL_APB1_FREQUENCY + HAL_SERIAL_BAUDRATE / 2)
+                      / HAL_SERIAL_BAUDRATE;
+  usart_set_databits(USART3, 8);
+  usart_set_stopbits(USART3, USART_STOPBITS_1);
+  usart_set_parity(USART3, USART_PARITY_NONE);
+  usart_set_flow_control(USART3, USART_FLOWCONTROL_NONE);
+  usart_set_mode(USART3, USART_MODE_TX);
+  usart_enable_tx_dma(USART3);
+  usart_enable(USART3);
+
+  /* DMA1 stream 3 channel 4 is USART3_TX */
+  dma_stream_reset(DMA1, DMA_STREAM3);
+  dma_channel_select(DMA1, DMA_STREAM3, DMA_SxCR_CHSEL_4);
+  dma_set_priority(DMA1, DMA_STREAM3, DMA_SxCR_PL_LOW);
+  dma_set_transfer_mode(DMA1, DMA_STREAM3, DMA_SxCR_DIR_MEM_TO_PERIPHERAL);
+  dma_set_peripheral_size(DMA1, DMA_STREAM3, DMA_SxCR_PSIZE_8BIT);
+  dma_set_memory_size(DMA1, DMA_STREAM3, DMA_SxCR_MSIZE_8BIT);
+  dma_enable_memory_increment_mode(DMA1, DMA_STREAM3);
+  dma_set_peripheral_address(DMA1, DMA_STREAM3, (uint32_t)&USART_DR(USART3));
+  dma_enable_transfer_complete_interrupt(DMA1, DMA_STREAM3);
+}
+
+
+void hal_priv_serial_transmit_complete(void) {
+  dma_disable_stream(DMA1, DMA_STREAM3);
+  SCI0TXCompleteISR();
+}
+
+
+void hal_serial_transmit(const uint8_t* data, uint16_t length) {
+  dma_clear_interrupt_flags(DMA1, DMA_STREAM3, DMA_TCIF | DMA_HTIF | DMA_TEIF
+                            | DMA_DMEIF | DMA_FEIF);
+  dma_set_memory_address(DMA1, DMA_STREAM3, (uint32_t)data);
+  dma_set_number_of_data(DMA1, DMA_STREAM3, length);
+  dma_enable_stream(DMA1, DMA_STREAM3);
+}
@@ -37,7 +37,20 @@ extern void Injector3ISR();
 extern void Injector4ISR();
 extern void Injector5ISR();
 extern void Injector6ISR();
+extern void Injector7ISR();
+extern void Injector8ISR();
+extern void Injector9ISR();
+extern void Injector10ISR();
+extern void Injector11ISR();
+extern void Injector12ISR();
 extern void TimerOverflow();
 extern void RTIISR();
+extern void SCI0TXCompleteISR();
+
+/**
+ * Overflow count of the reference timer, incremented by TimerOverflow().
+ * Used by the HAL to extend 16 bit time stamps to 32 bit.
+ */
+extern volatile unsigned short timerExtensionClock;
 
 #endif /* HAL_FREEEMS_INTERFACE_H_ */
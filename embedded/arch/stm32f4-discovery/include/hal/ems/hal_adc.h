@@ -0,0 +1,75 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @ingroup halInterface
+ * @brief Continuous acquisition of all ADC channels.
+ * All channels are scanned continuously into a small pool of buffers without
+ * involving the CPU. Readers hold complete buffers by index instead of copying
+ * them; a held buffer is not overwritten until it is released.
+ * @file hal_adc.h
+ */
+#ifndef HAL_ADC_H_
+#define HAL_ADC_H_
+
+/**
+ * Number of channels per scan, in the order of the ADCArray struct.
+ */
+#define HAL_ADC_CHANNELS 16
+
+/**
+ * Largest reading. Readings are 10 bit like those of the ATD they replace, the
+ * transfer tables have one entry per value, see ADC_DIVISIONS.
+ */
+#define HAL_ADC_MAX 1023
+
+/**
+ * Number of scan buffers. Two are needed by the acquisition itself, one for
+ * the latest complete scan, the rest may be held at the same time.
+ */
+#define HAL_ADC_BUFFERS 6
+
+/**
+ * @brief Holds the latest complete scan and returns its buffer index.
+ * Must only be called from interrupt context or before interrupts are
+ * enabled, as must hal_adc_release(uint8_t).
+ * @return The index of the held buffer.
+ */
+extern uint8_t hal_adc_acquire(void);
+
+/**
+ * @brief Releases a buffer held by hal_adc_acquire(void).
+ * @param index The index of the buffer.
+ */
+extern void hal_adc_release(uint8_t index);
+
+/**
+ * @brief Returns the content of a held buffer.
+ * @param index The index of the buffer.
+ * @return HAL_ADC_CHANNELS readings.
+ */
+extern const volatile uint16_t* hal_adc_buffer(uint8_t index);
+
+/**
+ * @brief Copies the latest complete scan.
+ * May be called from the main loop; retries if a scan completes meanwhile.
+ * @param dest Space for HAL_ADC_CHANNELS readings.
+ */
+extern void hal_adc_read(uint16_t* dest);
+
+#endif /* HAL_ADC_H_ */
@@ -27,6 +27,19 @@
 #ifndef HAL_IO_H_
 #define HAL_IO_H_
 
+#include <ems/channels.h>
+
+/**
+ * @brief Number of injection channels this HAL can drive.
+ * TIM3 channels 1-4, TIM4 channels 1, 2 and 4 and TIM2 channel 1, all
+ * driven by TIM1.
+ */
+#define HAL_INJECTION_CHANNELS_MAX 8
+
+#if EMS_CHANNELS > HAL_INJECTION_CHANNELS_MAX
+#error "Too many cylinders for this platform, see HAL_INJECTION_CHANNELS_MAX"
+#endif
+
 /**
  * @author Andreas Meixner
  * @brief This enum defines all available I/O channels FreeEMS may use.
@@ -84,6 +97,26 @@ typedef enum channel_ids {
    * eighth zylinder.
    */
   INJECTION8_OUTPUT = 17,
+  /**
+   * ID of the output channel that is connected to the main injection of the
+   * ninth zylinder.
+   */
+  INJECTION9_OUTPUT = 18,
+  /**
+   * ID of the output channel that is connected to the main injection of the
+   * tenth zylinder.
+   */
+  INJECTION10_OUTPUT = 19,
+  /**
+   * ID of the output channel that is connected to the main injection of the
+   * eleventh zylinder.
+   */
+  INJECTION11_OUTPUT = 20,
+  /**
+   * ID of the output channel that is connected to the main injection of the
+   * twelfth zylinder.
+   */
+  INJECTION12_OUTPUT = 21,
   /**
    * ID of the output channel that is connected to the staged injection of the
    * first zylinder.
@@ -124,6 +157,26 @@ typedef enum channel_ids {
    * eighth zylinder.
    */
   STAGED_INJECTION8_OUTPUT = 37,
+  /**
+   * ID of the output channel that is connected to the staged injection of the
+   * ninth zylinder.
+   */
+  STAGED_INJECTION9_OUTPUT = 38,
+  /**
+   * ID of the output channel that is connected to the staged injection of the
+   * tenth zylinder.
+   */
+  STAGED_INJECTION10_OUTPUT = 39,
+  /**
+   * ID of the output channel that is connected to the staged injection of the
+   * eleventh zylinder.
+   */
+  STAGED_INJECTION11_OUTPUT = 40,
+  /**
+   * ID of the output channel that is connected to the staged injection of the
+   * twelfth zylinder.
+   */
+  STAGED_INJECTION12_OUTPUT = 41,
   /**
    * ID of the channel that causes the ignition coil of the first zylinder.
    * Pulling this pin up means charging the coil, pulling it down fires
@@ -172,6 +225,30 @@ typedef enum channel_ids {
    * fires theignition.
    */
   IGNITION8_OUTPUT = 57,
+  /**
+   * ID of the channel that causes the ignition coil of the ninth zylinder to
+   * charge up. Pulling this pin up means charging the coil, pulling it down
+   * fires the ignition.
+   */
+  IGNITION9_OUTPUT = 58,
+  /**
+   * ID of the channel that causes the ignition coil of the tenth zylinder to
+   * charge up. Pulling this pin up means charging the coil, pulling it down
+   * fires the ignition.
+   */
+  IGNITION10_OUTPUT = 59,
+  /**
+   * ID of the channel that causes the ignition coil of the eleventh zylinder to
+   * charge up. Pulling this pin up means charging the coil, pulling it down
+   * fires the ignition.
+   */
+  IGNITION11_OUTPUT = 60,
+  /**
+   * ID of the channel that causes the ignition coil of the twelfth zylinder to
+   * charge up. Pulling this pin up means charging the coil, pulling it down
+   * fires the ignition.
+   */
+  IGNITION12_OUTPUT = 61,
   /**
    * ID of the first GPIO channel used for debugoutput.
    * This was channel 0 on port J on the original FreeEMS board.
@@ -214,6 +291,16 @@ typedef enum channel_ids {
   DEBUG_OUTPUT_8 = 107
 } channelid_t;
 
+/*
+ * The IDs of each kind of output have to be consecutive: outputs are mapped by
+ * their offset from the first ID, and switches on the IDs need distinct values.
+ */
+#define HAL_IO_CONSECUTIVE(first, last) \
+  typedef char hal_io_consecutive_##first[((last) - (first) == 11) ? 1 : -1]
+HAL_IO_CONSECUTIVE(INJECTION1_OUTPUT, INJECTION12_OUTPUT);
+HAL_IO_CONSECUTIVE(STAGED_INJECTION1_OUTPUT, STAGED_INJECTION12_OUTPUT);
+HAL_IO_CONSECUTIVE(IGNITION1_OUTPUT, IGNITION12_OUTPUT);
+
 /**
  * @author Andreas Meixner
  * This array is only needed internally by the INJECTIONX_OUTPUT(channelNumber)
@@ -37,6 +37,15 @@
  */
 extern uint16_t hal_timer_ic_capture_get(channelid_t channel_id);
 
+/**
+ * Returns the time stamp of the last capture event on the given @a channel_id
+ * in the 32 bit time base of hal_timer_time_get32().
+ * The capture event must not be older than one period of the 16 bit timer.
+ * @param channel_id The input capture channel id.
+ * @return 32 bit time stamp of the capture event.
+ */
+extern uint32_t hal_timer_ic_capture_get32(channelid_t channel_id);
+
 /**
  * @author Andreas Meixner
  * Returns the pin state of the input capture channel.
@@ -0,0 +1,40 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @ingroup halInterface
+ * @brief Transmission of complete frames on the main serial interface.
+ * FreeEMS hands over a fully framed and escaped packet, the HAL moves it out
+ * without further involvement of the CPU where the hardware allows it and calls
+ * SCI0TXCompleteISR() once the buffer may be reused.
+ * @file hal_serial.h
+ */
+#ifndef HAL_SERIAL_H_
+#define HAL_SERIAL_H_
+
+/**
+ * @brief Starts the transmission of a frame.
+ * The data is not copied and must stay untouched until SCI0TXCompleteISR() is
+ * called, which may happen before this function returns. Only one frame can
+ * be in flight at a time.
+ * @param data The bytes to send.
+ * @param length The number of bytes to send, must not be 0.
+ */
+extern void hal_serial_transmit(const uint8_t* data, uint16_t length);
+
+#endif /* HAL_SERIAL_H_ */
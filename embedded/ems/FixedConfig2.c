@@ -111,5 +111,21 @@ const volatile fixedConfig2 fixedConfigs2 FIXEDCONF2 = {
     500,
   },
 
-  {"Place your personal notes about whatever you like in here! Don't hesitate to tell us a story about something interesting. Do keep in mind though that when you upload your settings file to the forum this message WILL be visible to all and sundry, so don't be putting too many personal details, bank account numbers, passwords, PIN numbers, license plates, national insurance numbers, IRD numbers, social security numbers, phone numbers, email addresses, love stories and other private information in this field. In fact it is probably best if you keep the information stored here purely related to the vehicle that this system is installed on and relevant to the state of tune and configuration of settings. Lastly, please remember that this field WILL be shrinking in length from it's currently large size to something more reasonable in future. I would like to attempt to keep it at least thirty two characters long though, so writing that much is a non issue, but not more"}
+  {
+    SOURCE_PRESET,	/* IATSource */
+    SOURCE_PRESET,	/* CHTSource */
+    SOURCE_PRESET,	/* TPSSource */
+    SOURCE_PRESET,	/* EGOSource */
+    SOURCE_PRESET,	/* BRVSource */
+    SOURCE_PRESET,	/* MAPSource */
+    SOURCE_PRESET,	/* AAPSource */
+    SOURCE_PRESET,	/* MATSource */
+    SOURCE_PRESET,	/* EGO2Source */
+    SOURCE_PRESET,	/* IAPSource */
+    SOURCE_NONE,	/* MAFSource */
+    LOAD_FROM_MAP,	/* loadSource */
+    AIRFLOW_SPEED_DENSITY	/* airFlowSource */
+  },
+
+  {"Place your personal notes about whatever you like in here! Don't hesitate to tell us a story about something interesting. Do keep in mind though that when you upload your settings file to the forum this message WILL be visible to all and sundry, so don't be putting too many personal details, bank account numbers, passwords, PIN numbers, license plates, national insurance numbers, IRD numbers, social security numbers, phone numbers, email addresses, love stories and other private information in this field. In fact it is probably best if you keep the information stored here purely related to the vehicle that this system is installed on and relevant to the state of tune and configuration of settings. Lastly, please remember that this field WILL be shrinking in length from it's currently large size to something more reasonable in future. I would like to attempt to keep it at least thirty two characters long though, so writing that much is a non issue."}
 };
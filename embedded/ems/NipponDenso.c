@@ -56,9 +56,14 @@
 #include "inc/interrupts.h"
 #include "inc/DecoderInterface.h"
 #include "inc/utils.h"
+#include "inc/tripleBuffer.h"
+#include "inc/toothLogger.h"
+#include "inc/latencyChains.h"
+#include "inc/isrLatency.h"
 #include <hal/ems/freeems_hal.h>
 #include <hal/log.h>
 #include <ems/performance.h>
+#include <ems/deferredLog.h>
 
 /*
 #ifdef __PERF__
@@ -109,7 +114,7 @@ char PrimaryRPMISR_wrapped()
 void PrimaryRPMISR()
 #endif
 */
-PERF_WRAP_PATH(PrimaryRPMISR, "p") {
+PERF_WRAP_PATH(PrimaryRPMISR, "p", PERF_REGION_PRIMARY_RPM) {
   /* Save all relevant available data here */
   /* Save the current timer count */
   unsigned short codeStartTimeStamp = hal_timer_time_get();
@@ -117,14 +122,23 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
   PERF_PATH_INIT('x');
 
   /* Save the edge time stamp */
-  unsigned short edgeTimeStamp = hal_timer_ic_capture_get(PRIMARY_RPM_INPUT);
+  unsigned long edgeTimeStampLong = hal_timer_ic_capture_get32(PRIMARY_RPM_INPUT);
+  unsigned short edgeTimeStamp = (unsigned short)edgeTimeStampLong;
   //AM: this has changed a little. instead o a bit mask this value is now 1 if the pin is high or 0 otherwise.
   //    the condition of the if a few lines later has to change too
   /* Save the values on port T regardless of the state of DDRT */
   unsigned char PTITCurrentState = hal_timer_ic_pin_get(PRIMARY_RPM_INPUT);
 
+  toothLogRecord(edgeTimeStampLong,
+                 (PTITCurrentState ? TOOTH_LOG_PIN_HIGH : 0)
+                 | ((coreStatusA & PRIMARY_SYNC) ? TOOTH_LOG_SYNC : 0));
+
   /* Calculate the latency in ticks */
   ISRLatencyVars.primaryInputLatency = codeStartTimeStamp - edgeTimeStamp;
+  isrLatencyRecord(ISR_LATENCY_PRIMARY_RPM, ISRLatencyVars.primaryInputLatency);
+  /* The same as a 32 bit time for the latency chains */
+  unsigned long codeStartTimeStampLong = edgeTimeStampLong
+                                         + ISRLatencyVars.primaryInputLatency;
 
   /** @todo TODO discard narrow ones! test for tooth width and tooth period
    * the width should be based on how the hardware is setup. IE the LM1815
@@ -149,12 +163,11 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
 
     // calculate rough rpm (this will be wrong when the var is used correctly)
     /* 0.8us ticks, 150mil = 2 x 60 seconds, times rpm scale factor of 2 */
-    *RPMRecord = ticksPerCycleAtOneRPMx2 / engineCyclePeriod;
+    RPMRecord = ticksPerCycleAtOneRPMx2 / engineCyclePeriod;
 
     // don't run until the second trigger has come in and the period is correct
     // (VERY temporary)
     if (!(coreStatusA & PRIMARY_SYNC)) {
-      log_printf("EP s1\r\n");
       primaryTeethDroppedFromLackOfSync++;
       /*
       #ifdef __PERF__
@@ -166,32 +179,26 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
       PERF_PATH_RETURN();
     }
 
-    LongTime timeStamp;
-
-    /* Install the low word */
-    timeStamp.timeShorts[0] = edgeTimeStamp;
-    /* Find out what our timer value means and put it in the high word */
-    if (hal_timer_overflow_get() && !(edgeTimeStamp & 0x8000)) {
-      timeStamp.timeShorts[1] = timerExtensionClock + 1;
-    }
-    else {
-      timeStamp.timeShorts[1] = timerExtensionClock;
-    }
-
     // temporary data from inputs
-    primaryLeadingEdgeTimeStamp = timeStamp.timeLong;
+    primaryLeadingEdgeTimeStamp = edgeTimeStampLong;
     timeBetweenSuccessivePrimaryPulses = primaryLeadingEdgeTimeStamp
                                          - lastPrimaryPulseTimeStamp;
     lastPrimaryPulseTimeStamp = primaryLeadingEdgeTimeStamp;
 
+    /* Feed the RPM estimator, the math is done later in the main loop */
+    toothTimeStamps[toothRingHead & TOOTH_RING_MASK] = edgeTimeStampLong;
+    toothRingHead++;
+    if (toothRingFill < TOOTH_RING_LENGTH) {
+      toothRingFill++;
+    }
+
 
     // TODO make scheduling either fixed from boot with a limited range, OR
     //      preferrably if its practical scheduled on the fly to allow arbitrary
     //      advance and retard of both fuel and ignition.
 
     /* Check for loss of sync by too high a count */
-    if (primaryPulsesPerSecondaryPulse > 12) {
-      log_printf("EP s2\r\n");
+    if (primaryPulsesPerSecondaryPulse > PRIMARY_PULSES_PER_SECONDARY_PULSE) {
       /* Increment the lost sync count */
       Counters.crankSyncLosses++;
 
@@ -229,18 +236,31 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
     //      code doesn't care when/how it has started in the past, and hopefully
     //      ign will be the same.
 
-    // this will be done with an array and per tooth check in future
-    if ((primaryPulsesPerSecondaryPulse % 2) == 0) {
+    /* Number of the channel scheduled on this tooth plus one, or zero if it is
+     * not a channel tooth */
+    unsigned char channelEvent =
+      CHANNEL_EVENTS_UP_TO_TOOTH(primaryPulsesPerSecondaryPulse);
+    if (channelEvent
+        == CHANNEL_EVENTS_UP_TO_TOOTH(primaryPulsesPerSecondaryPulse - 1)) {
+      channelEvent = 0;
+    }
+
+    if (channelEvent != 0) {
       PERF_PATH_SET('e');
 
       // TODO sample ADCs on teeth other than that used by the scheduler in
       //      order to minimise peak run time and get clean signals
-      sampleEachADC(ADCArrays);
+      SensorSnapshot* snapshot =
+        &sensorSnapshots[tripleBufferWriteBegin(&sensorSnapshotBuffer)];
+      /* Hand back the scan the slot held before and keep the latest one */
+      hal_adc_release(snapshot->ADCBuffer);
+      snapshot->ADCBuffer = hal_adc_acquire();
       Counters.syncedADCreadings++;
-      *mathSampleTimeStampRecord = hal_timer_time_get();
+      snapshot->RPM = RPMRecord;
+      snapshot->sampleTimeStamp = hal_timer_time_get();
 
-      /* Set flag to say calc required */
-      coreStatusA |= CALC_FUEL_IGN;
+      /* Hand the snapshot to the main loop, this says calc required */
+      tripleBufferPublish(&sensorSnapshotBuffer);
 
       /* Reset the clock for reading timeout */
       Clocks.timeoutADCreadingClock = 0;
@@ -277,14 +297,13 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
         // determine the long and short start times
         unsigned short startTime = primaryLeadingEdgeTimeStamp
                                    + advance;
-        unsigned long startTimeLong = timeStamp.timeLong + advance;
+        unsigned long startTimeLong = edgeTimeStampLong + advance;
 
         /* Determine the channels to schedule */
-        unsigned char fuelChannel = (primaryPulsesPerSecondaryPulse / 2)
-                                    - 1;
-        unsigned char ignitionChannel = (primaryPulsesPerSecondaryPulse
-                                         / 2) - 1;
-        if (fuelChannel > 5 || ignitionChannel > 5) {
+        unsigned char fuelChannel = channelEvent - 1;
+        unsigned char ignitionChannel = channelEvent - 1;
+        if (fuelChannel >= INJECTION_CHANNELS
+            || ignitionChannel >= IGNITION_CHANNELS) {
           /*
           #ifdef __PERF__
           return executionPathIdentifier;
@@ -295,6 +314,11 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
           PERF_PATH_RETURN();
         }
 
+        /* Use the latest complete result of the mathematics */
+        tripleBufferAcquire(&mathResultBuffer);
+        unsigned short* injectorMainPulseWidthsRealtime =
+          mathResults[mathResultBuffer.reading].injectorMainPulseWidths;
+
         // FAK: FIXME: channel 0 gets fired before injection!?!?
         // determine whether or not to reschedule
         unsigned char reschedule = 0;
@@ -311,12 +335,16 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
           hal_timer_oc_active_set(INJECTIONX_OUTPUT(fuelChannel), TRUE);
           hal_timer_oc_output_set(INJECTIONX_OUTPUT(fuelChannel), OC_MODE_TO_HIGH);
           hal_timer_oc_compare_set(INJECTIONX_OUTPUT(fuelChannel), startTime);
+          latencyChainOpen(LATENCY_INJECTION, fuelChannel, edgeTimeStampLong,
+                           codeStartTimeStampLong, startTimeLong, TRUE);
         }
         else {
           injectorMainStartTimesHolding[fuelChannel] = startTime;
           // setup a bit to let the timer interrupt know to set its own new start from a var
           selfSetTimer |= injectorMainOnMasks[fuelChannel];
-          log_printf("P@%u: Nq%u@%u (%u)\r\n", edgeTimeStamp, fuelChannel, startTime, advance);
+          latencyChainOpen(LATENCY_INJECTION, fuelChannel, edgeTimeStampLong,
+                           codeStartTimeStampLong, startTimeLong, FALSE);
+          log_event("P@%u: Nq%u@%u (%u)\r\n", edgeTimeStamp, fuelChannel, startTime, advance);
         }
 
         // TODO advance/retard/dwell numbers all need range checking etc done.
@@ -345,7 +373,9 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
           hal_timer_pit_interval_set(IGNITION_DWELL_PIT, advance);
           // turn on the ints
           hal_timer_pit_active_set(IGNITION_DWELL_PIT, TRUE);
-          log_printf("P@%u: IDa%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance);
+          latencyChainOpen(LATENCY_DWELL, ignitionChannel, edgeTimeStampLong,
+                           codeStartTimeStampLong, startTimeLong, TRUE);
+          log_event("P@%u: IDa%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance);
         }
         else
           if (dwellQueueLength == 0) {
@@ -356,7 +386,9 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
                                          IGNITION_DWELL_PIT));
             // increment queue length
             dwellQueueLength++;
-            log_printf("P@%u: IDd%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance - hal_timer_pit_current_get(IGNITION_DWELL_PIT));
+            latencyChainOpen(LATENCY_DWELL, ignitionChannel, edgeTimeStampLong,
+                             codeStartTimeStampLong, startTimeLong, FALSE);
+            log_event("P@%u: IDd%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance - hal_timer_pit_current_get(IGNITION_DWELL_PIT));
           }
           else
             if (dwellQueueLength
@@ -386,7 +418,9 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
                      + sumOfDwells);
               // increment queue length from one or more
               dwellQueueLength++;
-              log_printf("P@%u: IDq%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance - (hal_timer_pit_current_get(IGNITION_DWELL_PIT) + sumOfDwells));
+              latencyChainOpen(LATENCY_DWELL, ignitionChannel, edgeTimeStampLong,
+                               codeStartTimeStampLong, startTimeLong, FALSE);
+              log_event("P@%u: IDq%u@%u\r\n", edgeTimeStamp, nextDwellChannel, advance - (hal_timer_pit_current_get(IGNITION_DWELL_PIT) + sumOfDwells));
             }
 
         // IGNITION experimental stuff
@@ -403,7 +437,11 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
                                      + injectorMainPulseWidthsRealtime[fuelChannel]);
         //PITLD1 = ignitionAdvances[ignitionChannel + outputBankIgnitionOffset];
           hal_timer_pit_active_set(IGNITION_FIRE_PIT, TRUE);
-          log_printf("P@%u: IFa%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance + injectorMainPulseWidthsRealtime[fuelChannel]);
+          latencyChainOpen(LATENCY_FIRE, ignitionChannel, edgeTimeStampLong,
+                           codeStartTimeStampLong,
+                           startTimeLong + injectorMainPulseWidthsRealtime[fuelChannel],
+                           TRUE);
+          log_event("P@%u: IFa%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance + injectorMainPulseWidthsRealtime[fuelChannel]);
         }
         else
           if (ignitionQueueLength == 0) {
@@ -415,7 +453,11 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
                                          IGNITION_FIRE_PIT));
             // increment to 1
             ignitionQueueLength++;
-            log_printf("P@%u: IFd%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance + injectorMainPulseWidthsRealtime[fuelChannel] - hal_timer_pit_current_get(IGNITION_FIRE_PIT));
+            latencyChainOpen(LATENCY_FIRE, ignitionChannel, edgeTimeStampLong,
+                             codeStartTimeStampLong,
+                             startTimeLong + injectorMainPulseWidthsRealtime[fuelChannel],
+                             FALSE);
+            log_event("P@%u: IFd%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance + injectorMainPulseWidthsRealtime[fuelChannel] - hal_timer_pit_current_get(IGNITION_FIRE_PIT));
           }
           else
             if (ignitionQueueLength
@@ -446,8 +488,12 @@ PERF_WRAP_PATH(PrimaryRPMISR, "p") {
 
               // increment from 1 or more
               ignitionQueueLength++;
+              latencyChainOpen(LATENCY_FIRE, ignitionChannel, edgeTimeStampLong,
+                               codeStartTimeStampLong,
+                               startTimeLong + injectorMainPulseWidthsRealtime[fuelChannel],
+                               FALSE);
 
-              log_printf("P@%u: IFq%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance - (hal_timer_pit_current_get(IGNITION_FIRE_PIT) + sumOfIgnitions));
+              log_event("P@%u: IFq%u@%u\r\n", edgeTimeStamp, nextIgnitionChannel, advance - (hal_timer_pit_current_get(IGNITION_FIRE_PIT) + sumOfIgnitions));
             }
       }
     }
@@ -524,17 +570,22 @@ void SecondaryRPMISR_wrapped()
 void SecondaryRPMISR()
 #endif // __PERF__
 */
-PERF_WRAP_SIMPLE(SecondaryRPMISR, "s") {
+PERF_WRAP_SIMPLE(SecondaryRPMISR, "s", PERF_REGION_SECONDARY_RPM) {
   /* Save all relevant available data here */
   /* Save the current timer count */
   unsigned short codeStartTimeStamp = hal_timer_time_get();
   /* Save the timestamp */
-  unsigned short edgeTimeStamp = hal_timer_ic_capture_get(SECONDARY_RPM_INPUT);
+  unsigned long edgeTimeStampLong = hal_timer_ic_capture_get32(SECONDARY_RPM_INPUT);
+  unsigned short edgeTimeStamp = (unsigned short)edgeTimeStampLong;
+  unsigned char pinState = hal_timer_ic_pin_get(SECONDARY_RPM_INPUT);
 
-  log_printf("s%d\r\n", codeStartTimeStamp);
+  toothLogRecord(edgeTimeStampLong,
+                 TOOTH_LOG_SECONDARY | (pinState ? TOOTH_LOG_PIN_HIGH : 0)
+                 | ((coreStatusA & PRIMARY_SYNC) ? TOOTH_LOG_SYNC : 0));
 
   /* Calculate the latency in ticks */
   ISRLatencyVars.secondaryInputLatency = codeStartTimeStamp - edgeTimeStamp;
+  isrLatencyRecord(ISR_LATENCY_SECONDARY_RPM, ISRLatencyVars.secondaryInputLatency);
 
   /** @todo TODO discard narrow ones! test for tooth width and tooth period
    * the width should be based on how the hardware is setup. IE the LM1815
@@ -548,37 +599,24 @@ PERF_WRAP_SIMPLE(SecondaryRPMISR, "s") {
    * tooth shape, profile and spacing may vary this is the only reliable edge
    * for us to schedule from, hence the trailing edge code is very simple.
    */
-  if (hal_timer_ic_pin_get(SECONDARY_RPM_INPUT)) {
+  if (pinState) {
 
     // was this code like this because of a good reason?
     // primaryPulsesPerSecondaryPulseBuffer = primaryPulsesPerSecondaryPulse;
     primaryPulsesPerSecondaryPulse = 0;
 
     // if we didn't get the right number of pulses drop sync and start over
-    if ((primaryPulsesPerSecondaryPulse != 12)
+    if ((primaryPulsesPerSecondaryPulse != PRIMARY_PULSES_PER_SECONDARY_PULSE)
         && (coreStatusA & PRIMARY_SYNC)) {
       coreStatusA &= CLEAR_PRIMARY_SYNC;
       Counters.crankSyncLosses++;
     }
 
-    LongTime timeStamp;
-
-    /* Install the low word */
-    timeStamp.timeShorts[0] = edgeTimeStamp;
-    /* Find out what our timer value means and put it in the high word */
-    //TODO AM: see same code in PrimaryRPMISR
-    if (hal_timer_overflow_get()) {
-      timeStamp.timeShorts[1] = timerExtensionClock + 1;
-    }
-    else {
-      timeStamp.timeShorts[1] = timerExtensionClock;
-    }
-
     // get the data we actually want
     // save the engine cycle period
-    engineCyclePeriod = 2 * (timeStamp.timeLong - lastSecondaryOddTimeStamp);
+    engineCyclePeriod = 2 * (edgeTimeStampLong - lastSecondaryOddTimeStamp);
     // save this stamp for next time round
-    lastSecondaryOddTimeStamp = timeStamp.timeLong;
+    lastSecondaryOddTimeStamp = edgeTimeStampLong;
 
     // Because this is our only reference, each time we get this pulse, we know
     // where we are at (simple mode so far)
@@ -75,7 +75,8 @@ const volatile SmallTables1 SmallTablesAFlash  TUNETABLESD1 = {
 
 
 const volatile SmallTables2 SmallTablesBFlash TUNETABLESD2 = {
-  ARRAY_OF_6_FUEL_TRIMS,	/* perCylinderFuelTrims[] */
+  ARRAY_OF_12_FUEL_TRIMS,	/* perCylinderFuelTrims[] */
+  ARRAY_OF_16_FILTER_FACTORS,	/* coreVarsFilterFactors[] */
   {
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -73,7 +73,8 @@ const volatile SmallTables1 SmallTablesAFlash2 TUNETABLESD5 = {
 
 
 const volatile SmallTables2 SmallTablesBFlash2 TUNETABLESD6 = {
-  ARRAY_OF_6_FUEL_TRIMS,	/* perCylinderFuelTrims[] */
+  ARRAY_OF_12_FUEL_TRIMS,	/* perCylinderFuelTrims[] */
+  ARRAY_OF_16_FILTER_FACTORS,	/* coreVarsFilterFactors[] */
   {
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
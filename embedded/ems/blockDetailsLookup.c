@@ -109,49 +109,49 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
   case VETableMainLocationID:
     details->RAMPage = RPAGE_FUEL_ONE;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = VETableMainFlashLocation;
     break;
   case VETableMain2LocationID:
     details->RAMPage = RPAGE_FUEL_TWO;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = VETableMainFlash2Location;
     break;
   case VETableSecondaryLocationID:
     details->RAMPage = RPAGE_FUEL_ONE;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = VETableSecondaryFlashLocation;
     break;
   case VETableSecondary2LocationID:
     details->RAMPage = RPAGE_FUEL_TWO;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = VETableSecondaryFlash2Location;
     break;
   case VETableTertiaryLocationID:
     details->RAMPage = RPAGE_FUEL_ONE;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = VETableTertiaryFlashLocation;
     break;
   case VETableTertiary2LocationID:
     details->RAMPage = RPAGE_FUEL_TWO;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = VETableTertiaryFlash2Location;
     break;
   case LambdaTableLocationID:
     details->RAMPage = RPAGE_FUEL_ONE;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = LambdaTableFlashLocation;
     break;
   case LambdaTable2LocationID:
     details->RAMPage = RPAGE_FUEL_TWO;
     details->FlashPage = FUELTABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = LambdaTableFlash2Location;
     break;
 
@@ -159,49 +159,49 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
   case IgnitionAdvanceTableMainLocationID:
     details->RAMPage = RPAGE_TIME_ONE;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = IgnitionAdvanceTableMainFlashLocation;
     break;
   case IgnitionAdvanceTableMain2LocationID:
     details->RAMPage = RPAGE_TIME_TWO;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = IgnitionAdvanceTableMainFlash2Location;
     break;
   case IgnitionAdvanceTableSecondaryLocationID:
     details->RAMPage = RPAGE_TIME_ONE;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = IgnitionAdvanceTableSecondaryFlashLocation;
     break;
   case IgnitionAdvanceTableSecondary2LocationID:
     details->RAMPage = RPAGE_TIME_TWO;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = IgnitionAdvanceTableSecondaryFlash2Location;
     break;
   case InjectionAdvanceTableMainLocationID:
     details->RAMPage = RPAGE_TIME_ONE;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = InjectionAdvanceTableMainFlashLocation;
     break;
   case InjectionAdvanceTableMain2LocationID:
     details->RAMPage = RPAGE_TIME_TWO;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = InjectionAdvanceTableMainFlash2Location;
     break;
   case InjectionAdvanceTableSecondaryLocationID:
     details->RAMPage = RPAGE_TIME_ONE;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = InjectionAdvanceTableSecondaryFlashLocation;
     break;
   case InjectionAdvanceTableSecondary2LocationID:
     details->RAMPage = RPAGE_TIME_TWO;
     details->FlashPage = TIMETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = InjectionAdvanceTableSecondaryFlash2Location;
     break;
 
@@ -209,49 +209,49 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
   case SmallTablesALocationID:
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = SmallTablesAFlashLocation;
     break;
   case SmallTablesA2LocationID:
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA;
     details->FlashAddress = SmallTablesAFlash2Location;
     break;
   case SmallTablesBLocationID:
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = SmallTablesBFlashLocation;
     break;
   case SmallTablesB2LocationID:
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB;
     details->FlashAddress = SmallTablesBFlash2Location;
     break;
   case SmallTablesCLocationID:
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = SmallTablesCFlashLocation;
     break;
   case SmallTablesC2LocationID:
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC;
     details->FlashAddress = SmallTablesCFlash2Location;
     break;
   case SmallTablesDLocationID:
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = SmallTablesDFlashLocation;
     break;
   case SmallTablesD2LocationID:
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD;
     details->FlashAddress = SmallTablesDFlash2Location;
     break;
 
@@ -260,116 +260,130 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.dwellDesiredVersusVoltageTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.dwellDesiredVersusVoltageTable;
     details->FlashAddress = dwellDesiredVersusVoltageTableLocation;
     break;
   case dwellDesiredVersusVoltageTable2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.dwellDesiredVersusVoltageTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.dwellDesiredVersusVoltageTable;
     details->FlashAddress = dwellDesiredVersusVoltageTable2Location;
     break;
   case injectorDeadTimeTableLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.injectorDeadTimeTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.injectorDeadTimeTable;
     details->FlashAddress = injectorDeadTimeTableLocation;
     break;
   case injectorDeadTimeTable2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.injectorDeadTimeTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.injectorDeadTimeTable;
     details->FlashAddress = injectorDeadTimeTable2Location;
     break;
   case postStartEnrichmentTableLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.postStartEnrichmentTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.postStartEnrichmentTable;
     details->FlashAddress = postStartEnrichmentTableLocation;
     break;
   case postStartEnrichmentTable2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.postStartEnrichmentTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.postStartEnrichmentTable;
     details->FlashAddress = postStartEnrichmentTable2Location;
     break;
   case engineTempEnrichmentTableFixedLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.engineTempEnrichmentTableFixed;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.engineTempEnrichmentTableFixed;
     details->FlashAddress = engineTempEnrichmentTableFixedLocation;
     break;
   case engineTempEnrichmentTableFixed2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.engineTempEnrichmentTableFixed;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.engineTempEnrichmentTableFixed;
     details->FlashAddress = engineTempEnrichmentTableFixed2Location;
     break;
   case primingVolumeTableLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.primingVolumeTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.primingVolumeTable;
     details->FlashAddress = primingVolumeTableLocation;
     break;
   case primingVolumeTable2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.primingVolumeTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.primingVolumeTable;
     details->FlashAddress = primingVolumeTable2Location;
     break;
   case engineTempEnrichmentTablePercentLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.engineTempEnrichmentTablePercent;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.engineTempEnrichmentTablePercent;
     details->FlashAddress = engineTempEnrichmentTablePercentLocation;
     break;
   case engineTempEnrichmentTablePercent2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.engineTempEnrichmentTablePercent;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.engineTempEnrichmentTablePercent;
     details->FlashAddress = engineTempEnrichmentTablePercent2Location;
     break;
   case dwellMaxVersusRPMTableLocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.dwellMaxVersusRPMTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.dwellMaxVersusRPMTable;
     details->FlashAddress = dwellMaxVersusRPMTableLocation;
     break;
   case dwellMaxVersusRPMTable2LocationID:
     details->size = TWODTABLEUS_SIZE;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.dwellMaxVersusRPMTable;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.dwellMaxVersusRPMTable;
     details->FlashAddress = dwellMaxVersusRPMTable2Location;
     break;
 
     /* TablesB small tables */
   case perCylinderFuelTrimsLocationID:
-    details->size = 12;
+    details->size = 24;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB.SmallTablesB.perCylinderFuelTrims;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.perCylinderFuelTrims;
     details->FlashAddress = perCylinderFuelTrimsLocation;
     break;
   case perCylinderFuelTrims2LocationID:
-    details->size = 12;
+    details->size = 24;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB.SmallTablesB.perCylinderFuelTrims;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.perCylinderFuelTrims;
     details->FlashAddress = perCylinderFuelTrims2Location;
     break;
+  case coreVarsFilterFactorsLocationID:
+    details->size = 32;
+    details->RAMPage = RPAGE_TUNE_ONE;
+    details->FlashPage = TUNETABLES_PPAGE;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.coreVarsFilterFactors;
+    details->FlashAddress = coreVarsFilterFactorsLocation;
+    break;
+  case coreVarsFilterFactors2LocationID:
+    details->size = 32;
+    details->RAMPage = RPAGE_TUNE_TWO;
+    details->FlashPage = TUNETABLES_PPAGE;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.coreVarsFilterFactors;
+    details->FlashAddress = coreVarsFilterFactors2Location;
+    break;
 
     /* TablesC small tables */
     // TODO add data chunks from TablesC when some are put in
@@ -382,56 +396,56 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
     details->size = 576;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.filler;
     details->FlashAddress = fillerALocation;
     break;
   case fillerA2LocationID:
     details->size = 576;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesA.SmallTablesA.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesA.SmallTablesA.filler;
     details->FlashAddress = fillerA2Location;
     break;
   case fillerBLocationID:
-    details->size = 1012;
+    details->size = sizeof(SmallTablesBFlash.filler);
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB.SmallTablesB.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.filler;
     details->FlashAddress = fillerBLocation;
     break;
   case fillerB2LocationID:
-    details->size = 1012;
+    details->size = sizeof(SmallTablesBFlash.filler);
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesB.SmallTablesB.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesB.SmallTablesB.filler;
     details->FlashAddress = fillerB2Location;
     break;
   case fillerCLocationID:
     details->size = 1024;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC.SmallTablesC.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC.SmallTablesC.filler;
     details->FlashAddress = fillerCLocation;
     break;
   case fillerC2LocationID:
     details->size = 1024;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesC.SmallTablesC.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesC.SmallTablesC.filler;
     details->FlashAddress = fillerC2Location;
     break;
   case fillerDLocationID:
     details->size = 1024;
     details->RAMPage = RPAGE_TUNE_ONE;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD.SmallTablesD.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD.SmallTablesD.filler;
     details->FlashAddress = fillerDLocation;
     break;
   case fillerD2LocationID:
     details->size = 1024;
     details->RAMPage = RPAGE_TUNE_TWO;
     details->FlashPage = TUNETABLES_PPAGE;
-    details->RAMAddress = (void*)&TablesD.SmallTablesD.filler;
+    details->RAMAddress = (void*)&TABLE_PAGE(details->RAMPage)->TablesD.SmallTablesD.filler;
     details->FlashAddress = fillerD2Location;
     break;
 
@@ -483,6 +497,11 @@ unsigned short lookupBlockDetails(unsigned short locationID, blockDetails* detai
     details->FlashPage = PPAGE;
     details->FlashAddress = (void*)&(fixedConfigs2.userTextField2);
     break;
+  case sensorSourcesLocationID:
+    details->size = SENSOR_SOURCES_SIZE;
+    details->FlashPage = PPAGE;
+    details->FlashAddress = (void*)&(fixedConfigs2.sensorSources);
+    break;
 
   default:
     /* Return early if locationID is not valid. */
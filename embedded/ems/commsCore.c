@@ -49,87 +49,37 @@
 #include "inc/interrupts.h"
 #include "inc/utils.h"
 #include "inc/tableLookup.h"
+#include "inc/tableBanks.h"
 #include "inc/blockDetailsLookup.h"
 #include "inc/commsCore.h"
+#include "inc/sensorPipeline.h"
+#include "inc/datalogRing.h"
+#include "inc/toothLogger.h"
+#include "inc/latencyChains.h"
+#include "inc/isrLatency.h"
+#include "inc/frameEncoder.h"
+#include <hal/ems/freeems_hal.h>
 #include <string.h>
 #include <stdint.h>
 
 
-/** @brief Populate a basic datalog packet
+/** @brief Send the frame built by the encoder
  *
- * Copies various chunks of data to the transmission buffer and truncates to
- * the configured length. If changing this, update the maxBasicDatalogLength.
+ * Closes the frame and hands it to the interfaces that need to send it out.
+ * SCI0 keeps its TXBufferInUseFlags bit until SCI0TXCompleteISR() is called.
  *
- * @author Fred Cooke
- *
- * @warning This function is only a skeleton at this time.
- */
-void populateBasicDatalog() {
-  /* Save the current position */
-  unsigned char* position = TXBufferCurrentPositionHandler;
-
-  DerivedVars->sp5++; // increment as basic log sequence generator
-
-  /* Get core vars */
-  memcpy(TXBufferCurrentPositionHandler, CoreVars, sizeof(CoreVar));
-  TXBufferCurrentPositionHandler += sizeof(CoreVar);
-  /* Get derived vars */
-  memcpy(TXBufferCurrentPositionHandler, DerivedVars, sizeof(DerivedVar));
-  TXBufferCurrentPositionHandler += sizeof(DerivedVar);
-  /* Get raw adc counts */
-  memcpy(TXBufferCurrentPositionHandler, ADCArrays, sizeof(ADCArray));
-  TXBufferCurrentPositionHandler += sizeof(ADCArray);
-
-  /* Set/Truncate the log to the specified length */
-  TXBufferCurrentPositionHandler = position + configuredBasicDatalogLength;
-}
-
-
-/** @brief Checksum a packet and send it
- *
- * This functions job is to finalise the main loop part of the packet sending
- * process. It runs a checksum over the packet data and tags it to the end
- * before configuring the various ISRs that need to send the data out.
- *
- * @author Fred Cooke
- *
- * @bug http://freeems.aaronb.info/tracker/view.php?id=81
- * @todo TODO fix the double/none start byte bug and remove the hack!
+ * @param TXPacketLengthToSend is the packet length including the checksum.
  */
-void checksumAndSend() {
-  /* Get the length from the pointer */
-  unsigned short TXPacketLengthToSend = (uintptr_t)TXBufferCurrentPositionHandler - (uintptr_t)&TXBuffer;
-
-  /* Tag the checksum on the end */
-  *TXBufferCurrentPositionHandler = checksum((unsigned char*)&TXBuffer, TXPacketLengthToSend);
-  TXPacketLengthToSend++;
-
+static void sendFrame(unsigned short TXPacketLengthToSend) {
   /* Send it out on all the channels required. */
 
   /* SCI0 - Main serial interface */
   if(TXBufferInUseFlags & COM_SET_SCI0_INTERFACE_ID) {
     /* Copy numbers to interface specific vars */
-    TXPacketLengthToSendSCI0 = TXPacketLengthToSend;
     TXPacketLengthToSendCAN0 = TXPacketLengthToSend;
 
-    /* Queue preamble by clearing and then setting transmit enable	*/
-    /* See section 11.4.5.2 of the xdp512 specification document	*/
-    //SCI0CR2 &= SCICR2_TX_DISABLE;
-    //SCI0CR2 |= SCICR2_TX_ENABLE;
-
-    /* Initiate transmission */
-    SCI0DRL = START_BYTE;
-    while(!(SCI0SR1 & 0x80)) {
-      /* Wait for ever until able to send then move on */
-    }
-    // nasty hack that works... means at least one and most 2 starts are sent so
-    // stuff works, but is messy... there must be a better way.
-    SCI0DRL = START_BYTE;
-
-    /* Note : Order Is Important! */
-    /* TX empty flag is already set, so we must clear it by writing out before
-     * enabling the interrupt */
-    SCI0CR2 |= SCICR2_TX_ISR_ENABLE;
+    /* Initiate transmission, the frame goes out without the CPU */
+    hal_serial_transmit(TXStagingBuffer, frameEnd());
   }
   /* CAN0 - Main CAN interface */
   if(TXBufferInUseFlags & COM_SET_CAN0_INTERFACE_ID) {
@@ -169,6 +119,84 @@ void checksumAndSend() {
 }
 
 
+/** @brief Checksum a packet and send it
+ *
+ * This functions job is to finalise the main loop part of the packet sending
+ * process. The packet in TXBuffer is checksummed and framed in one pass before
+ * it is handed to the interfaces that need to send it out.
+ *
+ * @author Fred Cooke
+ */
+void checksumAndSend() {
+  /* Get the length from the pointer */
+  unsigned short TXPacketLengthToSend = (uintptr_t)TXBufferCurrentPositionHandler - (uintptr_t)&TXBuffer;
+
+  frameBegin();
+  frameAppend(&TXBuffer, TXPacketLengthToSend);
+  sendFrame(TXPacketLengthToSend + 1);
+}
+
+
+/** @brief Append at most the remaining length of a block to the frame
+ *
+ * @return the length still remaining after the block
+ */
+static unsigned short appendTruncated(const void* block, unsigned short size, unsigned short remaining) {
+  if(size > remaining) {
+    size = remaining;
+  }
+  frameAppend(block, size);
+  return remaining - size;
+}
+
+
+/** @brief Send a basic datalog packet
+ *
+ * The header must already be in TXBuffer. The variables are then streamed
+ * straight into the frame, truncated to the configured length, and the packet
+ * is sent. If changing this, update the maxBasicDatalogLength.
+ *
+ * @author Fred Cooke
+ */
+void sendBasicDatalog() {
+  unsigned short headerLength = (uintptr_t)TXBufferCurrentPositionHandler - (uintptr_t)&TXBuffer;
+  unsigned short remaining = configuredBasicDatalogLength;
+
+  DerivedVars->sp5++; // increment as basic log sequence generator
+
+  frameBegin();
+  frameAppend(&TXBuffer, headerLength);
+  /* Core vars, derived vars, raw adc counts, code runtimes and main loop load */
+  remaining = appendTruncated(CoreVars, sizeof(CoreVar), remaining);
+  remaining = appendTruncated(DerivedVars, sizeof(DerivedVar), remaining);
+  remaining = appendTruncated(ADCArrays, sizeof(ADCArray), remaining);
+  appendTruncated(&RuntimeVars, sizeof(RuntimeVar), remaining);
+
+  sendFrame(headerLength + configuredBasicDatalogLength + 1);
+}
+
+
+/** @brief Validate a received block
+ *
+ * Delegate the validation of a block that is about to be written to RAM or
+ * flash to the check for its table type. Blocks without structure pass.
+ *
+ * @param locationID the ID of the block being replaced.
+ * @param block the received contents of the block.
+ *
+ * @return An error code. Zero means success, anything else is a failure.
+ */
+static unsigned short validateBlock(unsigned short locationID, void* block) {
+  if(locationID < 16) {
+    return validateMainTable((mainTable*)block);
+  }
+  if((locationID > 399) && (locationID < 900)) {
+    return validateTwoDTable((twoDTableUS*)block);
+  }
+  return 0;
+}
+
+
 /** @brief Decode a packet and respond
  *
  * This is the core function that controls which functionality is run when a
@@ -183,7 +211,6 @@ void decodePacketAndRespond() {
   TXBufferCurrentPositionHandler = (unsigned char*)&TXBuffer;
 
   /* Initialised here such that override is possible */
-  TXBufferCurrentPositionSCI0 = (unsigned char*)&TXBuffer;
   TXBufferCurrentPositionCAN0 = (unsigned char*)&TXBuffer;
 
   /* Start this off as full packet length and build down to the actual length */
@@ -376,37 +403,26 @@ void decodePacketAndRespond() {
       break;
     }
 
-    // TODO factor this out into validation delegation function once the number
-    //      of types increases somewhat
-    unsigned short errorID = 0;
-    if(locationID < 16) {
-      errorID = validateMainTable((mainTable*)RXBufferCurrentPosition);
-    }
-    else
-      if((locationID > 399) && (locationID < 900)) {
-        errorID = validateTwoDTable((twoDTableUS*)RXBufferCurrentPosition);
-      }// TODO add other table types here
+    unsigned short errorID = validateBlock(locationID, RXBufferCurrentPosition);
     /* If the validation failed, report it */
     if(errorID != 0) {
       sendErrorInternal(errorID);
       break;
     }
 
-    /* Save page values for restore */
-    unsigned char oldRamPage = RPAGE;
-    /* Set the viewable ram page */
-    RPAGE = details.RAMPage;
-    /* Copy from the RX buffer to the block of ram */
-    memcpy(details.RAMAddress, RXBufferCurrentPosition, details.size);
+    /* Copy from the RX buffer to the block in the inactive bank */
+    void* editAddress = tableBankEditAddress(details.RAMPage, details.RAMAddress);
+    memcpy(editAddress, RXBufferCurrentPosition, details.size);
     /* Check that the write was successful */
-    unsigned char index = compare(RXBufferCurrentPosition, details.RAMAddress, details.size);
-    /* Restore the original ram and flash pages */
-    RPAGE = oldRamPage;
+    unsigned char index = compare(RXBufferCurrentPosition, editAddress, details.size);
 
     if(index != 0) {
+      tableBankDiscard(details.RAMPage);
       sendErrorInternal(MEMORY_WRITE_ERROR);
     }
     else {
+      /* Make the new block live */
+      tableBankCommit(details.RAMPage);
       /// @todo TODO implement default return of empty packet.
       sendErrorInternal(NO_PROBLEMO);
     }
@@ -432,16 +448,7 @@ void decodePacketAndRespond() {
       break;
     }
 
-    // TODO factor this out into validation delegation function once the number
-    //      of types increases somewhat
-    unsigned short errorID = 0;
-    if(locationID < 16) {
-      errorID = validateMainTable((mainTable*)RXBufferCurrentPosition);
-    }
-    else
-      if((locationID > 399) && (locationID < 900)) {
-        errorID = validateTwoDTable((twoDTableUS*)RXBufferCurrentPosition);
-      }// TODO add other table types here
+    unsigned short errorID = validateBlock(locationID, RXBufferCurrentPosition);
     /* If the validation failed, report it */
     if(errorID != 0) {
       sendErrorInternal(errorID);
@@ -468,22 +475,26 @@ void decodePacketAndRespond() {
 
     /* If present in RAM, update that too */
     if((originalRAMPage != 0) && (originalRAMAddress != 0)) {
-      /* Save page values for restore */
-      unsigned char oldRamPage = RPAGE;
-      /* Set the viewable ram page */
-      RPAGE = originalRAMPage;
-      /* Copy from the RX buffer to the block of ram */
-      memcpy(originalRAMAddress, RXBufferCurrentPosition, details.size);
+      /* Copy from the RX buffer to the block in the inactive bank */
+      void* editAddress = tableBankEditAddress(originalRAMPage, originalRAMAddress);
+      memcpy(editAddress, RXBufferCurrentPosition, details.size);
       /* Check that the write was successful */
-      unsigned char index = compare(RXBufferCurrentPosition, details.RAMAddress, details.size);
-      /* Restore the original ram and flash pages */
-      RPAGE = oldRamPage;
+      unsigned char index = compare(RXBufferCurrentPosition, editAddress, details.size);
 
       if(index != 0) {
+        tableBankDiscard(originalRAMPage);
         sendErrorInternal(MEMORY_WRITE_ERROR);
         break;
       }
+      /* Make the new block live */
+      tableBankCommit(originalRAMPage);
     }
+
+    /* Pick up changed sensor sources straight away */
+    if((locationID == FixedConfig2LocationID) || (locationID == sensorSourcesLocationID)) {
+      resolveSensorPipeline();
+    }
+
     /// @todo TODO implement default return of empty packet.
     sendErrorInternal(NO_PROBLEMO);
     // TODO document errors can always be returned and add error check in to
@@ -524,17 +535,10 @@ void decodePacketAndRespond() {
       break;
     }
 
-    /* Save page value for restore and set the visible page */
-    unsigned char oldRamPage = RPAGE;
-    RPAGE = details.RAMPage;
-
     /* Copy the block of ram to the TX buffer */
     memcpy(TXBufferCurrentPositionHandler, details.RAMAddress, details.size);
     TXBufferCurrentPositionHandler += details.size;
 
-    /* Restore the original ram and flash pages */
-    RPAGE = oldRamPage;
-
     checksumAndSend();
     break;
   }
@@ -864,10 +868,10 @@ void decodePacketAndRespond() {
     /* Set the length field up */
     *TXHeaderFlags |= HEADER_HAS_LENGTH;
     *(unsigned short*)TXBufferCurrentPositionHandler = configuredBasicDatalogLength;
+    TXBufferCurrentPositionHandler += 2;
 
     /* Fill out the log and send */
-    populateBasicDatalog();
-    checksumAndSend();
+    sendBasicDatalog();
     break;
   }
   case requestConfigurableDatalog: {
@@ -882,17 +886,72 @@ void decodePacketAndRespond() {
     }
 
     unsigned char newDatalogType = *((unsigned char*)RXBufferCurrentPosition);
-    if(newDatalogType > 0x01) {
+    if((newDatalogType > asyncDatalogBasic)
+        && (newDatalogType != asyncDatalogCircBuf)
+        && (newDatalogType != asyncDatalogTrigger)) {
       sendErrorInternal(noSuchAsyncDatalogType);
       break;
     }
     else {
+      /* Start the ring over such that the first record is a keyframe */
+      if(newDatalogType == asyncDatalogCircBuf) {
+        datalogRingReset();
+      }
       asyncDatalogType = newDatalogType;
+      /* Edges logged before the switch are stale */
+      if(newDatalogType == asyncDatalogTrigger) {
+        toothLogDiscard();
+      }
     }
     /// @todo TODO implement default return of empty packet.
     sendErrorInternal(NO_PROBLEMO);
     break;
   }
+  case requestLatencyHistogram: {
+    if(RXCalculatedPayloadLength != 3) {
+      sendErrorInternal(payloadLengthTypeMismatch);
+      break;
+    }
+
+    unsigned char kind = *((unsigned char*)RXBufferCurrentPosition);
+    unsigned char channel = *((unsigned char*)RXBufferCurrentPosition + 1);
+    unsigned char clear = *((unsigned char*)RXBufferCurrentPosition + 2);
+    if((kind >= LATENCY_KINDS) || (channel >= EMS_CHANNELS)) {
+      sendErrorInternal(noSuchLatencyHistogram);
+      break;
+    }
+
+    /* This type must have a length field, set that up */
+    *((unsigned short*)TXBufferCurrentPositionHandler) = 2 + sizeof(latencyHistogram);
+    *TXHeaderFlags |= HEADER_HAS_LENGTH;
+    TXBufferCurrentPositionHandler += 2;
+    /* Load the body into place */
+    populateLatencyHistogram(kind, channel, clear);
+    checksumAndSend();
+    break;
+  }
+  case requestISRLatencyHistogram: {
+    if(RXCalculatedPayloadLength != 2) {
+      sendErrorInternal(payloadLengthTypeMismatch);
+      break;
+    }
+
+    unsigned char source = *((unsigned char*)RXBufferCurrentPosition);
+    unsigned char clear = *((unsigned char*)RXBufferCurrentPosition + 1);
+    if(source >= ISR_LATENCY_SOURCES) {
+      sendErrorInternal(noSuchLatencyHistogram);
+      break;
+    }
+
+    /* This type must have a length field, set that up */
+    *((unsigned short*)TXBufferCurrentPositionHandler) = 1 + sizeof(isrLatencyHistogram);
+    *TXHeaderFlags |= HEADER_HAS_LENGTH;
+    TXBufferCurrentPositionHandler += 2;
+    /* Load the body into place */
+    populateISRLatencyHistogram(source, clear);
+    checksumAndSend();
+    break;
+  }
   case forwardPacketOverCAN: {
     // perform function TODO
     sendErrorInternal(unimplementedFunction);
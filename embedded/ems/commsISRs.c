@@ -25,10 +25,11 @@
  *
  * @brief Send and receive bytes serially
  *
- * This file contains the code for both send and receive of serial bytes
- * through the UART SCI0 device. It is purely interrupt driven and controlled
- * by a set of register and non-register flags that are toggled both inside
- * and outside this file. Some additional helper functions are also kept here.
+ * This file contains the code for receiving serial bytes through the UART SCI0
+ * device and for finishing the transmission of frames sent through the HAL. It
+ * is purely interrupt driven and controlled by a set of register and
+ * non-register flags that are toggled both inside and outside this file. Some
+ * additional helper functions are also kept here.
  * <h> original author</h> Fred Cooke
  *
  * @todo TODO SCI0ISR() needs to be split into some hash defines and an include
@@ -55,23 +56,6 @@
  * http://gcc.gnu.org/onlinedocs/gcc-3.3.6/Inline.html#Inline	*/
 
 
-/** @brief Send And Increment
- *
- * Increment the pointer, decrement the length, and send it!
- *
- * @author Fred Cooke
- *
- * @note This is an extern inline function and as such is always inlined.
- *
- * @param rawValue is the raw byte to be sent down the serial line.
- */
-extern inline void sendAndIncrement(unsigned char rawValue) {
-  SCI0DRL = rawValue;
-  TXPacketLengthToSendSCI0--;
-  TXBufferCurrentPositionSCI0++;
-}
-
-
 /** @brief Receive And Increment
  *
  * Store the value and add it to the checksum, then increment the pointer and
@@ -145,9 +129,9 @@ void resetReceiveState(unsigned char sourceIDState) {
 /** @brief Serial Communication Interface 0 ISR
  *
  * SCI0 ISR handles all interrupts for SCI0 by reading flags and acting
- * appropriately. Its functions are to send raw bytes out over the wire from a
- * buffer and to receive bytes from the wire un-escape them, checksum them and
- * store them in a buffer.
+ * appropriately. Its function is to receive bytes from the wire, un-escape
+ * them, checksum them and store them in a buffer. Sending is done by the HAL,
+ * see SCI0TXCompleteISR().
  *
  * @author Fred Cooke
  *
@@ -302,53 +286,16 @@ void SCI0ISR() {
     }
   }
 
-  /* If the TX interrupt is enabled check the register empty flag. */
-  if((SCI0CR2 & SCICR2_TX_ISR_ENABLE) && (flags & SCISR1_TX_REGISTER_EMPTY)) {
-    /* Get the byte to be sent from the buffer */
-    unsigned char rawValue = *TXBufferCurrentPositionSCI0;
-
-    if(TXPacketLengthToSendSCI0 > 0) {
-      if(TXByteEscaped == 0) {
-        /* If the raw value needs to be escaped */
-        if(rawValue == ESCAPE_BYTE) {
-          SCI0DRL = ESCAPE_BYTE;
-          TXByteEscaped = ESCAPED_ESCAPE_BYTE;
-        }
-        else
-          if(rawValue == START_BYTE) {
-            SCI0DRL = ESCAPE_BYTE;
-            TXByteEscaped = ESCAPED_START_BYTE;
-          }
-          else
-            if(rawValue == STOP_BYTE) {
-              SCI0DRL = ESCAPE_BYTE;
-              TXByteEscaped = ESCAPED_STOP_BYTE;
-            }
-            else { /* Otherwise just send it */
-              sendAndIncrement(rawValue);
-            }
-      }
-      else {
-        sendAndIncrement(TXByteEscaped);
-        TXByteEscaped = 0;
-      }
-    }
-    else { /* Length is zero */
-      /* Turn off transmission interrupt */
-      SCI0CR2 &= SCICR2_TX_ISR_DISABLE;
-      /* Send the stop byte */
-      SCI0DRL = STOP_BYTE;
-      while(!(SCI0SR1 & 0x80)) {
-        /* Wait for ever until able to send then move on */
-      }
-      // nasty hack that works... means at least one and most 2 stops are sent
-      // so stuff works, but is messy... there must be a better way.
-      SCI0DRL = STOP_BYTE;
-      /* Clear the TX in progress flag */
-      TXBufferInUseFlags &= COM_CLEAR_SCI0_INTERFACE_ID;
-    }
-  }
-
   /* Record how long the operation took */
   RuntimeVars.serialISRRuntime = hal_timer_time_get() - start;
 }
+
+
+/** @brief SCI0 transmission complete
+ *
+ * Called by the HAL once the frame built by the frame encoder has left
+ * the staging buffer, which frees the TX buffer for the next packet.
+ */
+void SCI0TXCompleteISR() {
+  TXBufferInUseFlags &= COM_CLEAR_SCI0_INTERFACE_ID;
+}
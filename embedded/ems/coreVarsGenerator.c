@@ -39,6 +39,151 @@
 #include "inc/commsCore.h"
 #include "inc/coreVarsGenerator.h"
 #include "inc/DecoderInterface.h"
+#include "inc/sensorPipeline.h"
+#include <hal/ems/freeems_hal.h>
+#include <stdint.h>
+
+
+/* Number of tooth periods averaged into one RPM estimate, must be smaller than
+ * TOOTH_RING_LENGTH */
+#define TOOTH_RPM_SPAN 4
+/* Largest magnitude reported for DRPM and DDRPM */
+#define DELTA_RPM_LIMIT 32767
+
+/* Offsets that map the two's complement core variables onto an unsigned range
+ * for smoothing, in CoreVar order */
+static const unsigned short coreVarsSignOffsets[CORE_VARS_LENGTH] = {
+  0, 0, 0, 0, 0, 0, 0, 0, /* IAT, CHT, TPS, EGO, MAP, AAP, BRV, MAT */
+  0, 0, 0,                /* EGO2, IAP, MAF */
+  0x8000, 0x8000,         /* DMAP, DTPS */
+  0, 0x8000, 0x8000       /* RPM, DRPM, DDRPM */
+};
+/* Set once CoreVars holds a first set of values to smooth against */
+static unsigned char coreVarsFilterPrimed;
+
+/* RPM estimator state, carried from one calculation to the next */
+static unsigned long lastEstimateTime;
+static unsigned short lastEstimatedRPM;
+static signed short lastEstimatedDRPM;
+static signed short lastEstimatedDDRPM;
+/* Number of previous estimates available, 0 to 2 */
+static unsigned char estimateHistory;
+
+
+/** @brief Scale a difference to a rate per second.
+ *
+ * Returns delta * ticksPerSecond / interval, limited to +/-DELTA_RPM_LIMIT. The
+ * sign is handled separately and the interval is taken in 16 tick units so
+ * that the product stays within 32 bits.
+ *
+ * @param delta difference between two successive values
+ * @param interval time between the two values in timer ticks
+ */
+static signed short scaleToPerSecond(signed long delta, unsigned long interval) {
+  unsigned long magnitude = (delta < 0) ? -delta : delta;
+  if (magnitude > DELTA_RPM_LIMIT) {
+    magnitude = DELTA_RPM_LIMIT;
+  }
+  interval >>= 4;
+  if (interval == 0) {
+    interval = 1;
+  }
+  magnitude = (magnitude * (ticksPerSecond >> 4)) / interval;
+  if (magnitude > DELTA_RPM_LIMIT) {
+    magnitude = DELTA_RPM_LIMIT;
+  }
+  return (delta < 0) ? -(signed short)magnitude : (signed short)magnitude;
+}
+
+
+/** @brief Estimate RPM and its derivatives from the tooth ring.
+ *
+ * The primary ISR only stores tooth time stamps, so all divisions happen here.
+ * RPM is taken from the average period of the last TOOTH_RPM_SPAN teeth. If
+ * the next tooth is overdue the time since the last one is used instead, such
+ * that RPM decays towards zero when the engine stops. DRPM and DDRPM are the
+ * differences between successive estimates, scaled to per second by the time
+ * between them.
+ *
+ * @param rpm result in 0.5 RPM units
+ * @param drpm result in 0.5 RPM/s units
+ * @param ddrpm result in 0.5 RPM/s^2 units
+ */
+static void estimateRPM(unsigned short* rpm, signed short* drpm, signed short* ddrpm) {
+  unsigned char head;
+  unsigned char fill;
+  unsigned long newest;
+  unsigned long oldest;
+
+  /* Retry if a tooth came in while copying */
+  do {
+    head = toothRingHead;
+    fill = toothRingFill;
+    newest = toothTimeStamps[(unsigned char)(head - 1) & TOOTH_RING_MASK];
+    oldest = toothTimeStamps[(unsigned char)(head - 1 - TOOTH_RPM_SPAN) & TOOTH_RING_MASK];
+  } while (head != toothRingHead);
+
+  unsigned char teeth = fixedConfigs1.engineSettings.primaryTeeth;
+  if ((fill <= TOOTH_RPM_SPAN) || (teeth == 0)) {
+    estimateHistory = 0;
+    *rpm = 0;
+    *drpm = 0;
+    *ddrpm = 0;
+    return;
+  }
+
+  unsigned long now = hal_timer_time_get32();
+  unsigned long period = (newest - oldest) / TOOTH_RPM_SPAN;
+  unsigned long estimateTime = newest;
+  if ((now - newest) > period) {
+    period = now - newest;
+    estimateTime = now;
+  }
+
+  /* Nothing new since the last estimate */
+  if ((estimateHistory > 0) && (estimateTime == lastEstimateTime)) {
+    *rpm = lastEstimatedRPM;
+    *drpm = lastEstimatedDRPM;
+    *ddrpm = lastEstimatedDDRPM;
+    return;
+  }
+
+  unsigned short localRPM;
+  if (period >= (ticksPerCycleAtOneRPMx2 / teeth)) {
+    localRPM = 0;
+  }
+  else {
+    unsigned long cycle = period * teeth;
+    if (cycle <= (ticksPerCycleAtOneRPMx2 / 0xFFFF)) {
+      localRPM = 0xFFFF;
+    }
+    else {
+      localRPM = ticksPerCycleAtOneRPMx2 / cycle;
+    }
+  }
+
+  signed short localDRPM = 0;
+  signed short localDDRPM = 0;
+  if (estimateHistory > 0) {
+    unsigned long interval = estimateTime - lastEstimateTime;
+    localDRPM = scaleToPerSecond((signed long)localRPM - lastEstimatedRPM, interval);
+    if (estimateHistory > 1) {
+      localDDRPM = scaleToPerSecond((signed long)localDRPM - lastEstimatedDRPM, interval);
+    }
+  }
+
+  if (estimateHistory < 2) {
+    estimateHistory++;
+  }
+  lastEstimateTime = estimateTime;
+  lastEstimatedRPM = localRPM;
+  lastEstimatedDRPM = localDRPM;
+  lastEstimatedDDRPM = localDDRPM;
+
+  *rpm = localRPM;
+  *drpm = localDRPM;
+  *ddrpm = localDDRPM;
+}
 
 
 /** @brief Generate the core variables and average them.
@@ -48,12 +193,6 @@
  * and therefore closer to maximal use of the available data range they are
  * all averaged.
  *
- * @todo TODO incorporate averaging code, right now its a straight copy.
- * @todo TODO change the way configuration is done and make sure the most common
- *       options are after the first if().
- * @todo TODO add actual configuration options to the fixed config blocks for
- *       these items.
- *
  * @author Fred Cooke
  */
 void generateCoreVars() {
@@ -78,271 +217,16 @@ void generateCoreVars() {
     }
 
 
-  /* Get BRV from ADC using transfer variables (all installations need this) */
-  unsigned short localBRV;
-  if(FALSE) { /* If BRV connected  */
-    localBRV = (((unsigned long)ADCArrays->BRV * fixedConfigs2.sensorRanges.BRVRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.BRVMinimum;
-  }
-  else
-    if(TRUE) { /* Configured to be fixed value */
-      /* Get the preferred BRV figure from configuration settings */
-      localBRV = fixedConfigs2.sensorPresets.presetBRV;
-    }
-    else { /* Fail safe if config is broken */
-      /* Default to normal alternator charging voltage 14.4V */
-      localBRV = runningVoltage;
-      /* If anyone is listening, let them know something is wrong */
-      sendErrorIfClear(BRV_NOT_CONFIGURED_CODE);
-    }
+  /* Convert the sensor readings as configured */
+  CoreVar samples;
+  runSensorPipeline(&samples);
 
 
-  unsigned short localCHT;
-  /* Get CHT from ADC using the transfer table (all installations need this) */
-  if(FALSE) { /* If CHT connected  */
-    localCHT = CHTTransferTable[ADCArrays->CHT];
-  }
-  else
-    if(FALSE) { /* Configured to be read From ADC as dashpot */
-      /* Transfer the ADC reading to an engine temperature in a reasonable way*/
-      /* 0 ADC = 0C = 273.15K = 27315, 1023 ADC = 102.3C = 375.45K = 37545 */
-      localCHT = (ADCArrays->CHT * 10) + freezingPoint;
-    }
-    else
-      if(TRUE) { /* Configured to be fixed value */
-        /* Get the preferred CHT figure from configuration settings */
-        localCHT = fixedConfigs2.sensorPresets.presetCHT;
-      }
-      else { /* Fail safe if config is broken */
-        /* Default to normal running temperature of 85C/358K */
-        localCHT = runningTemperature;
-        /* If anyone is listening, let them know something is wrong */
-        sendErrorIfClear(CHT_NOT_CONFIGURED_CODE);
-      }
-
-
-  unsigned short localIAT;
-  /* Get IAT from ADC using the transfer table (all installations need this) */
-  if(FALSE) {
-    /* If IAT connected  */
-    /* using false here causes iat to default to room temp, useful with
-     * heatsoaked OEM sensors like the Volvo's... */
-    localIAT = IATTransferTable[ADCArrays->IAT];
-  }
-  else
-    if(FALSE) { /* Configured to be read From ADC as dashpot */
-      /* Transfer the ADC reading to an air temperature in a reasonable way */
-      /* 0 ADC = 0C = 273.15K = 27315, 1023 ADC = 102.3C = 375.45K = 37545 */
-      localIAT = (ADCArrays->IAT * 10) + 27315;
-    }
-    else
-      if(TRUE) { /* Configured to be fixed value */
-        /* Get the preferred IAT figure from configuration settings */
-        localIAT = fixedConfigs2.sensorPresets.presetIAT;
-      }
-      else { /* Fail safe if config is broken */
-        /* Default to normal air temperature of 20C/293K */
-        localIAT = roomTemperature;
-        /* If anyone is listening, let them know something is wrong */
-        sendErrorIfClear(IAT_NOT_CONFIGURED_CODE);
-      }
-
-
-  unsigned short localMAT;
-  /* Determine the MAT reading for future calculations */
-  if(FALSE) { /* If MAT sensor is connected */
-    /* Get MAT from ADC using same transfer table as IAT
-     * (too much space to waste on having two) */
-    localMAT = IATTransferTable[ADCArrays->MAT];
-  }
-  else
-    if(TRUE) { /* Configured to be fixed value */
-      /* Get the preferred MAT figure from configuration settings */
-      localMAT = fixedConfigs2.sensorPresets.presetMAT;
-    }
-    else { /* Fail safe if config is broken */
-      /* If not, default to same value as IAT */
-      localMAT = localIAT;
-      /* If anyone is listening, let them know something is wrong */
-      sendErrorIfClear(MAT_NOT_CONFIGURED_CODE);
-    }
-
-
-  unsigned short localMAP;
-  // AM: This value must be initialized
-  unsigned short localIAP = 255;
-  /* Determine the MAP pressure to use for future calculations */
-  if(FALSE) { /* If MAP sensor is connected */
-    /* get MAP from ADC using transfer variables */
-    localMAP = (((unsigned long)ADCArrays->MAP * fixedConfigs2.sensorRanges.MAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.MAPMinimum;
-    if(TRUE) { /* If Intercooler boost sensor connected */
-      /* Get IAP from ADC using the same transfer variables as they both need to
-       * read the same range */
-      localIAP = (((unsigned long)ADCArrays->IAP * fixedConfigs2.sensorRanges.MAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.MAPMinimum;
-    }
-  }
-  else
-    if(FALSE) { /* Configured for MAP to imitate TPS signal */
-      /* Get MAP from TPS via conversion */
-      localMAP = (((unsigned long)boundedTPSADC * TPSMAPRange) / TPSADCRange) + fixedConfigs2.sensorRanges.TPSClosedMAP;
-    }
-    else
-      if(FALSE) { /* Configured for dash potentiometer on ADC */
-        /* Get MAP from ADC via conversion to internal kPa figure where
-         * 1023ADC = 655kPa */
-        localMAP = ADCArrays->MAP << 6;
-        if(TRUE) { /* If Intercooler boost sensor enabled */
-          /* Get IAP from ADC via conversion to internal kPa figure where
-           * 1023ADC = 655kPa */
-          localIAP = ADCArrays->IAP << 6;
-        }
-      }
-      else
-        if(TRUE) { /* Configured for fixed MAP from config */
-          /* Get the preferred MAP figure from configuration settings */
-          localMAP = fixedConfigs2.sensorPresets.presetMAP;
-        }
-        else { /* Fail safe if config is broken */
-          /* Default to zero to nulify all other calcs and effectively cut fuel */
-          localMAP = 0;
-          /* If anyone is listening, let them know something is wrong */
-          sendErrorIfClear(MAP_NOT_CONFIGURED_CODE); // or maybe queue it?
-        }
-
-
-  /* Determine MAF variable if required */
-  // Default to zero as it is not required for anything except main PW calcs
-  // optionally
-  unsigned short localMAF = 0;
-  if(FALSE) {
-    localMAF = MAFTransferTable[ADCArrays->MAF];
-  }
-
-  unsigned short localAAP;
-  /* Determine the Atmospheric pressure to use for future calculations */
-  if(FALSE) { /* Configured for second sensor to read AAP */
-    /* get AAP from ADC using separate vars to allow 115kPa sensor etc to be
-     * used */
-    localAAP = (((unsigned long)ADCArrays->AAP * fixedConfigs2.sensorRanges.AAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.AAPMinimum;
-  }
-  else
-    if(FALSE) { /* Configured for dash potentiometer on ADC */
-      /* Get AAP from ADC via conversion to internal kPa figure where
-       * 1023ADC = 102.3kPa */
-      localAAP = ADCArrays->AAP * 10;
-    }
-    else
-      if(FALSE) { /* Configured for fixed AAP reading from pre start */
-        /* Get the AAP reading as saved during startup */
-        localAAP = bootTimeAAP; /* This is populated pre start up */
-      }
-      else
-        if(TRUE) { /* Configured for fixed AAP from config */
-          /* Get the preferred AAP figure from configuration settings */
-          localAAP = fixedConfigs2.sensorPresets.presetAAP;
-        }
-        else { /* Fail safe if config is broken */
-          /* Default to sea level */
-          localAAP = seaLevelKPa; /* 100kPa */
-          /* If anyone is listening, let them know something is wrong */
-          sendErrorIfClear(AAP_NOT_CONFIGURED_CODE); // or maybe queue it?
-        }
-
-
-  unsigned short localEGO;
-  /* Get main Lambda reading */
-  if(FALSE) { /* If WBO2-1 is connected */
-    /* Get EGO from ADCs using transfer variables */
-    localEGO = (((unsigned long)ADCArrays->EGO * fixedConfigs2.sensorRanges.EGORange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.EGOMinimum;
-  }
-  else
-    if(TRUE) { /* Configured for fixed EGO from config */
-      /* Get the preferred EGO figure from configuration settings */
-      localEGO = fixedConfigs2.sensorPresets.presetEGO;
-    }
-    else {
-      /* Default value if not connected incase other things are misconfigured */
-      /* Default to stoichiometric */
-      localEGO = stoichiometricLambda; /* EGO / 32768 = Lambda */
-      /* If anyone is listening, let them know something is wrong */
-      sendErrorIfClear(EGO_NOT_CONFIGURED_CODE); // or maybe queue it?
-    }
-
-
-  unsigned short localEGO2;
-  /* Get second Lambda reading */
-  if(FALSE) { /* If WBO2-2 is connected */
-    /* Get EGO2 from ADCs using same transfer variables as EGO */
-    localEGO2 = (((unsigned long)ADCArrays->EGO2 * fixedConfigs2.sensorRanges.EGORange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.EGOMinimum;
-  }
-  else
-    if(TRUE) { /* Configured for fixed EGO2 from config */
-      /* Get the preferred EGO2 figure from configuration settings */
-      localEGO2 = fixedConfigs2.sensorPresets.presetEGO2;
-    }
-    else {
-      /* Default value if not connected incase other things are misconfigured */
-      /* Default to stoichiometric */
-      localEGO2 = stoichiometricLambda;
-      /* If anyone is listening, let them know something is wrong */
-      sendErrorIfClear(EGO2_NOT_CONFIGURED_CODE); // or maybe queue it?
-    }
-
-
-  unsigned short localTPS;
-  /* Get TPS percentage */
-  if(FALSE) { /* If TPS is connected */
-    /* Get TPS from ADC no need to add TPS min as we know it is zero by
-     * definition */
-    localTPS = ((unsigned long)boundedTPSADC * TPS_RANGE_MAX) / TPSADCRange;
-  }
-  else
-    if(FALSE) { /* Configured for TPS to imitate MAP signal */
-      /* Get TPS from MAP via conversion */
-      /* Box MAP signal down */
-      if(localTPS > fixedConfigs2.sensorRanges.TPSOpenMAP) {
-	/* Greater than ~95kPa */
-        localTPS = TPS_RANGE_MAX; /* 64000/640 = 100% */
-      }
-      else
-        if(localTPS < fixedConfigs2.sensorRanges.TPSClosedMAP) {
-          /* Less than ~30kPa */
-          localTPS = 0;
-        }
-        else { /* Scale MAP range to TPS range */
-          localTPS = localMAP - fixedConfigs2.sensorRanges.TPSClosedMAP;
-        }
-      // get TPS from MAP no need to add TPS min as we know it is zero by
-      // definition
-      localTPS = ((unsigned long)localTPS * TPS_RANGE_MAX) / (fixedConfigs2.sensorRanges.TPSOpenMAP - fixedConfigs2.sensorRanges.TPSClosedMAP);
-    }
-    else
-      if(FALSE) { /* Configured for dash potentiometer on ADC */
-        /* Get TPS from ADC as shown : 1023 ADC = 100%, 0 ADC = 0% */
-        localTPS = ((unsigned long)ADCArrays->TPS * TPS_RANGE_MAX) / ADC_DIVISIONS;
-      }
-      else
-        if(TRUE) { /* Configured for fixed TPS from config */
-          /* Get the preferred TPS figure from configuration settings */
-          localTPS = fixedConfigs2.sensorPresets.presetTPS;
-        }
-        else { /* Fail safe if config is broken */
-          /* Default to 50% to not trigger any WOT or CT conditions */
-          localTPS = halfThrottle;
-          /* If anyone is listening, let them know something is wrong */
-          sendErrorIfClear(TPS_NOT_CONFIGURED_CODE); // or maybe queue it?
-        }
-
-
-  /* Get RPM by locking out ISRs for a second and grabbing the Tooth logging
-   * data */
-  //atomic start
-  // copy rpm data
-  //atomic end
-
-  // Calculate RPM and delta RPM and delta delta RPM from data recorded
-  CoreVars->RPM = *RPM; // temporary!!
-  unsigned short localDRPM = 0;
-  unsigned short localDDRPM = 0;
+  /* Calculate RPM and delta RPM and delta delta RPM from the tooth ring */
+  unsigned short localRPM;
+  signed short localDRPM;
+  signed short localDDRPM;
+  estimateRPM(&localRPM, &localDRPM, &localDDRPM);
 
 
   /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
@@ -356,43 +240,31 @@ void generateCoreVars() {
    *  some advantage to some short term averaging on the derived ones also, so
    *  it is something to look into later.											*/
 
-  /// @todo TODO average the generated values here
-
-//			newVal var word        ' the value from the ADC
-//			smoothed var word    ' a nicely smoothed result
-//
-//			if newval > smoothed then
-//			        smoothed = smoothed + (newval - smoothed)/alpha
-//			else
-//			        smoothed = smoothed - (smoothed - newval)/alpha
-//			endif
-
-  // from : http://www.tigoe.net/pcomp/code/category/code/arduinowiring/41
-
-  // for now just copy them in.
-  CoreVars->IAT = localIAT;
-  CoreVars->CHT = localCHT;
-  CoreVars->TPS = localTPS;
-  CoreVars->EGO = localEGO;
-  CoreVars->BRV = localBRV;
-  CoreVars->MAP = localMAP;
-  CoreVars->AAP = localAAP;
-  CoreVars->MAT = localMAT;
-
-  CoreVars->EGO2 = localEGO2;
-  CoreVars->IAP = localIAP;
-  CoreVars->MAF = localMAF;
-  CoreVars->DRPM = localDRPM;
-  CoreVars->DDRPM = localDDRPM;
-
-  // later...
-  unsigned short i;
-  for(i=0; i<CORE_VARS_LENGTH; i++) { // TODO
-    /* Perform averaging on all primary variables as per the configuration array */
-    // get old value(s)
-    // process new and old to produce result based on config array value */
-    // assign result to old value holder
-  } // TODO
+  /* Complete the fresh values in CoreVar order */
+  samples.DMAP = CoreVars->DMAP;
+  samples.DTPS = CoreVars->DTPS;
+  samples.RPM = localRPM;
+  samples.DRPM = (unsigned short)localDRPM;
+  samples.DDRPM = (unsigned short)localDDRPM;
+
+  /* Smooth all of them in one pass over the struct viewed as an array:
+   * smoothed = (sample * (65536 - factor) + previous * factor) / 65536
+   * which cannot overflow 32 bits. Signed variables are offset by half range
+   * on the way in and out so that they blend across zero correctly. */
+  const unsigned short* sampleArray = (const unsigned short*)&samples;
+  unsigned short* smoothedArray = (unsigned short*)CoreVars;
+  const unsigned short* factors = TABLE_PAGE(currentTuneRPage)->TablesB.SmallTablesB.coreVarsFilterFactors;
+  /* Pass the first set straight through */
+  uint32_t factorMask = coreVarsFilterPrimed ? 0xFFFF : 0;
+  unsigned char i;
+  for(i=0; i<CORE_VARS_LENGTH; i++) {
+    uint32_t factor = factors[i] & factorMask;
+    uint32_t sample = sampleArray[i] ^ coreVarsSignOffsets[i];
+    uint32_t previous = smoothedArray[i] ^ coreVarsSignOffsets[i];
+    uint32_t smoothed = ((sample * (65536 - factor)) + (previous * factor) + 0x8000) >> 16;
+    smoothedArray[i] = (unsigned short)smoothed ^ coreVarsSignOffsets[i];
+  }
+  coreVarsFilterPrimed = TRUE;
 
   /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
 }
@@ -0,0 +1,175 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file datalogRing.c
+ * @brief Calculation rate datalog
+ *
+ * See datalogRing.h for the record layout.
+ */
+
+#define DATALOGRING_C
+#include "inc/freeEMS.h"
+#include "inc/commsCore.h"
+#include "inc/datalogRing.h"
+#include <string.h>
+
+
+#define DATALOG_RING_MASK (DATALOG_RING_SIZE - 1)
+
+/* Encoded records, written at ringHead and sent from ringTail */
+static unsigned char ring[DATALOG_RING_SIZE];
+static unsigned short ringHead;
+static unsigned short ringTail;
+
+/* The last stored snapshot, the reference for the next record */
+static DatalogSnapshot previous;
+/* Records stored until the next keyframe, 0 forces one */
+static unsigned char untilKeyframe;
+static unsigned char sequence;
+
+
+/** @brief Get the number of bytes stored in the ring */
+static inline unsigned short ringUsed(void) {
+  return (ringHead - ringTail) & DATALOG_RING_MASK;
+}
+
+
+/** @brief Copy bytes out of the ring, wrapping as required */
+static void ringRead(unsigned char* destination, unsigned short position, unsigned short length) {
+  unsigned short first = DATALOG_RING_SIZE - position;
+  if(first > length) {
+    first = length;
+  }
+  memcpy(destination, &ring[position], first);
+  memcpy(destination + first, &ring[0], length - first);
+}
+
+
+/** @brief Discard all records and start over with a keyframe */
+void datalogRingReset() {
+  ringHead = 0;
+  ringTail = 0;
+  untilKeyframe = 0;
+}
+
+
+/** @brief Capture the current variables into the ring
+ *
+ * Call once after every calculation. The record is encoded in full first so
+ * that exactly its size needs to be free, otherwise it is dropped and the
+ * next one is still encoded against the last stored snapshot.
+ */
+void datalogRingCapture() {
+  DatalogSnapshot current;
+  memcpy(&current.core, CoreVars, sizeof(CoreVar));
+  memcpy(&current.derived, DerivedVars, sizeof(DerivedVar));
+  memcpy(&current.adc, ADCArrays, sizeof(ADCArray));
+
+  unsigned char record[DATALOG_RECORD_MAX_SIZE];
+  unsigned char* position = record + DATALOG_RECORD_HEADER_SIZE;
+  const unsigned short* words = (const unsigned short*)&current;
+
+  datalogRingStats.captured++;
+  record[2] = sequence++;
+  /* The header fields in the byte array need not be aligned for a short */
+  memcpy(&record[4], mathSampleTimeStamp, sizeof(unsigned short));
+
+  if(untilKeyframe == 0) {
+    record[3] = DATALOG_RECORD_KEYFRAME;
+    memcpy(position, &current, sizeof(DatalogSnapshot));
+    position += sizeof(DatalogSnapshot);
+  }
+  else {
+    const unsigned short* reference = (const unsigned short*)&previous;
+    unsigned char* bitmap = position;
+    unsigned char word;
+
+    record[3] = 0;
+    memset(bitmap, 0, DATALOG_BITMAP_BYTES);
+    position += DATALOG_BITMAP_BYTES;
+    for(word = 0; word < DATALOG_SNAPSHOT_WORDS; word++) {
+      if(words[word] != reference[word]) {
+        bitmap[word >> 3] |= 1 << (word & 7);
+        memcpy(position, &words[word], sizeof(unsigned short));
+        position += sizeof(unsigned short);
+      }
+    }
+  }
+
+  unsigned short length = position - record;
+  memcpy(&record[0], &length, sizeof(unsigned short));
+
+  /* One byte always stays free so that full and empty can be told apart */
+  if(length >= (DATALOG_RING_SIZE - ringUsed())) {
+    datalogRingStats.dropped++;
+    return;
+  }
+
+  unsigned short first = DATALOG_RING_SIZE - ringHead;
+  if(first > length) {
+    first = length;
+  }
+  memcpy(&ring[ringHead], record, first);
+  memcpy(&ring[0], record + first, length - first);
+  ringHead = (ringHead + length) & DATALOG_RING_MASK;
+
+  memcpy(&previous, &current, sizeof(DatalogSnapshot));
+  if(untilKeyframe == 0) {
+    untilKeyframe = DATALOG_KEYFRAME_INTERVAL;
+  }
+  untilKeyframe--;
+}
+
+
+/** @brief Check whether there are records waiting to be sent */
+unsigned char datalogRingPending() {
+  return ringHead != ringTail;
+}
+
+
+/** @brief Populate a circular datalog packet
+ *
+ * Writes the counters and as many whole records as fit into one packet at
+ * TXBufferCurrentPositionHandler and removes those records from the ring.
+ *
+ * @return the length of the payload written
+ */
+unsigned short populateCircularDatalog() {
+  unsigned char* start = TXBufferCurrentPositionHandler;
+  unsigned short space = TX_MAX_PAYLOAD_SIZE - sizeof(DatalogRingStats);
+
+  memcpy(TXBufferCurrentPositionHandler, &datalogRingStats, sizeof(DatalogRingStats));
+  TXBufferCurrentPositionHandler += sizeof(DatalogRingStats);
+
+  while(ringTail != ringHead) {
+    unsigned short length;
+    ringRead((unsigned char*)&length, ringTail, sizeof(length));
+    if(length > space) {
+      break;
+    }
+    ringRead(TXBufferCurrentPositionHandler, ringTail, length);
+    TXBufferCurrentPositionHandler += length;
+    ringTail = (ringTail + length) & DATALOG_RING_MASK;
+    space -= length;
+  }
+
+  return TXBufferCurrentPositionHandler - start;
+}
@@ -0,0 +1,94 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file deferredLog.c
+ * @brief Ring and output of the deferred log
+ *
+ * See ems/deferredLog.h and doc/log-format.txt.
+ */
+
+#include <hal/ems/freeems_hal.h>
+#include <ems/deferredLog.h>
+#include <ems/barrier.h>
+
+#if defined(__LOG__) && defined(__LOG_DEFERRED__)
+
+const char deferred_log_base[] = "";
+
+static deferred_log_record_t deferred_log[DEFERRED_LOG_LENGTH];
+static volatile unsigned short deferred_log_head;
+static volatile unsigned short deferred_log_tail;
+static volatile unsigned int deferred_log_overflows;
+static unsigned int deferred_log_overflows_reported;
+
+
+void deferred_log_record(const char* format, unsigned char count,
+                         const uint32_t* args) {
+  unsigned short head = deferred_log_head;
+  if ((unsigned short)(head - deferred_log_tail) >= DEFERRED_LOG_LENGTH) {
+    deferred_log_overflows++;
+    return;
+  }
+  if (count > DEFERRED_LOG_ARGS) {
+    count = DEFERRED_LOG_ARGS;
+  }
+  deferred_log_record_t* record = &deferred_log[head & DEFERRED_LOG_MASK];
+  record->format = format;
+  record->timeStamp = hal_timer_time_get32();
+  record->count = count;
+  unsigned char arg;
+  for (arg = 0; arg < count; arg++) {
+    record->args[arg] = args[arg];
+  }
+  COMPILER_BARRIER();
+  deferred_log_head = head + 1;
+}
+
+
+void deferred_log_output(void) {
+  unsigned short tail = deferred_log_tail;
+  unsigned short head = deferred_log_head;
+  COMPILER_BARRIER();
+
+  while (tail != head) {
+    const deferred_log_record_t* record = &deferred_log[tail & DEFERRED_LOG_MASK];
+    /* Modulo 2^32, the decoder takes it as signed */
+    uint32_t id = (uint32_t)((uintptr_t)record->format
+                             - (uintptr_t)deferred_log_base);
+    log_printf("!%lu@%lu", (unsigned long)id, (unsigned long)record->timeStamp);
+    unsigned char arg;
+    for (arg = 0; arg < record->count; arg++) {
+      log_printf(" %lu", (unsigned long)record->args[arg]);
+    }
+    log_printf("\r\n");
+    tail++;
+    COMPILER_BARRIER();
+    deferred_log_tail = tail;
+  }
+
+  unsigned int overflows = deferred_log_overflows;
+  if (overflows != deferred_log_overflows_reported) {
+    log_printf("!Overflow %u\r\n", overflows);
+    deferred_log_overflows_reported = overflows;
+  }
+}
+
+#endif // __LOG__ && __LOG_DEFERRED__
@@ -38,6 +38,7 @@
 #include "inc/commsCore.h"
 #include "inc/tableLookup.h"
 #include "inc/derivedVarsGenerator.h"
+#include "inc/sensorPipeline.h"
 
 
 /** @brief Generate the derived variables.
@@ -52,39 +53,28 @@ void generateDerivedVars() {
   /*&&&&&& Use basic variables to lookup and calculate derived variables &&&&&*/
 
 
-  /* Determine load based on options */
-  if(TRUE) { /* Use MAP as load */
-    DerivedVars->LoadMain = CoreVars->MAP;
-  }
-  else
-    if(FALSE) { /* Use TPS as load */
-      DerivedVars->LoadMain = CoreVars->TPS;
-    }
-    else
-      if(FALSE) { /* Use AAP corrected MAP as load */
-        DerivedVars->LoadMain = ((unsigned long)CoreVars->MAP * CoreVars->AAP) / seaLevelKPa;
-      }
-      else { /* Default to MAP, but throw error */
-        DerivedVars->LoadMain = CoreVars->MAP;
-        /* If anyone is listening, let them know something is wrong */
-        sendErrorIfClear(LOAD_NOT_CONFIGURED_CODE); // or maybe queue it?
-      }
+  /* Determine load as configured */
+  DerivedVars->LoadMain = loadConversion(CoreVars);
+
+  /* Take the live banks once so that all lookups see the same tune */
+  tablePage* fuelTables = TABLE_PAGE(currentFuelRPage);
+  tablePage* tuneTables = TABLE_PAGE(currentTuneRPage);
 
 
   /* Look up VE with RPM and Load */
-  DerivedVars->VEMain = lookupPagedMainTableCellValue((mainTable*)&TablesA.VETableMain, CoreVars->RPM, DerivedVars->LoadMain, currentFuelRPage);
+  DerivedVars->VEMain = lookupPagedMainTableCellValue(&fuelTables->TablesA.VETableMain, CoreVars->RPM, DerivedVars->LoadMain);
 
 
   /* Look up target Lambda with RPM and Load */
-  DerivedVars->Lambda = lookupPagedMainTableCellValue((mainTable*)&TablesD.LambdaTable, CoreVars->RPM, DerivedVars->LoadMain, currentFuelRPage);
+  DerivedVars->Lambda = lookupPagedMainTableCellValue(&fuelTables->TablesD.LambdaTable, CoreVars->RPM, DerivedVars->LoadMain);
 
 
   /* Look up injector dead time with battery voltage */
-  DerivedVars->IDT = lookupTwoDTableUS((twoDTableUS*)&TablesA.SmallTablesA.injectorDeadTimeTable, CoreVars->BRV);
+  DerivedVars->IDT = lookupTwoDTableUS(&tuneTables->TablesA.SmallTablesA.injectorDeadTimeTable, CoreVars->BRV);
 
 
   /* Look up the engine temperature enrichment percentage with temperature */
-  DerivedVars->ETE = lookupTwoDTableUS((twoDTableUS*)&TablesA.SmallTablesA.engineTempEnrichmentTablePercent, CoreVars->CHT);
+  DerivedVars->ETE = lookupTwoDTableUS(&tuneTables->TablesA.SmallTablesA.engineTempEnrichmentTablePercent, CoreVars->CHT);
   /* TODO The above needs some careful thought put into it around different
    *      loads and correction effects. */
 
@@ -124,9 +114,8 @@ void generateDerivedVars() {
 
   // debug
 
-  LongTime breakout2, breakout4;
+  LongTime breakout4;
 //	breakout.timeLong = timeBetweenSuccessivePrimaryPulsesBuffer;
-  breakout2.timeLong = timeBetweenSuccessivePrimaryPulses;
 //	breakout3.timeLong = lengthOfSecondaryHighPulses;
   breakout4.timeLong = lengthOfSecondaryLowPulses;
 
@@ -141,8 +130,5 @@ void generateDerivedVars() {
 //	CoreVars->DMAP = breakout3.timeShorts[1];
 //	CoreVars->DTPS = breakout3.timeShorts[0];
 
-  CoreVars->DRPM = breakout2.timeShorts[1];
-  CoreVars->DDRPM = breakout2.timeShorts[0];
-
   /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
 }
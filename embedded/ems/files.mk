@@ -1,4 +1,4 @@
 # $Id: files.mk 366 2015-09-09 09:36:11Z klugeflo $
 # List all ems source files
 
-APP_C_SRC = blockDetailsLookup.c CHTTransferTable.c commsCore.c commsISRs.c coreVarsGenerator.c decodePacketAndRespond.c derivedVarsGenerator.c DummyDefs.c FixedConfig1.c FixedConfig2.c flashConstants.c flashWrite.c freeEMS.c freeems_main.c fuelAndIgnitionCalcs.c FuelTables.c FuelTables2.c globalConstants.c IATTransferTable.c ignitionISRs.c init.c injectionISRs.c MAFTransferTable.c main.c miscISRs.c NipponDenso.c realtimeISRs.c setup.c staticInit.c tableLookup.c TestTransferTable.c TimingTables.c TimingTables2.c utils.c xgateVectors.c
+APP_C_SRC = blockDetailsLookup.c CHTTransferTable.c commsCore.c commsISRs.c coreVarsGenerator.c datalogRing.c decodePacketAndRespond.c deferredLog.c derivedVarsGenerator.c DummyDefs.c FixedConfig1.c FixedConfig2.c flashConstants.c flashWrite.c frameEncoder.c freeEMS.c freeems_main.c fuelAndIgnitionCalcs.c FuelTables.c FuelTables2.c globalConstants.c IATTransferTable.c ignitionISRs.c init.c injectionISRs.c isrLatency.c latencyChains.c MAFTransferTable.c main.c miscISRs.c NipponDenso.c performance.c realtimeISRs.c sensorPipeline.c setup.c staticInit.c tableBanks.c tableLookup.c TestTransferTable.c TimingTables.c TimingTables2.c toothLogger.c tripleBuffer.c utils.c xgateVectors.c
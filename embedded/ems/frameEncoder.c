@@ -0,0 +1,136 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file frameEncoder.c
+ * @ingroup communicationsFiles
+ * @brief Streaming encoder for serial frames
+ *
+ * The data is processed a 32 bit word at a time. A word without any of the
+ * three special bytes, by far the common case, is stored as is. Only words
+ * containing one are expanded byte by byte. The checksum is summed per word
+ * with the bytes added in two 16 bit lanes.
+ */
+
+#define FRAMEENCODER_C
+#include "inc/freeEMS.h"
+#include "inc/frameEncoder.h"
+#include <string.h>
+#include <stdint.h>
+
+
+/* Byte replicated into all four bytes of a word */
+#define REPEAT_BYTE(value) ((uint32_t)0x01010101UL * (value))
+
+/* Non zero if any byte of word equals the byte replicated in pattern */
+#define HAS_BYTE(word, pattern) \
+  ((((word) ^ (pattern)) - REPEAT_BYTE(0x01)) & ~((word) ^ (pattern)) & REPEAT_BYTE(0x80))
+
+
+/* Where the next encoded byte goes */
+static unsigned char* framePosition;
+/* Sum of all bytes appended so far */
+static unsigned char frameChecksum;
+
+
+/** @brief Store one byte, escaped if required */
+static inline unsigned char* escapeByte(unsigned char* destination, unsigned char value) {
+  if(value == ESCAPE_BYTE) {
+    *destination++ = ESCAPE_BYTE;
+    *destination++ = ESCAPED_ESCAPE_BYTE;
+  }
+  else if(value == START_BYTE) {
+    *destination++ = ESCAPE_BYTE;
+    *destination++ = ESCAPED_START_BYTE;
+  }
+  else if(value == STOP_BYTE) {
+    *destination++ = ESCAPE_BYTE;
+    *destination++ = ESCAPED_STOP_BYTE;
+  }
+  else {
+    *destination++ = value;
+  }
+  return destination;
+}
+
+
+/** @brief Start a new frame */
+void frameBegin() {
+  framePosition = (unsigned char*)&TXStagingBuffer;
+  *framePosition++ = START_BYTE;
+  frameChecksum = 0;
+}
+
+
+/** @brief Append packet data to the frame
+ *
+ * @param block is the data to append, no alignment required.
+ * @param length is the number of bytes to append.
+ */
+void frameAppend(const void* block, unsigned short length) {
+  const unsigned char* source = (const unsigned char*)block;
+  unsigned char* destination = framePosition;
+  unsigned char sum = frameChecksum;
+
+  while(length >= sizeof(uint32_t)) {
+    uint32_t word;
+    memcpy(&word, source, sizeof(uint32_t));
+
+    /* Both lanes hold the sum of two bytes, the low byte of their sum is the
+     * sum of all four bytes */
+    uint32_t lanes = (word & 0x00FF00FFUL) + ((word >> 8) & 0x00FF00FFUL);
+    sum += (unsigned char)(lanes + (lanes >> 16));
+
+    if(HAS_BYTE(word, REPEAT_BYTE(START_BYTE))
+        | HAS_BYTE(word, REPEAT_BYTE(ESCAPE_BYTE))
+        | HAS_BYTE(word, REPEAT_BYTE(STOP_BYTE))) {
+      destination = escapeByte(destination, source[0]);
+      destination = escapeByte(destination, source[1]);
+      destination = escapeByte(destination, source[2]);
+      destination = escapeByte(destination, source[3]);
+    }
+    else {
+      memcpy(destination, &word, sizeof(uint32_t));
+      destination += sizeof(uint32_t);
+    }
+    source += sizeof(uint32_t);
+    length -= sizeof(uint32_t);
+  }
+
+  while(length > 0) {
+    sum += *source;
+    destination = escapeByte(destination, *source++);
+    length--;
+  }
+
+  framePosition = destination;
+  frameChecksum = sum;
+}
+
+
+/** @brief Close the frame with the checksum and the stop byte
+ *
+ * @return the length of the frame in TXStagingBuffer
+ */
+unsigned short frameEnd() {
+  framePosition = escapeByte(framePosition, frameChecksum);
+  *framePosition++ = STOP_BYTE;
+  return (uintptr_t)framePosition - (uintptr_t)&TXStagingBuffer;
+}
@@ -57,6 +57,12 @@ extern void Injector3ISR();
 extern void Injector4ISR();
 extern void Injector5ISR();
 extern void Injector6ISR();
+extern void Injector7ISR();
+extern void Injector8ISR();
+extern void Injector9ISR();
+extern void Injector10ISR();
+extern void Injector11ISR();
+extern void Injector12ISR();
 extern void TimerOverflow();
 extern void RTIISR();
 
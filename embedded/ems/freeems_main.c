@@ -37,12 +37,36 @@
 
 #include <hal/ems/freeems_hal.h>
 #include <hal/log.h>
+#include <ems/performance.h>
+#include <ems/deferredLog.h>
 #include "inc/main.h"
 
 #ifdef __PERF__
 void performBaseMeasurements();
 #endif // __PERF__
 
+/* Number of timer ticks over which RuntimeVars.mainLoopLoad is averaged */
+#define MAIN_LOOP_LOAD_WINDOW 0x10000UL
+
+/* Private copy of the ADCs for forced readings outside the engine position */
+static ADCArray forcedADCArray;
+
+
+/** @brief Check whether the selected async datalog has something to send */
+static unsigned char asyncDatalogPending(void) {
+  switch (asyncDatalogType) {
+  case asyncDatalogOff:
+    return FALSE;
+  case asyncDatalogCircBuf:
+    return datalogRingPending();
+  case asyncDatalogTrigger:
+    return toothLogPending();
+  default:
+    return TRUE;
+  }
+}
+
+
 /** @brief The main function!
  *
  * The centre of the application is here. From here all non-ISR code is called
@@ -64,87 +88,98 @@ int main_freeems() { // TODO maybe move this to paged flash ?
   // Set everything up.
   init();
   coreStatusA |= PRIMARY_SYNC;
+  /* Number of forced ADC readings requested by the RTC that were handled */
+  unsigned char forcedReadingsTaken = forcedReadingRequests;
+  /* Accumulated total and idle time for the main loop load */
+  unsigned long loadTotalTicks = 0;
+  unsigned long loadIdleTicks = 0;
+  unsigned short loadLastTime = hal_timer_time_get();
 
 #ifdef __PERF__
   performBaseMeasurements();
   unsigned int duration;// = 200000;
+  unsigned short regionReportSeconds = Clocks.realTimeClockSeconds;
 #endif
 
   // Run forever repeating.
   while (TRUE) {
+    /* Set when a new set of inputs is available to the mathematics */
+    unsigned char calcRequired = FALSE;
+
+    /* Sleep until an interrupt brings something to do. Interrupts are locked
+     * between the check and the wait so that none of them gets lost. */
+    ATOMIC_START();
+    if (!tripleBufferPending(&sensorSnapshotBuffer)
+        && (forcedReadingRequests == forcedReadingsTaken)
+        && !(RXStateFlags & RX_READY_TO_PROCESS)
+        && !(ShouldSendLog && asyncDatalogPending()
+             && !(TXBufferInUseFlags))) {
+      unsigned short idleStartTime = hal_timer_time_get();
+      hal_system_idle();
+      loadIdleTicks += (unsigned short)(hal_timer_time_get() - idleStartTime);
+    }
+    ATOMIC_END();
+
+    /* Update the load figure once per window */
+    unsigned short loadTime = hal_timer_time_get();
+    loadTotalTicks += (unsigned short)(loadTime - loadLastTime);
+    loadLastTime = loadTime;
+    if (loadTotalTicks >= MAIN_LOOP_LOAD_WINDOW) {
+      RuntimeVars.mainLoopLoad = ((loadTotalTicks - loadIdleTicks) * 10000)
+                                 / loadTotalTicks;
+      loadTotalTicks = 0;
+      loadIdleTicks = 0;
+    }
+
     /* If ADCs require forced sampling, sample now */
-    if (coreStatusA & FORCE_READING) {
-      ATOMIC_START()
-      ; /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-      /* Atomic block to ensure a full set of readings are taken together */
+    if (forcedReadingRequests != forcedReadingsTaken) {
+      forcedReadingsTaken = forcedReadingRequests;
 #ifdef __PERF__
       hal_performance_startCounter();
 #endif
-      /* Check to ensure that a reading wasn't take before we entered a non
-       * interruptable state */
-      if (coreStatusA & FORCE_READING) {
-	// do we still need to do this TODO ?
-
-	// TODO still need to do a pair of loops and clock these two functions
-	//      for performance.
-        sampleEachADC(ADCArraysRecord);
-        Counters.timeoutADCreadings++;
-
-        /* Set flag to say calc required */
-        coreStatusA |= CALC_FUEL_IGN;
-
-        /* Clear force reading flag */
-        coreStatusA &= CLEAR_FORCE_READING;
-      }
+      /* The scan buffers belong to the HAL, so the latest complete scan is
+       * copied into a private array instead, see hal_adc_read() */
+      hal_adc_read((uint16_t*)&forcedADCArray);
+      ADCArrays = &forcedADCArray;
+      *mathSampleTimeStamp = hal_timer_time_get();
+      Counters.timeoutADCreadings++;
+
+      /* Set flag to say calc required */
+      calcRequired = TRUE;
 #ifdef __PERF__
       duration = hal_performance_stopCounter();
       perf_printf("*r%u\r\n", duration);
 #endif
-      ATOMIC_END(); /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
     }
 
-    /* If required, do main fuel and ignition calcs first */
-    if (coreStatusA & CALC_FUEL_IGN) {
-      ATOMIC_START()
-      ; /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-      /* Atomic block to ensure that we don't clear the flag for the next data
-       * set when things are tight */
 #ifdef __PERF__
-      hal_performance_startCounter();
+    hal_performance_startCounter();
 #endif
-
-      /* Switch input bank so that we have a stable set of the latest data */
-      if (ADCArrays == &ADCArrays1) {
-        RPM = &RPM0; // TODO temp, remove
-        RPMRecord = &RPM1; // TODO temp, remove
-        ADCArrays = &ADCArrays0;
-        ADCArraysRecord = &ADCArrays1;
-        // TODO temp, remove
-        mathSampleTimeStamp = &ISRLatencyVars.mathSampleTimeStamp0;
-        // TODO temp, remove
-        mathSampleTimeStampRecord =
-          &ISRLatencyVars.mathSampleTimeStamp1;
-      }
-      else {
-        RPM = &RPM1; // TODO temp, remove
-        RPMRecord = &RPM0; // TODO temp, remove
-        ADCArrays = &ADCArrays1;
-        ADCArraysRecord = &ADCArrays0;
-        // TODO temp, remove
-        mathSampleTimeStamp = &ISRLatencyVars.mathSampleTimeStamp1;
-        // TODO temp, remove
-        mathSampleTimeStampRecord =
-          &ISRLatencyVars.mathSampleTimeStamp0;
-      }
-
-      /* Clear the calc required flag */
-      coreStatusA &= CLEAR_CALC_FUEL_IGN;
+    /* Take over the latest snapshot published by the engine position ISR so
+     * that we have a stable set of the latest data */
+    unsigned char snapshotTaken = tripleBufferAcquire(&sensorSnapshotBuffer);
+    if (snapshotTaken) {
+      SensorSnapshot* snapshot = &sensorSnapshots[sensorSnapshotBuffer.reading];
+      ADCArrays = (ADCArray*)hal_adc_buffer(snapshot->ADCBuffer);
+      RPM = &snapshot->RPM; // TODO temp, remove
+      mathSampleTimeStamp = &snapshot->sampleTimeStamp; // TODO temp, remove
+      calcRequired = TRUE;
+    }
 #ifdef __PERF__
-      duration = hal_performance_stopCounter();
+    /* Stop in any case, so that every start has its stop */
+    duration = hal_performance_stopCounter();
+    if (snapshotTaken) {
       perf_printf("*sr%u\r\n", duration);
+    }
 #endif
 
-      ATOMIC_END(); /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+    /* If required, do main fuel and ignition calcs first */
+    if (calcRequired) {
+      /* Select the result buffer that no ISR is going to read from */
+      MathResult* result = &mathResults[tripleBufferWriteBegin(&mathResultBuffer)];
+      currentDwellMath = &result->dwell;
+      injectorMainPulseWidthsMath = result->injectorMainPulseWidths;
+      injectorStagedPulseWidthsMath = result->injectorStagedPulseWidths;
 
       /* Store the latency from sample time to runtime */
       ISRLatencyVars.mathLatency = hal_timer_time_get()
@@ -156,7 +191,9 @@ int main_freeems() { // TODO maybe move this to paged flash ?
 
       /* Generate the core variables from sensor input and recorded tooth
        * timings */
+      PERF_REGION_BEGIN(PERF_REGION_CORE_VARS);
       generateCoreVars();
+      PERF_REGION_END(PERF_REGION_CORE_VARS);
 
       RuntimeVars.genCoreVarsRuntime = hal_timer_time_get()
                                        - mathStartTime;
@@ -164,14 +201,18 @@ int main_freeems() { // TODO maybe move this to paged flash ?
 
       /* Generate the derived variables from the core variables based on
        * settings */
+      PERF_REGION_BEGIN(PERF_REGION_DERIVED_VARS);
       generateDerivedVars();
+      PERF_REGION_END(PERF_REGION_DERIVED_VARS);
 
       RuntimeVars.genDerivedVarsRuntime = hal_timer_time_get()
                                           - derivedStartTime;
       unsigned short calcsStartTime = hal_timer_time_get();
       /* Perform the calculations TODO possibly move this to the software
        * interrupt if it makes sense to do so */
+      PERF_REGION_BEGIN(PERF_REGION_FUEL_IGNITION);
       calculateFuelAndIgnition();
+      PERF_REGION_END(PERF_REGION_FUEL_IGNITION);
 
       RuntimeVars.calcsRuntime = hal_timer_time_get() - calcsStartTime;
       /* Record the runtime of all the math total */
@@ -181,46 +222,23 @@ int main_freeems() { // TODO maybe move this to paged flash ?
                                    + RuntimeVars.genCoreVarsRuntime
                                    + RuntimeVars.genDerivedVarsRuntime;
 
-      ATOMIC_START()
-      ; /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-      /* Atomic block to ensure that outputBank and outputBank Offsets match */
 #ifdef __PERF__
       hal_performance_startCounter();
 #endif
-      /* Switch banks to the latest data */
-      if (injectorMainPulseWidthsMath == injectorMainPulseWidths1) {
-        currentDwellMath = &currentDwell0;
-        currentDwellRealtime = &currentDwell1;
-        injectorMainPulseWidthsMath = injectorMainPulseWidths0;
-        injectorMainPulseWidthsRealtime = injectorMainPulseWidths1;
-        injectorStagedPulseWidthsMath = injectorStagedPulseWidths0;
-        injectorStagedPulseWidthsRealtime = injectorStagedPulseWidths1;
-      }
-      else {
-        currentDwellMath = &currentDwell1;
-        currentDwellRealtime = &currentDwell0;
-        injectorMainPulseWidthsMath = injectorMainPulseWidths1;
-        injectorMainPulseWidthsRealtime = injectorMainPulseWidths0;
-        injectorStagedPulseWidthsMath = injectorStagedPulseWidths1;
-        injectorStagedPulseWidthsRealtime = injectorStagedPulseWidths0;
-      }
+      /* Hand the complete set of outputs to the ISRs in one go */
+      tripleBufferPublish(&mathResultBuffer);
 #ifdef __PERF__
       duration = hal_performance_stopCounter();
       perf_printf("*sii%u\r\n", duration);
 #endif
 
-      ATOMIC_END(); /*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-    }
-    else {
-      /* In the event that no calcs are required, sleep a little before
-       * returning to retry. */
-      // not doing this will cause the ISR lockouts to run for too high a
-      // proportion of the time
-      sleepMicro(RuntimeVars.mathTotalRuntime);
-      /* Using 0.8 ticks as micros so it will run for a little longer than the
-       * math did */
+      /* Record the inputs and results of this calculation */
+      if (asyncDatalogType == asyncDatalogCircBuf) {
+        datalogRingCapture();
+      }
     }
 
+    PERF_REGION_BEGIN(PERF_REGION_COMMS);
     if (!(TXBufferInUseFlags)) {
       //	unsigned short logTimeBuffer = Clocks.realTimeClockTenths;
       /* If the flag for com packet processing is set and the TX buffer is
@@ -248,8 +266,6 @@ int main_freeems() { // TODO maybe move this to paged flash ?
                 (unsigned char*) &TXBuffer;
 
               /* Initialised here such that override is possible */
-              TXBufferCurrentPositionSCI0 =
-                (unsigned char*) &TXBuffer;
               TXBufferCurrentPositionCAN0 =
                 (unsigned char*) &TXBuffer;
 
@@ -266,9 +282,8 @@ int main_freeems() { // TODO maybe move this to paged flash ?
               *((unsigned short*) TXBufferCurrentPositionHandler) =
                 configuredBasicDatalogLength;
               TXBufferCurrentPositionHandler += 2;
-              /* populate data log */
-              populateBasicDatalog();
-              checksumAndSend();
+              /* populate data log and send */
+              sendBasicDatalog();
               break;
             }
             case asyncDatalogConfig: {
@@ -276,7 +291,32 @@ int main_freeems() { // TODO maybe move this to paged flash ?
               break;
             }
             case asyncDatalogTrigger: {
-              // TODO
+              if (!toothLogPending()) {
+                break;
+              }
+              /* Flag that we are transmitting! */
+              TXBufferInUseFlags |= COM_SET_SCI0_INTERFACE_ID;
+
+              TXBufferCurrentPositionHandler =
+                (unsigned char*) &TXBuffer;
+              TXBufferCurrentPositionCAN0 =
+                (unsigned char*) &TXBuffer;
+
+              /* Set the flags : firmware, no ack, no addrs, has length */
+              *TXBufferCurrentPositionHandler = HEADER_HAS_LENGTH;
+              TXBufferCurrentPositionHandler++;
+
+              /* Set the payload ID */
+              *((unsigned short*) TXBufferCurrentPositionHandler) =
+                asyncToothLog;
+              TXBufferCurrentPositionHandler += 2;
+
+              /* The length is only known once the entries are packed */
+              unsigned short* length =
+                (unsigned short*) TXBufferCurrentPositionHandler;
+              TXBufferCurrentPositionHandler += 2;
+              *length = populateToothLog();
+              checksumAndSend();
               break;
             }
             case asyncDatalogADC: {
@@ -284,7 +324,32 @@ int main_freeems() { // TODO maybe move this to paged flash ?
               break;
             }
             case asyncDatalogCircBuf: {
-              // TODO
+              if (!datalogRingPending()) {
+                break;
+              }
+              /* Flag that we are transmitting! */
+              TXBufferInUseFlags |= COM_SET_SCI0_INTERFACE_ID;
+
+              TXBufferCurrentPositionHandler =
+                (unsigned char*) &TXBuffer;
+              TXBufferCurrentPositionCAN0 =
+                (unsigned char*) &TXBuffer;
+
+              /* Set the flags : firmware, no ack, no addrs, has length */
+              *TXBufferCurrentPositionHandler = HEADER_HAS_LENGTH;
+              TXBufferCurrentPositionHandler++;
+
+              /* Set the payload ID */
+              *((unsigned short*) TXBufferCurrentPositionHandler) =
+                asyncCircularDatalog;
+              TXBufferCurrentPositionHandler += 2;
+
+              /* The length is only known once the records are packed */
+              unsigned short* length =
+                (unsigned short*) TXBufferCurrentPositionHandler;
+              TXBufferCurrentPositionHandler += 2;
+              *length = populateCircularDatalog();
+              checksumAndSend();
               break;
             }
             case asyncDatalogCircCAS: {
@@ -299,6 +364,7 @@ int main_freeems() { // TODO maybe move this to paged flash ?
           }
         }
     }
+    PERF_REGION_END(PERF_REGION_COMMS);
     // on once per cycle for main loop heart beat (J0)
     PORTJ ^= 0x01;
 
@@ -319,7 +385,15 @@ int main_freeems() { // TODO maybe move this to paged flash ?
     // PWM experimentation
     adjustPWM();
 
+#ifdef __PERF__
+    /* Report the region totals once a second */
+    if (Clocks.realTimeClockSeconds != regionReportSeconds) {
+      regionReportSeconds = Clocks.realTimeClockSeconds;
+      perf_region_output();
+    }
+#endif
     output_performance_log();
+    output_deferred_log();
   }
 }
 
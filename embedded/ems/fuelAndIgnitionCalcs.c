@@ -37,10 +37,12 @@
 #define FUELANDIGNITIONCALCS_C
 #include "inc/freeEMS.h"
 #include "inc/utils.h"
+#include "inc/saturatingMath.h"
 #include "inc/commsCore.h"
 #include "inc/tableLookup.h"
 #include "inc/DecoderInterface.h"
 #include "inc/fuelAndIgnitionCalcs.h"
+#include "inc/sensorPipeline.h"
 
 
 /** @brief Fuel and ignition calculations
@@ -68,39 +70,8 @@ void calculateFuelAndIgnition() {
 
   if(TRUE /* Genuine method */) {
     unsigned short airInletTemp = CoreVars->IAT; /* All except MAF use this. */
-    /* Determine the type of air flow data */
-    if(TRUE /* SpeedDensity */) {
-      /* This won't overflow until 512kPa or about 60psi of boost with 128% VE. */
-      DerivedVars->AirFlow = ((unsigned long)CoreVars->MAP * DerivedVars->VEMain) / oneHundredPercentVE;
-      /* Result is 450 - 65535 always. */
-    }
-    else
-      if(FALSE /*AlphaN*/) {
-	/* Not actually VE, but rather tuned air flow without density
-	 * information */
-        DerivedVars->AirFlow = DerivedVars->VEMain;
-      }
-      else
-        if(FALSE /*MAF*/) {
-          /* Just fix temperature at appropriate level to provide correct
-           * Lambda */
-          DerivedVars->AirFlow = CoreVars->MAF;
-          /// @todo TODO figure out what the correct "temperature" is to make
-          ///       MAF work correctly!
-          // 293.15k is 20c * 100 to get value, so divide by 100 to get real
-          // number
-          airInletTemp = roomTemperature;
-        }
-        else
-          if(FALSE /*FixedAF*/) {
-            /* Fixed air flow from config */
-            DerivedVars->AirFlow = fixedConfigs2.sensorPresets.presetAF;
-          }
-          else { /* Default to no fuel delivery and error */
-            DerivedVars->AirFlow = 0;
-            /* If anyone is listening, let them know something is wrong */
-      //sendError(AIRFLOW_NOT_CONFIGURED_CODE); // or maybe queue it?
-          }
+    /* Determine the air flow as configured */
+    DerivedVars->AirFlow = airFlowConversion(&airInletTemp);
 
 
     /* This won't overflow until well past 125C inlet, 1.5 Lambda and fuel as
@@ -141,16 +112,10 @@ void calculateFuelAndIgnition() {
   // the declaration of this variable is used in multiple loops below.
   unsigned char channel;
 
-  /* "Calculate" the individual fuel pulse widths */
-  for(channel = 0; channel < INJECTION_CHANNELS; channel++) {
-    /// @todo TODO make injector channels come from config, not defines.
-    /* Add or subtract the per cylinder fuel trims */
-    unsigned short channelPW;
-    channelPW = safeScale(DerivedVars->EffectivePW, TablesB.SmallTablesB.perCylinderFuelTrims[channel]);
-
-    /* Add on the IDT to get the final value and put it into the array */
-    injectorMainPulseWidthsMath[channel] = safeAdd(channelPW, DerivedVars->IDT);
-  }
+  /* Calculate the individual fuel pulse widths: apply the per cylinder fuel
+   * trims and add on the IDT for all channels in one pass */
+  /// @todo TODO make injector channels come from config, not defines.
+  safeScaleAddChannels(injectorMainPulseWidthsMath, TABLE_PAGE(currentTuneRPage)->TablesB.SmallTablesB.perCylinderFuelTrims, DerivedVars->EffectivePW, DerivedVars->IDT, INJECTION_CHANNELS);
 
   /* Reference PW for comparisons etc */
   unsigned short refPW = safeAdd(DerivedVars->EffectivePW, DerivedVars->IDT);
@@ -194,14 +159,10 @@ void calculateFuelAndIgnition() {
 
   /* "Calculate" the nominal total pulse width before per channel corrections */
   // FAK: FIXME - calculation of refPW yield 0 at another place and thus no more
-  //              injections/ignitions are scheduled
+  //              injections/ignitions are scheduled. It only gates the
+  //              scheduling in the decoder, the channels keep their own PWs.
   masterPulseWidth = 123;//refPW;//(ADCArrays->EGO << 6) + (ADCArrays->MAP >> 4);
 
-  /* "Calculate" the individual fuel pulse widths */
-  for(channel = 0; channel < INJECTION_CHANNELS; channel++) {
-    injectorMainPulseWidthsMath[channel] = masterPulseWidth;
-  }
-
   /// @todo TODO x 6 main pulsewidths, x 6 staged pulsewidths, x 6 flags for
   ///       staged channels if(coreSettingsA & STAGED_ON){}
 
@@ -221,7 +182,7 @@ void calculateFuelAndIgnition() {
 
   short c;
   for(c=0; c<IGNITION_CHANNELS; c++) {
-    ignitionAdvances[IGNITION_CHANNELS] = intendedAdvance;
+    ignitionAdvances[c] = intendedAdvance;
   }
   *currentDwellMath = intendedDwell;
 
@@ -59,7 +59,7 @@
  */
 
 
-const unsigned short maxBasicDatalogLength = sizeof(CoreVar) + sizeof(DerivedVar) + sizeof(ADCArray);
+const unsigned short maxBasicDatalogLength = sizeof(CoreVar) + sizeof(DerivedVar) + sizeof(ADCArray) + sizeof(RuntimeVar);
 
 
 /* Constants */
@@ -199,13 +199,13 @@ const unsigned short trailingEdgeSecondaryRPMInputCodeTime = 100;
 
 
 /* Dwell masks                                            { CYL1 B0, CYL2 B1, CYL3  B2, CYL4  B3, CYL5  B4, CYL6  B5, CYL7  B6, CYL8  B7, CYL9 A0,CYL10 A1,CYL11 A2,CYL12 A3}; */
-const unsigned short dwellStartMasks[IGNITION_CHANNELS] = { BIT8_16, BIT9_16, BIT10_16, BIT11_16, BIT12_16, BIT13_16, BIT14_16, BIT15_16, BIT0_16, BIT1_16, BIT2_16, BIT3_16};		/* Set of masks such that a cylinder can be dwelled with a single line of code */
-const unsigned short ignitionMasks[IGNITION_CHANNELS]   = {NBIT8_16,NBIT9_16,NBIT10_16,NBIT11_16,NBIT12_16,NBIT13_16,NBIT14_16,NBIT15_16,NBIT0_16,NBIT1_16,NBIT2_16,NBIT3_16};		/* Set of masks such that a cylinder can be fired with a single line of code */
-
-/* Injection masks */
-const unsigned char injectorMainOnMasks[INJECTION_CHANNELS] = {BIT2,  BIT3,  BIT4,  BIT5,  BIT6,  BIT7};
-const unsigned char injectorMainOffMasks[INJECTION_CHANNELS] = {NBIT2, NBIT3, NBIT4, NBIT5, NBIT6, NBIT7};
-const unsigned char injectorMainEnableMasks[INJECTION_CHANNELS] = {0x30, 0xC0, 0x03, 0x0C, 0x30, 0xC0};
-const unsigned char injectorMainDisableMasks[INJECTION_CHANNELS] = {0xCF, 0x3F, 0xFC, 0xF3, 0xCF, 0x3F};
-const unsigned char injectorMainGoHighMasks[INJECTION_CHANNELS] = {BIT4, BIT6, BIT0, BIT2, BIT4, BIT6};
-const unsigned char injectorMainGoLowMasks[INJECTION_CHANNELS] = {NBIT4, NBIT6, NBIT0, NBIT2, NBIT4, NBIT6};
+const unsigned short dwellStartMasks[EMS_CHANNELS_MAX] = { BIT8_16, BIT9_16, BIT10_16, BIT11_16, BIT12_16, BIT13_16, BIT14_16, BIT15_16, BIT0_16, BIT1_16, BIT2_16, BIT3_16};		/* Set of masks such that a cylinder can be dwelled with a single line of code */
+const unsigned short ignitionMasks[EMS_CHANNELS_MAX]    = {NBIT8_16,NBIT9_16,NBIT10_16,NBIT11_16,NBIT12_16,NBIT13_16,NBIT14_16,NBIT15_16,NBIT0_16,NBIT1_16,NBIT2_16,NBIT3_16};		/* Set of masks such that a cylinder can be fired with a single line of code */
+
+/* Injection masks, one bit of selfSetTimer per channel */
+const unsigned short injectorMainOnMasks[EMS_CHANNELS_MAX] = {BIT0_16,  BIT1_16,  BIT2_16,  BIT3_16,  BIT4_16,  BIT5_16,  BIT6_16,  BIT7_16,  BIT8_16,  BIT9_16,  BIT10_16,  BIT11_16};
+const unsigned short injectorMainOffMasks[EMS_CHANNELS_MAX] = {NBIT0_16, NBIT1_16, NBIT2_16, NBIT3_16, NBIT4_16, NBIT5_16, NBIT6_16, NBIT7_16, NBIT8_16, NBIT9_16, NBIT10_16, NBIT11_16};
+const unsigned char injectorMainEnableMasks[EMS_CHANNELS_MAX] = {0x30, 0xC0, 0x03, 0x0C, 0x30, 0xC0, 0x03, 0x0C, 0x30, 0xC0, 0x03, 0x0C};
+const unsigned char injectorMainDisableMasks[EMS_CHANNELS_MAX] = {0xCF, 0x3F, 0xFC, 0xF3, 0xCF, 0x3F, 0xFC, 0xF3, 0xCF, 0x3F, 0xFC, 0xF3};
+const unsigned char injectorMainGoHighMasks[EMS_CHANNELS_MAX] = {BIT4, BIT6, BIT0, BIT2, BIT4, BIT6, BIT0, BIT2, BIT4, BIT6, BIT0, BIT2};
+const unsigned char injectorMainGoLowMasks[EMS_CHANNELS_MAX] = {NBIT4, NBIT6, NBIT0, NBIT2, NBIT4, NBIT6, NBIT0, NBIT2, NBIT4, NBIT6, NBIT0, NBIT2};
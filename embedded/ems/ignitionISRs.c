@@ -44,6 +44,8 @@
 #include "hal/ems/freeems_hal.h"
 #include <hal/log.h>
 #include <ems/performance.h>
+#include <ems/deferredLog.h>
+#include "inc/latencyChains.h"
 
 
 /* Summary of intended ignition timing scheme
@@ -83,16 +85,17 @@ void IgnitionDwellISR_wrapped(void)
 void IgnitionDwellISR(void)
 #endif // __PERF__
 */
-PERF_WRAP_SIMPLE(IgnitionDwellISR, "d") {
+PERF_WRAP_SIMPLE(IgnitionDwellISR, "d", PERF_REGION_DWELL) {
 
   // LOG: store code start time and release time. this is only needed when logging is active
   // LOG: unsigned short codeStartTimeStamp = hal_timer_time_get();
   CAPTURE_START_TIME();
   //hal_performance_startCounter();
 
-  log_printf("ID%u@%u %u\r\n", nextDwellChannel, hal_timer_pit_interval_get(IGNITION_DWELL_PIT), GET_START_TIME());
+  log_event("ID%u@%u %u\r\n", nextDwellChannel, hal_timer_pit_interval_get(IGNITION_DWELL_PIT), GET_START_TIME());
   // start dwelling asap
   hal_io_set(IGNITIONX_OUTPUT(nextDwellChannel), HIGH);
+  latencyChainClose(LATENCY_DWELL, nextDwellChannel, hal_timer_time_get32());
   if(dwellQueueLength == 0) {
     // turn off the int
     hal_timer_pit_active_set(IGNITION_DWELL_PIT, FALSE);
@@ -109,6 +112,9 @@ PERF_WRAP_SIMPLE(IgnitionDwellISR, "d") {
     else {
       nextDwellChannel = 0; // if the last channel, reset to zero
     }
+    /* The interval queued for this channel was reloaded into the PIT when it
+     * expired just now, so its countdown has started */
+    latencyChainProgrammed(LATENCY_DWELL, nextDwellChannel);
 
     // if the queue length after decrement is greater than 0 then we need to
     // load the timer, if it is zero and we decremented, the timer was already
@@ -123,7 +129,7 @@ PERF_WRAP_SIMPLE(IgnitionDwellISR, "d") {
         // load the timer if the index is good
         // FIXME: Use IGNITION_DWELL_PIT instead of channel stuff!
         hal_timer_pit_interval_set(IGNITION_DWELL_PIT, queuedDwellOffsets[dwellQueueLength - 1]);
-        log_printf("IDr%u@%u\r\n", nextDwellChannel, queuedDwellOffsets[dwellQueueLength - 1]);
+        log_event("IDr%u@%u\r\n", nextDwellChannel, queuedDwellOffsets[dwellQueueLength - 1]);
       }
     }
   }
@@ -155,14 +161,15 @@ void IgnitionFireISR() {
  *
  * @todo TODO make this actually work.
  */
-PERF_WRAP_SIMPLE(IgnitionFireISR, "f") {
+PERF_WRAP_SIMPLE(IgnitionFireISR, "f", PERF_REGION_FIRE) {
   // LOG: store code start time and release time. This is only needed when logging is active
   // LOG: unsigned short codeStartTimeStamp = hal_timer_time_get();
   CAPTURE_START_TIME();
 
-  log_printf("IF%u@%u %u\r\n", nextIgnitionChannel, hal_timer_pit_interval_get(IGNITION_FIRE_PIT), GET_START_TIME());
+  log_event("IF%u@%u %u\r\n", nextIgnitionChannel, hal_timer_pit_interval_get(IGNITION_FIRE_PIT), GET_START_TIME());
   // fire the coil asap
   hal_io_set(IGNITIONX_OUTPUT(nextIgnitionChannel), LOW);
+  latencyChainClose(LATENCY_FIRE, nextIgnitionChannel, hal_timer_time_get32());
 
   if(ignitionQueueLength == 0) {
     // turn off the int
@@ -179,6 +186,9 @@ PERF_WRAP_SIMPLE(IgnitionFireISR, "f") {
     else {
       nextIgnitionChannel = 0; // if the last channel, reset to zero
     }
+    /* The interval queued for this channel was reloaded into the PIT when it
+     * expired just now, so its countdown has started */
+    latencyChainProgrammed(LATENCY_FIRE, nextIgnitionChannel);
 
     // if the queue length after decrement is greater than 0 then we need to
     // load the timer, if it is zero and we decremented, the timer was already
@@ -193,7 +203,7 @@ PERF_WRAP_SIMPLE(IgnitionFireISR, "f") {
         // load the timer if the index is good
         // FIXME: Use IGNITION_FIRE_PIT instead of channel stuff!
         hal_timer_pit_interval_set(IGNITION_FIRE_PIT, queuedIgnitionOffsets[ignitionQueueLength - 1]);
-        log_printf("IFr%u@%u\r\n", nextIgnitionChannel, queuedIgnitionOffsets[ignitionQueueLength - 1]);
+        log_event("IFr%u@%u\r\n", nextIgnitionChannel, queuedIgnitionOffsets[ignitionQueueLength - 1]);
       }
     }
   }
@@ -78,8 +78,29 @@ unsigned char currentWheelEvent; // Current or last wheel event index.
 unsigned long wheelEventTimeStamps[numberOfWheelEvents];
 // final output variable, probably move into inputVars struct?
 unsigned short* RPM;
-// intermediate storage variable, do something with this?
-unsigned short* RPMRecord;
+// intermediate storage variable, copied into the sensor snapshot on publication
+unsigned short RPMRecord;
+// Ring of the most recent primary tooth time stamps, appended to by the
+// primary ISR and consumed by the RPM estimator in the main loop. The ISR only
+// stores and increments, all arithmetic happens in generateCoreVars().
+#define TOOTH_RING_LENGTH 8 // must be a power of two
+#define TOOTH_RING_MASK (TOOTH_RING_LENGTH - 1)
+volatile unsigned long toothTimeStamps[TOOTH_RING_LENGTH];
+// index of the next slot to be written, free running
+volatile unsigned char toothRingHead;
+// number of valid entries, saturates at TOOTH_RING_LENGTH
+volatile unsigned char toothRingFill;
+// Primary teeth between two secondary pulses. The channel events are spread
+// evenly over them: a tooth schedules channel n if it is the first tooth at or
+// past (n + 1) / INJECTION_CHANNELS of the way round, so with 6 channels every
+// second tooth schedules one.
+#define PRIMARY_PULSES_PER_SECONDARY_PULSE 12
+#if INJECTION_CHANNELS > PRIMARY_PULSES_PER_SECONDARY_PULSE
+#error "More channels than primary teeth, at most one channel per tooth"
+#endif
+// Number of channel events up to and including the given tooth
+#define CHANNEL_EVENTS_UP_TO_TOOTH(tooth) \
+  (((tooth) * INJECTION_CHANNELS) / PRIMARY_PULSES_PER_SECONDARY_PULSE)
 unsigned char ignitionEvents[6];
 unsigned char injectionEvents[12];
 unsigned char ADCSampleEvents[12]; // ???
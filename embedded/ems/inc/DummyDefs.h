@@ -338,7 +338,6 @@ extern volatile unsigned short * _PAB;
 //TODO: document why this has to be so stupid!
 extern void _start()__attribute__((weak));
 extern inline void receiveAndIncrement(const unsigned char value);
-extern inline void sendAndIncrement(unsigned char rawValue);
 extern void StackBurner();
 extern void xgateThread0End(void);
 extern void xgateThread0(void);
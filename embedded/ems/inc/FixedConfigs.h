@@ -201,6 +201,45 @@ typedef struct {
 #define SENSOR_SETTINGS_SIZE sizeof(sensorSetting)
 
 
+typedef struct {
+  /* Where each core variable is read from, resolved into the sensor pipeline
+   * at init time and whenever fixed config 2 is replaced */
+  unsigned char IATSource;
+  unsigned char CHTSource;
+  unsigned char TPSSource;
+  unsigned char EGOSource;
+  unsigned char BRVSource;
+  unsigned char MAPSource;
+  unsigned char AAPSource;
+  unsigned char MATSource;
+  unsigned char EGO2Source;
+  unsigned char IAPSource;
+  unsigned char MAFSource;
+  /* Sensor sources, not every source is valid for every sensor */
+#define SOURCE_PRESET		0	/* Fixed value from the sensor presets */
+#define SOURCE_SENSOR		1	/* Real sensor on its ADC channel */
+#define SOURCE_DASHPOT		2	/* Dash potentiometer on the ADC channel */
+#define SOURCE_IMITATE		3	/* MAP from TPS, TPS from MAP, MAT from IAT */
+#define SOURCE_BOOT_TIME	4	/* AAP as sampled before start up */
+#define SOURCE_NONE			5	/* Not fitted, reads zero (MAF only) */
+
+  /* How the load is derived from the core variables */
+  unsigned char loadSource;
+#define LOAD_FROM_MAP		0
+#define LOAD_FROM_TPS		1
+#define LOAD_FROM_AAP_MAP	2	/* AAP corrected MAP */
+
+  /* How the air flow is derived for the main pulse width */
+  unsigned char airFlowSource;
+#define AIRFLOW_SPEED_DENSITY	0
+#define AIRFLOW_ALPHA_N			1
+#define AIRFLOW_MAF				2
+#define AIRFLOW_FIXED			3	/* presetAF */
+} sensorSource;
+
+#define SENSOR_SOURCES_SIZE sizeof(sensorSource)
+
+
 #define userTextFieldArrayLength1 1024 - (ENGINE_SETTINGS_SIZE + SERIAL_SETTINGS_SIZE + TACHO_SETTINGS_SIZE + 2)
 
 /**
@@ -259,7 +298,7 @@ typedef struct {
 #define FIXED_CONFIG1_SIZE sizeof(fixedConfig1)
 
 
-#define userTextFieldArrayLength2 1024 - (SENSOR_RANGES_SIZE + SENSOR_PRESETS_SIZE + SENSOR_SETTINGS_SIZE)
+#define userTextFieldArrayLength2 1024 - (SENSOR_RANGES_SIZE + SENSOR_PRESETS_SIZE + SENSOR_SETTINGS_SIZE + SENSOR_SOURCES_SIZE)
 
 /** @copydoc fixedConfig1 */
 typedef struct {
@@ -270,6 +309,8 @@ typedef struct {
 
   sensorSetting sensorSettings;
 
+  sensorSource sensorSources;
+
   /* User text field for noting which installation the unit is from etc. */
   /* "Place your personal notes here!!" */
   unsigned char userTextField2[userTextFieldArrayLength2];
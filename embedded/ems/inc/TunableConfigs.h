@@ -61,8 +61,13 @@
 #define ARRAY_OF_16_PERCENTS	{49152, 47513, 45875, 44237, 42598, 40960, 39321, 37683, 36045, 34406, 33587, 32768, 32768, 34406, 36045, 39321}
 /** Any array of 16 RPM values forAxis values for use as axes. TODO fill out values */
 #define ARRAY_OF_16_RPMS     	{    0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0}
-/** An array of 6 percentage fuel trims, the value is 100%. */
-#define ARRAY_OF_6_FUEL_TRIMS	{32768, 32768, 32768, 32768, 32768, 32768}
+/** An array of 12 percentage fuel trims, the value is 100%. */
+#define ARRAY_OF_12_FUEL_TRIMS	{32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768}
+/** An array of 16 core variable smoothing factors in CoreVar order. The factor
+ * is the weight of the previous value, 65536 being 100%: temperatures 87.5%,
+ * AAP and BRV 75%, TPS, EGO, EGO2, MAP, IAP and MAF 50%, the deltas and RPM
+ * values not smoothed at all. */
+#define ARRAY_OF_16_FILTER_FACTORS	{57344, 57344, 32768, 32768, 32768, 49152, 49152, 57344, 32768, 32768, 32768,     0,     0,     0,     0,     0}
 
 
 /**
@@ -92,9 +97,13 @@ typedef struct {
 
 /** @copydoc SmallTables1 */
 typedef struct {
-  /* Trims for injection, from 0% to 200% of base */
-  unsigned short perCylinderFuelTrims[INJECTION_CHANNELS];
-  unsigned char filler[1012];
+  /* Trims for injection, from 0% to 200% of base, only the first
+   * INJECTION_CHANNELS are used */
+  unsigned short perCylinderFuelTrims[EMS_CHANNELS_MAX];
+  /* Exponential smoothing per core variable, in CoreVar order. The share of
+   * the previous value, 0 means no smoothing and 65535 means almost frozen. */
+  unsigned short coreVarsFilterFactors[CORE_VARS_LENGTH];
+  unsigned char filler[968];
 } SmallTables2;
 
 
@@ -114,6 +114,8 @@ EXTERN unsigned short lookupBlockDetails(unsigned short, blockDetails*) FPAGE_FE
 /* TablesB */
 #define perCylinderFuelTrimsLocationID					900
 #define perCylinderFuelTrims2LocationID					901
+#define coreVarsFilterFactorsLocationID					902
+#define coreVarsFilterFactors2LocationID				903
 
 /* TablesC */
 
@@ -142,6 +144,7 @@ EXTERN unsigned short lookupBlockDetails(unsigned short, blockDetails*) FPAGE_FE
 #define sensorPresetsLocationID						3001
 #define sensorSettingsLocationID					3002
 #define userTextField2LocationID					3003
+#define sensorSourcesLocationID						3004
 
 
 #undef EXTERN
@@ -68,15 +68,13 @@ EXTERN void resetReceiveState(unsigned char) FPAGE_FE;
 //EXTERN void sendAckIfRequired(void) FPAGE_FE;
 EXTERN void checksumAndSend(void) FPAGE_FE;
 
-EXTERN void populateBasicDatalog(void) FPAGE_FE;
+EXTERN void sendBasicDatalog(void) FPAGE_FE;
 
 
 /* Global variables for TX (one set per interface) */
 EXTERN unsigned short	TXPacketLengthToSendCAN0;
-EXTERN unsigned short	TXPacketLengthToSendSCI0;
 EXTERN unsigned char*	TXBufferCurrentPositionHandler;
 EXTERN unsigned char*	TXBufferCurrentPositionCAN0;
-EXTERN unsigned char*	TXBufferCurrentPositionSCI0;
 
 
 /* Buffer use and source IDs/flags */
@@ -218,6 +216,10 @@ EXTERN unsigned short	RXHeaderPayloadLength;
 #define requestConfigurableDatalog	402
 #define responseConfigurableDatalog	403 /* Defined because it can be used both synchronously and asynchronously */
 #define setAsyncDatalogType			404
+#define asyncCircularDatalog		405 /* Only ever sent asynchronously, see datalogRing.h */
+#define asyncToothLog				407 /* Only ever sent asynchronously, see toothLogger.h */
+#define requestLatencyHistogram		408 /* See latencyChains.h */
+#define requestISRLatencyHistogram	410 /* See isrLatency.h */
 
 /* Special function */
 #define forwardPacketOverCAN		500
@@ -0,0 +1,107 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file datalogRing.h
+ * @ingroup allHeaders
+ * @brief Calculation rate datalog
+ *
+ * After every calculation the core, derived and ADC variables are captured
+ * into a RAM ring, each snapshot encoded against the previously stored one.
+ * Whenever the TX buffer is free the main loop packs as many whole records as
+ * fit into one asyncCircularDatalog packet. Snapshots that do not fit into the
+ * ring are counted and dropped, the main loop never waits for the link.
+ *
+ * Packet payload: captured and dropped counters, two unsigned shorts each,
+ * followed by whole records. Record layout:
+ *
+ * - unsigned short length of the record in bytes, including this field
+ * - unsigned char sequence number, counts dropped snapshots too
+ * - unsigned char flags, see DATALOG_RECORD_KEYFRAME
+ * - unsigned short sample time stamp
+ * - keyframe: all DATALOG_SNAPSHOT_WORDS words of the DatalogSnapshot
+ * - otherwise: DATALOG_BITMAP_BYTES with one bit per word, LSB first, set for
+ *   words that differ from the previous record, followed by those words
+ *
+ * Only the main loop may use these functions.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_DATALOGRING_H_SEEN
+#define FILE_DATALOGRING_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef DATALOGRING_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+/* Size of the ring in bytes, must be a power of two */
+#define DATALOG_RING_SIZE 4096
+/* Every this many stored records one is sent in full */
+#define DATALOG_KEYFRAME_INTERVAL 32
+
+/* Record flags */
+#define DATALOG_RECORD_KEYFRAME BIT0
+
+/* What one record describes */
+typedef struct {
+  CoreVar core;
+  DerivedVar derived;
+  ADCArray adc;
+} DatalogSnapshot;
+
+#define DATALOG_SNAPSHOT_WORDS (sizeof(DatalogSnapshot) / sizeof(unsigned short))
+#define DATALOG_BITMAP_BYTES ((DATALOG_SNAPSHOT_WORDS + 7) / 8)
+#define DATALOG_RECORD_HEADER_SIZE 6
+#define DATALOG_RECORD_MAX_SIZE (DATALOG_RECORD_HEADER_SIZE + DATALOG_BITMAP_BYTES + sizeof(DatalogSnapshot))
+
+typedef struct {
+  unsigned short captured; /* Snapshots taken */
+  unsigned short dropped;  /* Snapshots that did not fit into the ring */
+} DatalogRingStats;
+
+EXTERN DatalogRingStats datalogRingStats;
+
+EXTERN void datalogRingReset(void) FPAGE_FE;
+EXTERN void datalogRingCapture(void) FPAGE_FE;
+EXTERN unsigned char datalogRingPending(void) FPAGE_FE;
+EXTERN unsigned short populateCircularDatalog(void) FPAGE_FE;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file DATALOGRING_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
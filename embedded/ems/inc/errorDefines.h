@@ -104,6 +104,7 @@
 #define requestedFlashPageInvalid		0x400F
 #define requestedLengthTooLarge			0x4010
 #define requestedAddressDisallowed		0x4011
+#define noSuchLatencyHistogram			0x4012
 
 #define invalidAxisOrder				0 /* prevent parsing */
 #define invalidAxisIndex				1 /* prevent parsing */
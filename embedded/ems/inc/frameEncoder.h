@@ -0,0 +1,70 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file frameEncoder.h
+ * @ingroup allHeaders
+ * @ingroup communicationsFiles
+ * @brief Streaming encoder for serial frames
+ *
+ * Builds the frame for the serial line in TXStagingBuffer in a single pass
+ * over the packet data: each block handed to frameAppend() is copied, added
+ * to the checksum and escape expanded at once. Blocks may come straight from
+ * the variables being sent, they need not be gathered in TXBuffer first.
+ *
+ * A frame is started with frameBegin() and closed by frameEnd(), which appends
+ * the checksum and the stop byte. Only one frame can be built at a time, and
+ * only while TXStagingBuffer is not being transmitted.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_FRAMEENCODER_H_SEEN
+#define FILE_FRAMEENCODER_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef FRAMEENCODER_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+EXTERN void frameBegin(void) FPAGE_FE;
+EXTERN void frameAppend(const void*, unsigned short) FPAGE_FE;
+EXTERN unsigned short frameEnd(void) FPAGE_FE;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file FRAMEENCODER_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
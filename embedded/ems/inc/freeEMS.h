@@ -111,8 +111,6 @@
 
 
 // temporary test vars
-EXTERN unsigned short RPM0; // to be replaced with logging scheme for teeth.
-EXTERN unsigned short RPM1; // to be replaced with logging scheme for teeth.
 extern unsigned short tachoPeriod;
 EXTERN unsigned char portHDebounce;
 
@@ -126,7 +124,7 @@ extern unsigned char asyncDatalogType;
 #define asyncDatalogADC			0x04
 #define asyncDatalogCircBuf		0x05
 #define asyncDatalogCircCAS		0x06
-#define asyncDatalogTrigger		0x07 // what is this
+#define asyncDatalogTrigger		0x07 // tooth logger, see toothLogger.h
 EXTERN unsigned short configuredBasicDatalogLength;
 
 
@@ -164,6 +162,11 @@ EXTERN ISRLatencyVar ISRLatencyVars;
  * consists of pulse widths, timing angles, dwell periods and scheduling
  * information.
  *
+ * Both hand overs are done with the triple buffers sensorSnapshotBuffer and
+ * mathResultBuffer (see tripleBuffer.h) rather than by swapping pointers with
+ * interrupts locked out, so neither side ever has to wait for the other and
+ * ISR latency is not affected by the main loop.
+ *
  * Accessory functions (Idle, Boost, etc)
  *
  * In order to achieve minimal latency and maximum frequency of execution of the
@@ -203,18 +206,14 @@ EXTERN DerivedVar DerivedVars0;		/** Bank 0 secondary running variables */
 
 /* If we move to xgate or isr driven logging, add bank 1 back in */
 
-/** main adc storage area for syncronous sampling in the engine position ISR or
- * injection ISR or ignition ISR etc. */
+/** sensor snapshots for syncronous sampling in the engine position ISR, handed
+ * to the mathematics through sensorSnapshotBuffer */
+EXTERN SensorSnapshot sensorSnapshots[3];
+/** triple buffer bookkeeping for sensorSnapshots, written by the engine
+ * position ISR, read by the main loop */
+EXTERN tripleBuffer sensorSnapshotBuffer;
+/** adc readings of the snapshot currently owned by the main loop */
 EXTERN ADCArray* ADCArrays;
-/** main adc storage area for syncronous sampling in the engine position ISR or
- * injection ISR or ignition ISR etc. */
-EXTERN ADCArray* ADCArraysRecord;
-/** main adc storage area for syncronous sampling in the engine position ISR or
- * injection ISR or ignition ISR etc. */
-EXTERN ADCArray ADCArrays0;
-/** main adc storage area for syncronous sampling in the engine position ISR or
- * injection ISR or ignition ISR etc. */
-EXTERN ADCArray ADCArrays1;
 
 /** secondary adc storage area for asynchronously sampling in the RTC/RTI ISR */
 EXTERN ADCArray* asyncADCArrays;
@@ -226,11 +225,7 @@ EXTERN ADCArray asyncADCArrays0;
 EXTERN ADCArray asyncADCArrays1;
 
 EXTERN unsigned short* mathSampleTimeStamp; // TODO temp, remove
-EXTERN unsigned short* mathSampleTimeStampRecord; // TODO temp, remove
 EXTERN unsigned short* currentDwellMath; // TODO temp, remove
-EXTERN unsigned short* currentDwellRealtime; // TODO temp, remove
-EXTERN unsigned short currentDwell0; // TODO temp, remove
-EXTERN unsigned short currentDwell1; // TODO temp, remove
 
 /*break this on purpose so i fix it later
 #define VETablereference (*((volatile mainTable*)(0x1000)))
@@ -251,8 +246,9 @@ not be possible... TODO */
 
 
 
-/* TODO explanation of paged ram operation Unions for paged large table access
- * using RPAGE */
+/* Each RAM page holds four blocks, and each block one of the unions below. On
+ * the original hardware the pages shared one window switched by RPAGE. Here
+ * every page is real RAM and exists twice, see tableBanks.h. */
 typedef union {
   mainTable VETableMain;
   mainTable IgnitionAdvanceTableMain;
@@ -277,14 +273,26 @@ typedef union {
   SmallTables4 SmallTablesD;
 } Tables4;
 
+/* The contents of one RAM page */
+typedef struct {
+  Tables1 TablesA;
+  Tables2 TablesB;
+  Tables3 TablesC;
+  Tables4 TablesD;
+} tablePage;
+
+/* The live tables of the page with the given RPAGE value */
+#define TABLE_PAGE(RAMPage) (activeTablePages[(RAMPage) - RPAGE_MIN])
+
 
 /* Large blocks */
 EXTERN unsigned char TXBuffer[TX_BUFFER_SIZE] TXBUF;
+/* The framed and escaped packet while it is being transmitted */
+EXTERN unsigned char TXStagingBuffer[TX_STAGING_SIZE] TXBUF;
 EXTERN unsigned char RXBuffer[RX_BUFFER_SIZE] RXBUF;
-EXTERN Tables1 TablesA RWINDOW;
-EXTERN Tables2 TablesB RWINDOW;
-EXTERN Tables3 TablesC RWINDOW;
-EXTERN Tables4 TablesD RWINDOW;
+EXTERN tablePage tablePageBanks[TABLE_PAGES][2] RWINDOW;
+/* The bank of each page that the calculations read, only ever swapped */
+EXTERN tablePage* volatile activeTablePages[TABLE_PAGES];
 
 
 /* RAM page variables */
@@ -380,9 +388,9 @@ EXTERN unsigned short coreStatusA;
 #define SPARK_RETARD	BIT8_16
 /*  9 Fire the staged injectors */
 #define STAGED_REQUIRED	BIT9_16
-/* 10 Fuel and ignition require calculation (i.e. variables have been updated) */
+/* 10 Unused, fresh inputs are signalled through sensorSnapshotBuffer */
 #define CALC_FUEL_IGN	BIT10_16
-/* 11 Flag to force ADC sampling at low rpm/stall */
+/* 11 Unused, forced readings are requested through forcedReadingRequests */
 #define FORCE_READING	BIT11_16
 /* 12 */
 #define COREA12			BIT12_16
@@ -404,16 +412,22 @@ EXTERN unsigned short coreStatusA;
 #define CLEAR_FORCE_READING	NBIT11_16
 
 
-//TODO make this volatile?
 /* ECT IC extension variable (init not required, don't care where it is, only
  * differences between figures) */
 /* Increment for each overflow of the main timer, allows finer resolution and
- * longer time period */
-unsigned short timerExtensionClock;
+ * longer time period. Do not combine it with timer values directly, use
+ * hal_timer_time_get32() and friends which handle pending overflows. */
+EXTERN volatile unsigned short timerExtensionClock;
 /* section 10.3.5 page 290 68hc11 reference manual
  * e.g. groups.csail.mit.edu/drl/courses/cs54-2001s/pdf/M68HC11RM.pdf */
 
 
+/* Incremented by the RTC to force ADC sampling at low rpm/stall. Only the RTC
+ * writes it, the main loop compares it with the number of readings taken, so
+ * no flag has to be cleared with interrupts locked out. */
+EXTERN volatile unsigned char forcedReadingRequests;
+
+
 /* For extracting 32 bit long time stamps from the overflow counter and timer
  * registers */
 /* Declare Union http://www.esacademy.com/faq/docs/cpointers/structures.htm */
@@ -431,10 +445,10 @@ EXTERN unsigned char mainOn;
 /* Keep track of ignition output state */
 EXTERN unsigned short dwellOn;
 /* Ensure we turn an injector off again if we turn it on. */
-EXTERN unsigned char stagedOn;
+EXTERN unsigned short stagedOn;
 /* Set the start time of injection at the end of the last one in the channels
  * ISR instead of the input ISR */
-EXTERN unsigned char selfSetTimer;
+EXTERN unsigned short selfSetTimer;
 /* Pulse width is probably longer than engine cycle so schedule a restart at the
  * next start time */
 EXTERN unsigned char rescheduleFuelFlags;
@@ -537,10 +551,6 @@ EXTERN unsigned short queuedIgnitionOffsets[IGNITION_CHANNELS];
 
 /* Injection stuff */
 
-/* Register addresses */
-EXTERN volatile unsigned short * volatile injectorMainTimeRegisters[INJECTION_CHANNELS];
-EXTERN volatile unsigned char * volatile injectorMainControlRegisters[INJECTION_CHANNELS];
-
 /* Timer holding vars (init not required) */
 EXTERN unsigned short injectorMainStartTimesHolding[INJECTION_CHANNELS];
 EXTERN unsigned long injectorMainEndTimes[INJECTION_CHANNELS];
@@ -550,15 +560,16 @@ EXTERN unsigned long injectorMainEndTimes[INJECTION_CHANNELS];
 EXTERN unsigned short injectorCodeOpenRuntimes[INJECTION_CHANNELS];
 EXTERN unsigned short injectorCodeCloseRuntimes[INJECTION_CHANNELS];
 
-/* individual channel pulsewidths (init not required) */
+/* results of the mathematics, handed to the scheduling ISRs through
+ * mathResultBuffer (init not required) */
+EXTERN MathResult mathResults[3];
+/* triple buffer bookkeeping for mathResults, written by the main loop, read
+ * by the ISRs */
+EXTERN tripleBuffer mathResultBuffer;
+
+/* individual channel pulsewidths of the result being calculated */
 EXTERN unsigned short* injectorMainPulseWidthsMath;
 EXTERN unsigned short* injectorStagedPulseWidthsMath;
-EXTERN unsigned short* injectorMainPulseWidthsRealtime;
-EXTERN unsigned short* injectorStagedPulseWidthsRealtime;
-EXTERN unsigned short injectorMainPulseWidths0[INJECTION_CHANNELS];
-EXTERN unsigned short injectorMainPulseWidths1[INJECTION_CHANNELS];
-EXTERN unsigned short injectorStagedPulseWidths0[INJECTION_CHANNELS];
-EXTERN unsigned short injectorStagedPulseWidths1[INJECTION_CHANNELS];
 
 /* Channel latencies (init not required) */
 EXTERN unsigned short injectorCodeLatencies[INJECTION_CHANNELS];
@@ -92,16 +92,16 @@ EXTERN const unsigned char interfaceVersionAndType[20];
 EXTERN const unsigned char firmwareVersion[29];
 
 /* Ignition */
-EXTERN const unsigned short dwellStartMasks[IGNITION_CHANNELS];
-EXTERN const unsigned short ignitionMasks[IGNITION_CHANNELS];
+EXTERN const unsigned short dwellStartMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned short ignitionMasks[EMS_CHANNELS_MAX];
 
 /* Injection */
-EXTERN const unsigned char injectorMainOnMasks[INJECTION_CHANNELS];
-EXTERN const unsigned char injectorMainOffMasks[INJECTION_CHANNELS];
-EXTERN const unsigned char injectorMainEnableMasks[INJECTION_CHANNELS];
-EXTERN const unsigned char injectorMainDisableMasks[INJECTION_CHANNELS];
-EXTERN const unsigned char injectorMainGoHighMasks[INJECTION_CHANNELS];
-EXTERN const unsigned char injectorMainGoLowMasks[INJECTION_CHANNELS];
+EXTERN const unsigned short injectorMainOnMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned short injectorMainOffMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned char injectorMainEnableMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned char injectorMainDisableMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned char injectorMainGoHighMasks[EMS_CHANNELS_MAX];
+EXTERN const unsigned char injectorMainGoLowMasks[EMS_CHANNELS_MAX];
 
 
 #endif
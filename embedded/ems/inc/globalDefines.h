@@ -43,6 +43,8 @@
 #ifndef FILE_GLOBALDEFINES_H_SEEN
 #define FILE_GLOBALDEFINES_H_SEEN
 
+#include <ems/channels.h>
+
 
 /* TODO perhaps configure various ports and pins etc to have names such that the
  * code can stay untouched when being ported and just the header changed to suit?
@@ -318,6 +320,8 @@
 #define ticksPerCycleAtOneRPMx2	300000000
 /* how many 0.8us ticks there are in between engine cycles at 1 RPM */
 #define ticksPerCycleAtOneRPM	150000000
+/* how many 0.8us ticks there are in one second */
+#define ticksPerSecond			1250000
 /* Provides for a 4 cylinder down to 50 RPM  */
 #define tachoTickFactor4at50	6
 /*  8 events per cycle for a typical 4 cylinder tacho, 4 on, 4 off */
@@ -344,10 +348,10 @@
 /* Not 1024, the number of gaps between them */
 #define ADC_DIVISIONS 1023
 
-/* How many ignition channels the code should support */
-#define IGNITION_CHANNELS 12
-/* How many injection channels the code should support */
-#define INJECTION_CHANNELS 6
+/* How many ignition channels the code should support, set at build time */
+#define IGNITION_CHANNELS EMS_CHANNELS
+/* How many injection channels the code should support, set at build time */
+#define INJECTION_CHANNELS EMS_CHANNELS
 
 /* Ignition defines */
 #define DWELL_ENABLE BIT0
@@ -377,6 +381,8 @@
 #define RPAGE_TIME_ONE	0xFC
 #define RPAGE_TIME_TWO	0xFD
 #define RPAGE_MIN     	0xF8
+/* Number of RAM pages used for tables, RPAGE_MIN upwards */
+#define TABLE_PAGES   	6
 #define PPAGE_MIN     	0xE0
 #define EPAGE_MIN     	0x?? // TODO
 
@@ -384,6 +390,8 @@
 /* needs to also receive a header, checksum and attributes for the data    */
 /* involved and the TX buffer needs to handle all of those two fold.       */
 #define TX_BUFFER_SIZE      0x0820
+/* Worst case of a whole TX buffer escaped plus the start and stop bytes */
+#define TX_STAGING_SIZE     ((TX_BUFFER_SIZE * 2) + 2)
 #define RX_BUFFER_SIZE      0x0810
 #define TransferTableSize   2048
 #define TX_MAX_PAYLOAD_SIZE 2048
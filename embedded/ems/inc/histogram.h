@@ -0,0 +1,66 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file histogram.h
+ * @ingroup allHeaders
+ * @brief Inline counting into power of two histograms
+ *
+ * Bucket 0 counts zero, bucket n counts values from 2^(n-1) to 2^n - 1, that
+ * is the bit length of the value, and the last bucket everything above. The
+ * counts saturate. Used by the latency chains and the ISR latencies.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_HISTOGRAM_H_SEEN
+#define FILE_HISTOGRAM_H_SEEN
+
+
+#include <stdint.h>
+
+
+/** @brief Add one value to a row of power of two buckets, saturating
+ *
+ * Runs in constant time.
+ *
+ * @param buckets the row to count in
+ * @param bucketCount number of buckets in the row, at least 1
+ * @param value the value to count
+ */
+static inline void histogramCount(unsigned short* buckets, unsigned char bucketCount, uint32_t value) {
+  unsigned char bucket = 0;
+  if(value != 0) {
+    bucket = (sizeof(unsigned long) * 8) - __builtin_clzl(value);
+  }
+  if(bucket > (bucketCount - 1)) {
+    bucket = bucketCount - 1;
+  }
+  if(buckets[bucket] != 0xFFFF) {
+    buckets[bucket]++;
+  }
+}
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file HISTOGRAM_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
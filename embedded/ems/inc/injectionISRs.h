@@ -55,20 +55,32 @@
 #define STAGEDPORT PORTK
 
 /* Masks for setting and checking stagedOn status var and turning the channel on */
-#define STAGED1ON BIT0
-#define STAGED2ON BIT1
-#define STAGED3ON BIT2
-#define STAGED4ON BIT3
-#define STAGED5ON BIT4
-#define STAGED6ON BIT5
+#define STAGED1ON BIT0_16
+#define STAGED2ON BIT1_16
+#define STAGED3ON BIT2_16
+#define STAGED4ON BIT3_16
+#define STAGED5ON BIT4_16
+#define STAGED6ON BIT5_16
+#define STAGED7ON BIT6_16
+#define STAGED8ON BIT7_16
+#define STAGED9ON BIT8_16
+#define STAGED10ON BIT9_16
+#define STAGED11ON BIT10_16
+#define STAGED12ON BIT11_16
 
 /* Masks for unsetting stagedOn status var and turning the channel off */
-#define STAGED1OFF NBIT0
-#define STAGED2OFF NBIT1
-#define STAGED3OFF NBIT2
-#define STAGED4OFF NBIT3
-#define STAGED5OFF NBIT4
-#define STAGED6OFF NBIT5
+#define STAGED1OFF NBIT0_16
+#define STAGED2OFF NBIT1_16
+#define STAGED3OFF NBIT2_16
+#define STAGED4OFF NBIT3_16
+#define STAGED5OFF NBIT4_16
+#define STAGED6OFF NBIT5_16
+#define STAGED7OFF NBIT6_16
+#define STAGED8OFF NBIT7_16
+#define STAGED9OFF NBIT8_16
+#define STAGED10OFF NBIT9_16
+#define STAGED11OFF NBIT10_16
+#define STAGED12OFF NBIT11_16
 
 /* Internal use to decide if staged is actually required or not based on
  * pulsewidth etc */
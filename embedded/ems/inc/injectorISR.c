@@ -35,7 +35,7 @@
  *
  * @brief Injector ISR shared code
  *
- * This code is identical between all 6 channels, and thus we only want one
+ * This code is identical between all channels, and thus we only want one
  * copy of it. The X in each macro will be replaced with the number that is
  * appropriate for the channel it is being used for at the time.
  *
@@ -88,10 +88,11 @@ void InjectorXISR()
 */
 #define STR(X) _STR(X)
 #define _STR(X) #X
-PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
+PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER), PERF_REGION_INJECTION) {
 
   /* Record the current time as start time */
-  unsigned short TCNTStart = hal_timer_time_get();
+  uint32_t TCNTStartLong = hal_timer_time_get32();
+  unsigned short TCNTStart = (unsigned short)TCNTStartLong;
   /*
   #ifdef __PERF__
   char executionPathIdentifier = 'x';
@@ -101,10 +102,13 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
   PERF_PATH_INIT('x');
 
   /* Record the edge time stamp from the IC register */
-  unsigned short edgeTimeStamp = hal_timer_oc_compare_get(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER));
+  unsigned long edgeTimeStampLong = hal_timer_oc_compare_get32(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER));
+  unsigned short edgeTimeStamp = (unsigned short)edgeTimeStampLong;
 
   /* Calculate and store the latency based on compare time and start time */
   injectorCodeLatencies[INJECTOR_CHANNEL_NUMBER] = TCNTStart - edgeTimeStamp;
+  isrLatencyRecord(ISR_LATENCY_INJECTOR(INJECTOR_CHANNEL_NUMBER),
+                   injectorCodeLatencies[INJECTOR_CHANNEL_NUMBER]);
 
   /* If rising edge triggered this */
   if(hal_timer_oc_pin_get(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER)) == HIGH) {
@@ -115,8 +119,16 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
     */
     PERF_PATH_SET('h');
 
+    /* The HALs do not time stamp the compare match itself, the ISR entry is
+     * the earliest time the switch is known to have happened. Closing with the
+     * compare value would make the error row zero by construction. */
+    latencyChainClose(LATENCY_INJECTION, INJECTOR_CHANNEL_NUMBER, TCNTStartLong);
+
+    /* Use the latest complete result of the mathematics */
+    tripleBufferAcquire(&mathResultBuffer);
+
     /* Find out what max and min for pulse width are */
-    unsigned short localPulseWidth = injectorMainPulseWidthsRealtime[INJECTOR_CHANNEL_NUMBER];
+    unsigned short localPulseWidth = mathResults[mathResultBuffer.reading].injectorMainPulseWidths[INJECTOR_CHANNEL_NUMBER];
     unsigned short localMinimumPulseWidth = injectorSwitchOnCodeTime + injectorCodeLatencies[INJECTOR_CHANNEL_NUMBER];
     /** @todo TODO *maybe* instead of checking min and increasing pulse, just
      * force it straight off if diff between start and now+const is greater than
@@ -127,21 +139,8 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
       localPulseWidth = localMinimumPulseWidth;
     }/* else{ just use the value } */
 
-    LongTime timeStamp;
-
-    /* Install the low word */
-    timeStamp.timeShorts[0] = edgeTimeStamp;
-
-    /* Find out what our timer value means and put it in the high word */
-    if(hal_timer_overflow_get()) {
-      timeStamp.timeShorts[1] = timerExtensionClock + 1;
-    }
-    else {
-      timeStamp.timeShorts[1] = timerExtensionClock;
-    }
-
     // store the end time for use in the scheduler
-    injectorMainEndTimes[INJECTOR_CHANNEL_NUMBER] = timeStamp.timeLong + localPulseWidth;
+    injectorMainEndTimes[INJECTOR_CHANNEL_NUMBER] = edgeTimeStampLong + localPulseWidth;
 
     /* Set the action for compare to switch off FIRST or it might inadvertently
      * PWM the injector during opening... */
@@ -150,7 +149,7 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
     /* Set the time to turn off again */
     hal_timer_oc_compare_set(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER), edgeTimeStamp + localPulseWidth);
 
-    log_printf("Nh%u@%u: Nl@%u (%u)\r\n", INJECTOR_CHANNEL_NUMBER, edgeTimeStamp, edgeTimeStamp + localPulseWidth, localPulseWidth);
+    log_event("Nh%u@%u: Nl@%u (%u)\r\n", INJECTOR_CHANNEL_NUMBER, edgeTimeStamp, edgeTimeStamp + localPulseWidth, localPulseWidth);
 
     /* This is the point we actually want the time to, but because the code is
      * so simple, it can't help but be a nice short time */
@@ -173,7 +172,7 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
   }
   else { // Stuff for switch off time
     PERF_PATH_SET('l');
-    log_printf("Nl%u@%u\r\n", INJECTOR_CHANNEL_NUMBER, edgeTimeStamp);
+    log_event("Nl%u@%u\r\n", INJECTOR_CHANNEL_NUMBER, edgeTimeStamp);
     /* If we switched the staged injector on and it's still on, turn it off now.*/
     if (stagedOn & STAGEDXON) {
       STAGEDPORT &= STAGEDXOFF;
@@ -186,7 +185,8 @@ PERF_WRAP_PATH(InjectorXISR, "i" STR(INJECTOR_CHANNEL_NUMBER)) {
       hal_timer_oc_compare_set(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER), injectorMainStartTimesHolding[INJECTOR_CHANNEL_NUMBER]);
       hal_timer_oc_output_set(INJECTIONX_OUTPUT(INJECTOR_CHANNEL_NUMBER), OC_MODE_TO_HIGH);
       selfSetTimer &= injectorMainOffMasks[INJECTOR_CHANNEL_NUMBER];
-      log_printf("Nlur@%u\r\n", injectorMainStartTimesHolding[INJECTOR_CHANNEL_NUMBER]);
+      latencyChainProgrammed(LATENCY_INJECTION, INJECTOR_CHANNEL_NUMBER);
+      log_event("Nlur@%u\r\n", injectorMainStartTimesHolding[INJECTOR_CHANNEL_NUMBER]);
     }
     else {
       // Disable interrupts and actions incase the period from this end to the
@@ -97,6 +97,36 @@ void Injector5ISR(void) TEXT1;
  * @detail OC timer for injector channel 6
  */
 void Injector6ISR(void) TEXT1;
+/** @brief Injector7ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 7, only with INJECTION_CHANNELS > 6
+ */
+void Injector7ISR(void) TEXT1;
+/** @brief Injector8ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 8, only with INJECTION_CHANNELS > 7
+ */
+void Injector8ISR(void) TEXT1;
+/** @brief Injector9ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 9, only with INJECTION_CHANNELS > 8
+ */
+void Injector9ISR(void) TEXT1;
+/** @brief Injector10ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 10, only with INJECTION_CHANNELS > 9
+ */
+void Injector10ISR(void) TEXT1;
+/** @brief Injector11ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 11, only with INJECTION_CHANNELS > 10
+ */
+void Injector11ISR(void) TEXT1;
+/** @brief Injector12ISR is expanded from InjectorXISR via include statement,
+ * and macro definition(s)
+ * @detail OC timer for injector channel 12, only with INJECTION_CHANNELS > 11
+ */
+void Injector12ISR(void) TEXT1;
 /* IC timer for primary engine position and RPM */
 void PrimaryRPMISR(void) TEXT1;
 /* IC timer for secondary engine position and RPM */
@@ -127,6 +157,8 @@ void XIRQISR(void) TEXT1;
 void RTIISR(void) TEXT1;
 /* Serial 0 interrupt service routine */
 void SCI0ISR(void) TEXT1;
+/* Serial 0 frame transmitted, called by the HAL */
+void SCI0TXCompleteISR(void) TEXT1;
 /* Low voltage counter ISR */
 void LowVoltageISR(void) TEXT1;
 /* VReg periodic interrupt ISR */
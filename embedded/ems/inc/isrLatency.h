@@ -0,0 +1,89 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file isrLatency.h
+ * @ingroup allHeaders
+ * @brief Histograms of the interrupt latencies
+ *
+ * The ISRs that know the time of the event that triggered them measure their
+ * latency, the time from that event to the start of their code. Besides the
+ * latest value in ISRLatencyVars and injectorCodeLatencies every latency is
+ * counted in a histogram of its source, so that the tail under load can be
+ * seen. Bucket 0 counts zero, bucket n counts values from 2^(n-1) to 2^n - 1,
+ * which covers all unsigned short latencies. The largest latency is kept as
+ * well. The counts saturate.
+ *
+ * A histogram is sent in response to requestISRLatencyHistogram. The payload
+ * is the source and a flag byte, if that is nonzero the histogram is cleared
+ * once it is copied. The response echoes the source, followed by the
+ * isrLatencyHistogram.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_ISRLATENCY_H_SEEN
+#define FILE_ISRLATENCY_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef ISRLATENCY_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+/* Interrupt sources */
+#define ISR_LATENCY_PRIMARY_RPM    0
+#define ISR_LATENCY_SECONDARY_RPM  1
+#define ISR_LATENCY_INJECTOR(channel) (2 + (channel))
+#define ISR_LATENCY_SOURCES        (2 + INJECTION_CHANNELS)
+
+/* One bucket per bit of an unsigned short plus one for zero */
+#define ISR_LATENCY_BUCKETS 17
+
+typedef struct {
+  unsigned short count;
+  unsigned short max;
+  unsigned short buckets[ISR_LATENCY_BUCKETS];
+} isrLatencyHistogram;
+
+EXTERN isrLatencyHistogram isrLatencyHistograms[ISR_LATENCY_SOURCES];
+
+EXTERN void isrLatencyRecord(unsigned char, unsigned short) TEXT;
+EXTERN unsigned short populateISRLatencyHistogram(unsigned char, unsigned char) FPAGE_FE;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file ISRLATENCY_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
@@ -0,0 +1,116 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file latencyChains.h
+ * @ingroup allHeaders
+ * @brief Edge to actuation latency of every injection and ignition event
+ *
+ * When the primary RPM ISR schedules an output event it opens a chain for
+ * that event: the time stamp of the tooth edge, the entry of the ISR, the
+ * time the output timer was programmed and the time the output is due. The
+ * ISR that drives the output closes the chain with the time the output
+ * actually switched. All times are 32 bit HAL timer ticks.
+ *
+ * Closed chains are added to a histogram per event kind and channel, one row
+ * of power of two buckets per stage, see histogram.h. Outputs that switched
+ * before their due time are counted as early instead of being put into the
+ * error row.
+ *
+ * The histograms are sent in response to requestLatencyHistogram. The payload
+ * is the kind, the channel and a flag byte, if that is nonzero the histogram
+ * is cleared once it is copied. The response echoes the kind and channel,
+ * followed by the latencyHistogram of that channel.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_LATENCYCHAINS_H_SEEN
+#define FILE_LATENCYCHAINS_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef LATENCYCHAINS_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+#include <stdint.h>
+
+/* Event kinds */
+#define LATENCY_INJECTION 0 /* Injector switched on by output compare */
+#define LATENCY_DWELL     1 /* Coil switched on by IgnitionDwellISR */
+#define LATENCY_FIRE      2 /* Coil switched off by IgnitionFireISR */
+#define LATENCY_KINDS     3
+
+/* Histogram rows */
+#define LATENCY_STAGE_ENTRY      0 /* ISR entry - tooth edge */
+#define LATENCY_STAGE_PROGRAMMED 1 /* output timer programmed - tooth edge */
+#define LATENCY_STAGE_ERROR      2 /* actual - due output time */
+#define LATENCY_STAGE_TOTAL      3 /* actual output time - tooth edge */
+#define LATENCY_STAGES           4
+
+#define LATENCY_BUCKETS 16
+
+/* Chain states */
+#define LATENCY_CHAIN_IDLE   0
+#define LATENCY_CHAIN_QUEUED 1 /* Waiting for the output timer to be programmed */
+#define LATENCY_CHAIN_ARMED  2 /* Waiting for the output to switch */
+
+typedef struct {
+  uint32_t edge;
+  uint32_t entry;
+  uint32_t programmed;
+  uint32_t due;
+  unsigned char state;
+} latencyChain;
+
+typedef struct {
+  unsigned short events;
+  unsigned short early;
+  unsigned short buckets[LATENCY_STAGES][LATENCY_BUCKETS];
+} latencyHistogram;
+
+EXTERN latencyChain latencyChains[LATENCY_KINDS][EMS_CHANNELS];
+EXTERN latencyHistogram latencyHistograms[LATENCY_KINDS][EMS_CHANNELS];
+
+EXTERN void latencyChainOpen(unsigned char, unsigned char, uint32_t, uint32_t, uint32_t, unsigned char) TEXT;
+EXTERN void latencyChainProgrammed(unsigned char, unsigned char) TEXT;
+EXTERN void latencyChainClose(unsigned char, unsigned char, uint32_t) TEXT;
+EXTERN unsigned short populateLatencyHistogram(unsigned char, unsigned char, unsigned char) FPAGE_FE;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file LATENCYCHAINS_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
@@ -44,6 +44,11 @@
 #include "derivedVarsGenerator.h"
 #include "fuelAndIgnitionCalcs.h"
 #include "DecoderInterface.h"
+#include "tripleBuffer.h"
+#include "datalogRing.h"
+#include "toothLogger.h"
+#include "latencyChains.h"
+#include "isrLatency.h"
 
 /* Computer Operating Properly reset sequence MC9S12XDP512V2.PDF Section 2.4.1.5 */
 #define COP_RESET1 0x55
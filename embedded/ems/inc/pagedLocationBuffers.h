@@ -116,6 +116,8 @@ EXTERN void* dwellMaxVersusRPMTable2Location;
 /* Small chunks of TablesB here */
 EXTERN void* perCylinderFuelTrimsLocation;
 EXTERN void* perCylinderFuelTrims2Location;
+EXTERN void* coreVarsFilterFactorsLocation;
+EXTERN void* coreVarsFilterFactors2Location;
 
 /* Small chunks of TablesC here */
 
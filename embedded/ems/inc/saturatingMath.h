@@ -0,0 +1,133 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file saturatingMath.h
+ * @ingroup allHeaders
+ * @brief Inline saturating arithmetic on unsigned shorts
+ *
+ * All results are clamped to 0 - SHORTMAX instead of wrapping. On cores with
+ * the ARM DSP extension the USAT and UQADD16 instructions are used, the
+ * portable versions elsewhere are branch free.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_SATURATING_MATH_H_SEEN
+#define FILE_SATURATING_MATH_H_SEEN
+
+
+/** @brief Clamp a 17 bit unsigned value to SHORTMAX */
+static inline unsigned short saturate17(unsigned long value) {
+  /* value >> 16 is 0 or 1, so this ORs in either nothing or all ones */
+  return (unsigned short)(value | -(value >> 16));
+}
+
+
+/** @brief Add two unsigned shorts, returning SHORTMAX on overflow
+ *
+ * @param addend1
+ * @param addend2
+ */
+static inline unsigned short safeAdd(unsigned short addend1, unsigned short addend2) {
+#if defined(__ARM_FEATURE_DSP)
+  unsigned long sum;
+  __asm__ ("uqadd16 %0, %1, %2" : "=r" (sum) : "r" (addend1), "r" (addend2));
+  return (unsigned short)sum;
+#else
+  return saturate17((unsigned long)addend1 + addend2);
+#endif
+}
+
+
+/** @brief Add a signed trim to an unsigned short, clamping to 0 - SHORTMAX
+ *
+ * @param addend1
+ * @param addend2
+ */
+static inline unsigned short safeTrim(unsigned short addend1, signed short addend2) {
+  signed long sum = (signed long)addend1 + addend2;
+#if defined(__ARM_FEATURE_DSP)
+  __asm__ ("usat %0, #16, %1" : "=r" (sum) : "r" (sum));
+  return (unsigned short)sum;
+#else
+  /* Clear negative results, then clamp the positive ones */
+  sum &= ~(sum >> 31);
+  return saturate17((unsigned long)sum);
+#endif
+}
+
+
+/** @brief Scale without overflow
+ *
+ * Takes a base value and a scaler where 0x8000/32768 means 100%, 0 means 0%
+ * and 0xFFFF/65535 means 200%, and returns the baseValue multiplied, in effect,
+ * by the resulting percentage figure, clamped to SHORTMAX.
+ *
+ * @param baseValue
+ * @param scaler
+ */
+static inline unsigned short safeScale(unsigned short baseValue, unsigned short scaler) {
+  /* At most 17 bits after the shift */
+  unsigned long scaled = ((unsigned long)baseValue * scaler) >> 15;
+#if defined(__ARM_FEATURE_DSP)
+  __asm__ ("usat %0, #16, %1" : "=r" (scaled) : "r" (scaled));
+  return (unsigned short)scaled;
+#else
+  return saturate17(scaled);
+#endif
+}
+
+
+/** @brief Scale a value per channel and add a common offset
+ *
+ * Computes results[i] = safeAdd(safeScale(baseValue, scalers[i]), addend) for
+ * all channels in one pass. With the DSP extension two channels are packed
+ * into one register and the addition is done by a single UQADD16.
+ *
+ * @param results destination array, count entries
+ * @param scalers per channel scalers, count entries
+ * @param baseValue value to be scaled
+ * @param addend added to every scaled value
+ * @param count number of channels
+ */
+static inline void safeScaleAddChannels(unsigned short* results, const unsigned short* scalers, unsigned short baseValue, unsigned short addend, unsigned char count) {
+  unsigned char channel = 0;
+#if defined(__ARM_FEATURE_DSP)
+  unsigned long addends = ((unsigned long)addend << 16) | addend;
+  for (; (channel + 1) < count; channel += 2) {
+    unsigned long pair = safeScale(baseValue, scalers[channel])
+                         | ((unsigned long)safeScale(baseValue, scalers[channel + 1]) << 16);
+    __asm__ ("uqadd16 %0, %1, %2" : "=r" (pair) : "r" (pair), "r" (addends));
+    results[channel] = (unsigned short)pair;
+    results[channel + 1] = (unsigned short)(pair >> 16);
+  }
+#endif
+  for (; channel < count; channel++) {
+    results[channel] = safeAdd(safeScale(baseValue, scalers[channel]), addend);
+  }
+}
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file SATURATING_MATH_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
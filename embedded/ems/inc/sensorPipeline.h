@@ -0,0 +1,83 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file sensorPipeline.h
+ * @ingroup allHeaders
+ * @brief Sensor conversions selected by configuration
+ *
+ * The sensor sources in fixedConfigs2 are resolved once into a table of
+ * conversion routines, one per core variable, plus one routine each for load
+ * and air flow. The calculation path then simply runs the table.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_SENSORPIPELINE_H_SEEN
+#define FILE_SENSORPIPELINE_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef SENSORPIPELINE_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+/* Number of core variables read from sensors */
+#define SENSOR_PIPELINE_LENGTH 11
+
+/* Converts the current ADC readings into one core variable. Earlier stages
+ * have already been written to readings, later ones have not. */
+typedef unsigned short (*sensorConversion)(const CoreVar* readings);
+
+/* Derives the air flow, may replace the inlet temperature used with it */
+typedef unsigned short (*airFlowConverter)(unsigned short* airInletTemp);
+
+typedef struct {
+  /* Index of the destination within CoreVar, in unsigned shorts */
+  unsigned char index;
+  sensorConversion convert;
+} sensorStage;
+
+EXTERN sensorStage sensorPipeline[SENSOR_PIPELINE_LENGTH];
+EXTERN sensorConversion loadConversion;
+EXTERN airFlowConverter airFlowConversion;
+
+EXTERN void resolveSensorPipeline(void) FPAGE_FE;
+EXTERN void runSensorPipeline(CoreVar*) LOOKUPF;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file SENSORPIPELINE_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
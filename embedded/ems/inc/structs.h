@@ -142,7 +142,7 @@ typedef struct {
 
 #define RUNTIME_VARS_SIZE sizeof(RuntimeVar)
 /* How many runtime vars */
-#define RUNTIME_VARS_LENGTH 13
+#define RUNTIME_VARS_LENGTH 14
 /* How large each element is in bytes (short = 2 bytes) */
 #define RUNTIME_VARS_UNIT 2
 /* Use this block to manage the execution time of various functions loops and
@@ -167,6 +167,10 @@ typedef struct {
   unsigned short mainLoopRuntime;
   unsigned short logSendingRuntime;
   unsigned short serialISRRuntime;
+
+  /* Share of time the cpu was not idling in the main loop, including ISRs:
+   * 0 - 100.00 % (/100) */
+  unsigned short mainLoopLoad;
 } RuntimeVar;
 
 
@@ -195,8 +199,6 @@ typedef struct {
 
   /* Not an ISR, but important none the less */
   unsigned short mathLatency;
-  unsigned short mathSampleTimeStamp0;
-  unsigned short mathSampleTimeStamp1;
 } ISRLatencyVar;
 
 
@@ -271,11 +273,13 @@ typedef struct {
    */
   unsigned short RPM;
   /* Delta RPM (Calced):
-   *  0 - 32767.5  (0.5 RPM/Second (/2))
+   *  -32767 - 32767 raw, two's complement, limited by DELTA_RPM_LIMIT
+   *  -16383.5 - 16383.5  (0.5 RPM/Second (/2))
    */
   unsigned short DRPM;
   /* Delta Delta RPM (Calced):
-   * 0 - 32767.5  (0.5 RPM/Second^2 (/2))
+   *  -32767 - 32767 raw, two's complement, limited by DELTA_RPM_LIMIT
+   *  -16383.5 - 16383.5  (0.5 RPM/Second^2 (/2))
    */
   unsigned short DDRPM;
 } CoreVar;
@@ -340,6 +344,40 @@ typedef struct {
 } ADCArray;
 
 
+/* Coherent set of inputs for one run of the mathematics, published by the
+ * engine position ISR through a triple buffer, see tripleBuffer.h */
+typedef struct {
+  /* HAL buffer holding the ADC scan taken synchronously to the engine
+   * position, laid out as an ADCArray, see hal_adc_acquire() */
+  unsigned char ADCBuffer;
+  /* Rough RPM at the time of sampling */
+  unsigned short RPM;
+  /* Timer value at the time of sampling */
+  unsigned short sampleTimeStamp;
+} SensorSnapshot;
+
+
+/* Coherent set of outputs of one run of the mathematics, published by the
+ * main loop through a triple buffer for use by the scheduling ISRs */
+typedef struct {
+  unsigned short dwell;
+  unsigned short injectorMainPulseWidths[INJECTION_CHANNELS];
+  unsigned short injectorStagedPulseWidths[INJECTION_CHANNELS];
+} MathResult;
+
+
+/* Index bookkeeping for a single writer, single reader triple buffer. The
+ * buffers themselves are a plain array of three elements owned by the user. */
+typedef struct {
+  /* Buffer most recently published by the writer */
+  volatile unsigned char latest;
+  /* Buffer currently owned by the reader */
+  volatile unsigned char reading;
+  /* Buffer currently being filled by the writer */
+  unsigned char writing;
+} tripleBuffer;
+
+
 #define MAINTABLE_SIZE sizeof(mainTable)
 /* How many cells on the X axis */
 #define MAINTABLE_RPM_LENGTH 24
@@ -0,0 +1,72 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file tableBanks.h
+ * @ingroup allHeaders
+ * @brief A/B banks for the tables in RAM
+ *
+ * Every table page exists twice in RAM. The calculations only ever read the
+ * active bank through TABLE_PAGE(). Edits are made to the other bank and made
+ * live by swapping the active bank pointer, a single store, so a lookup never
+ * sees a half written table.
+ *
+ * After a swap the now inactive bank lacks the last edit. It is brought up to
+ * date when the next edit of that page starts. The same happens after an edit
+ * that was dropped with tableBankDiscard().
+ *
+ * Only the main loop may edit tables.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_TABLEBANKS_H_SEEN
+#define FILE_TABLEBANKS_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef TABLEBANKS_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+EXTERN void initTableBanks(void) FPAGE_FE;
+EXTERN void* tableBankEditAddress(unsigned char, void*) TEXT;
+EXTERN void tableBankCommit(unsigned char) TEXT;
+EXTERN void tableBankDiscard(unsigned char) TEXT;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file TABLEBANKS_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
@@ -51,7 +51,7 @@
 
 
 EXTERN unsigned short lookupTwoDTableUS(twoDTableUS *, unsigned short) TEXT;
-EXTERN unsigned short lookupPagedMainTableCellValue(mainTable *, unsigned short, unsigned short, unsigned char) TEXT;
+EXTERN unsigned short lookupPagedMainTableCellValue(mainTable *, unsigned short, unsigned short) TEXT;
 
 EXTERN unsigned short setPagedMainTableCellValue(unsigned char, mainTable*, unsigned short, unsigned short, unsigned short) TEXT;
 EXTERN unsigned short setPagedMainTableRPMValue(unsigned char, mainTable*, unsigned short, unsigned short) TEXT;
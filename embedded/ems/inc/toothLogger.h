@@ -0,0 +1,98 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file toothLogger.h
+ * @ingroup allHeaders
+ * @brief Log of the crank and cam input edges
+ *
+ * While asyncDatalogTrigger is selected the RPM ISRs store every edge into a
+ * ring: the 32 bit time stamp, which input and pin state it was and whether
+ * the decoder was in sync. The main loop sends the entries as asyncToothLog
+ * packets whenever the TX buffer is free, on the host those end up in the file
+ * given by EMS_SERIAL_OUT.
+ *
+ * The ring has a single producer and a single consumer and needs no locks.
+ * The producer is interrupt context: all ISRs that log run at the same
+ * priority, so they never preempt each other. Only the producer writes
+ * toothLogHead and the overflow count, only the consumer in the main loop
+ * writes toothLogTail. Edges that find the ring full are counted and dropped.
+ *
+ * Packet payload: the overflow count as an unsigned short, followed by entries
+ * of a 32 bit time stamp and an unsigned char of flags each.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_TOOTHLOGGER_H_SEEN
+#define FILE_TOOTHLOGGER_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef TOOTHLOGGER_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+/* Number of entries, must be a power of two */
+#define TOOTH_LOG_LENGTH 256
+#define TOOTH_LOG_MASK (TOOTH_LOG_LENGTH - 1)
+
+/* Entry flags */
+#define TOOTH_LOG_SECONDARY BIT0 /* Edge on the secondary input */
+#define TOOTH_LOG_PIN_HIGH  BIT1 /* Pin state after the edge */
+#define TOOTH_LOG_SYNC      BIT2 /* PRIMARY_SYNC was set when the edge arrived */
+
+/* Bytes per entry in a packet */
+#define TOOTH_LOG_ENTRY_SIZE 5
+
+typedef struct {
+  unsigned long timeStamp;
+  unsigned char flags;
+} toothLogEntry;
+
+EXTERN toothLogEntry toothLog[TOOTH_LOG_LENGTH];
+EXTERN volatile unsigned short toothLogHead;
+EXTERN volatile unsigned short toothLogTail;
+EXTERN volatile unsigned short toothLogOverflows;
+
+EXTERN void toothLogRecord(unsigned long, unsigned char) TEXT;
+EXTERN void toothLogDiscard(void) FPAGE_FE;
+EXTERN unsigned char toothLogPending(void) FPAGE_FE;
+EXTERN unsigned short populateToothLog(void) FPAGE_FE;
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file TOOTHLOGGER_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
@@ -0,0 +1,71 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file tripleBuffer.h
+ * @ingroup allHeaders
+ * @brief Wait-free publication of coherent data sets between ISRs and main
+ *
+ * A triple buffer lets one writer hand complete data sets to one reader
+ * without ever locking out interrupts. The writer always fills a buffer that
+ * is neither the latest published one nor the one owned by the reader, and
+ * publishes it with a single byte store. The reader takes ownership of the
+ * latest buffer with a single byte store as well.
+ *
+ * Either side may be an ISR. As ISRs do not nest on the supported platforms,
+ * all ISRs reading the same triple buffer count as a single reader.
+ */
+
+/* Header file multiple inclusion protection courtesy eclipse Header Template*/
+/* and http://gcc.gnu.org/onlinedocs/gcc-3.1.1/cpp/ C pre processor manual*/
+#ifndef FILE_TRIPLEBUFFER_H_SEEN
+#define FILE_TRIPLEBUFFER_H_SEEN
+
+
+#ifdef EXTERN
+#warning "EXTERN already defined by another header, please sort it out!"
+/* If fail on warning is off, remove the definition such that we can redefine
+ * correctly. */
+#undef EXTERN
+#endif
+
+
+#ifdef TRIPLEBUFFER_C
+#define EXTERN
+#else
+#define EXTERN extern
+#endif
+
+
+EXTERN void tripleBufferInit(tripleBuffer*);
+EXTERN unsigned char tripleBufferWriteBegin(tripleBuffer*);
+EXTERN void tripleBufferPublish(tripleBuffer*);
+EXTERN unsigned char tripleBufferAcquire(tripleBuffer*);
+EXTERN unsigned char tripleBufferPending(tripleBuffer*);
+
+
+#undef EXTERN
+
+
+#else
+/* let us know if we are being untidy with headers */
+#warning "Header file TRIPLEBUFFER_H seen before, sort it out!"
+/* end of the wrapper ifdef from the very top */
+#endif
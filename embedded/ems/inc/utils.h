@@ -51,10 +51,6 @@
 #define EXTERN extern
 #endif
 
-EXTERN unsigned short safeAdd(unsigned short, unsigned short);
-EXTERN unsigned short safeTrim(unsigned short, signed short);
-EXTERN unsigned short safeScale(unsigned short, unsigned short);
-
 EXTERN void sleep(unsigned short) FPAGE_FE;
 EXTERN void sleepMicro(unsigned short) FPAGE_FE;
 
@@ -65,7 +61,6 @@ EXTERN void resetToNonRunningState(void) FPAGE_F8;
 EXTERN void sampleEachADC(ADCArray*) FPAGE_F8;
 EXTERN void sampleLoopADC(ADCArray*) FPAGE_F8;
 
-EXTERN unsigned char checksum(unsigned char *, unsigned short) FPAGE_F8;
 EXTERN unsigned short stringCopy(unsigned char*, unsigned char*) FPAGE_F8;
 // In unpaged flash as it needs to compare paged flash with unpaged things
 EXTERN unsigned short compare(unsigned char*, unsigned char*, unsigned short);
@@ -49,6 +49,9 @@
 #include "inc/pagedLocationBuffers.h"
 #include "inc/init.h"
 #include "inc/DecoderInterface.h"
+#include "inc/tripleBuffer.h"
+#include "inc/tableBanks.h"
+#include "inc/sensorPipeline.h"
 #include "inc/xgateVectors.h"
 #include <string.h>
 
@@ -312,16 +315,14 @@ void initFuelAddresses() {
  */
 void initPagedRAMFuel(void) {
   /* Copy the tables from flash to RAM */
-  RPAGE = RPAGE_FUEL_ONE;
-  memcpy((void*)&TablesA,	VETableMainFlashLocation,		MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	VETableSecondaryFlashLocation,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	VETableTertiaryFlashLocation,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	LambdaTableFlashLocation,		MAINTABLE_SIZE);
-  RPAGE = RPAGE_FUEL_TWO;
-  memcpy((void*)&TablesA,	VETableMainFlash2Location,		MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	VETableSecondaryFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	VETableTertiaryFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	LambdaTableFlash2Location,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_ONE)->TablesA,	VETableMainFlashLocation,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_ONE)->TablesB,	VETableSecondaryFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_ONE)->TablesC,	VETableTertiaryFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_ONE)->TablesD,	LambdaTableFlashLocation,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_TWO)->TablesA,	VETableMainFlash2Location,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_TWO)->TablesB,	VETableSecondaryFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_TWO)->TablesC,	VETableTertiaryFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_FUEL_TWO)->TablesD,	LambdaTableFlash2Location,		MAINTABLE_SIZE);
 }
 
 
@@ -356,16 +357,14 @@ void initTimingAddresses() {
  */
 void initPagedRAMTime() {
   /* Copy the tables from flash to RAM */
-  RPAGE = RPAGE_TIME_ONE;
-  memcpy((void*)&TablesA,	IgnitionAdvanceTableMainFlashLocation,			MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	IgnitionAdvanceTableSecondaryFlashLocation,		MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	InjectionAdvanceTableMainFlashLocation,			MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	InjectionAdvanceTableSecondaryFlashLocation,	MAINTABLE_SIZE);
-  RPAGE = RPAGE_TIME_TWO;
-  memcpy((void*)&TablesA,	IgnitionAdvanceTableMainFlash2Location,			MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	IgnitionAdvanceTableSecondaryFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	InjectionAdvanceTableMainFlash2Location,		MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	InjectionAdvanceTableSecondaryFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_ONE)->TablesA,	IgnitionAdvanceTableMainFlashLocation,			MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_ONE)->TablesB,	IgnitionAdvanceTableSecondaryFlashLocation,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_ONE)->TablesC,	InjectionAdvanceTableMainFlashLocation,			MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_ONE)->TablesD,	InjectionAdvanceTableSecondaryFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_TWO)->TablesA,	IgnitionAdvanceTableMainFlash2Location,			MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_TWO)->TablesB,	IgnitionAdvanceTableSecondaryFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_TWO)->TablesC,	InjectionAdvanceTableMainFlash2Location,		MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TIME_TWO)->TablesD,	InjectionAdvanceTableSecondaryFlash2Location,	MAINTABLE_SIZE);
 }
 
 
@@ -409,6 +408,8 @@ void initTunableAddresses() {
   /* TablesB */
   perCylinderFuelTrimsLocation  = (void*)&SmallTablesBFlash.perCylinderFuelTrims;
   perCylinderFuelTrims2Location = (void*)&SmallTablesBFlash2.perCylinderFuelTrims;
+  coreVarsFilterFactorsLocation  = (void*)&SmallTablesBFlash.coreVarsFilterFactors;
+  coreVarsFilterFactors2Location = (void*)&SmallTablesBFlash2.coreVarsFilterFactors;
 
   /* TablesC */
   // TODO
@@ -434,16 +435,14 @@ void initTunableAddresses() {
  */
 void initPagedRAMTune() {
   /* Copy the tables from flash to RAM */
-  RPAGE = RPAGE_TUNE_ONE;
-  memcpy((void*)&TablesA,	SmallTablesAFlashLocation,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	SmallTablesBFlashLocation,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	SmallTablesCFlashLocation,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	SmallTablesDFlashLocation,	MAINTABLE_SIZE);
-  RPAGE = RPAGE_TUNE_TWO;
-  memcpy((void*)&TablesA,	SmallTablesAFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesB,	SmallTablesBFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesC,	SmallTablesCFlash2Location,	MAINTABLE_SIZE);
-  memcpy((void*)&TablesD,	SmallTablesDFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_ONE)->TablesA,	SmallTablesAFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_ONE)->TablesB,	SmallTablesBFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_ONE)->TablesC,	SmallTablesCFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_ONE)->TablesD,	SmallTablesDFlashLocation,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_TWO)->TablesA,	SmallTablesAFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_TWO)->TablesB,	SmallTablesBFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_TWO)->TablesC,	SmallTablesCFlash2Location,	MAINTABLE_SIZE);
+  memcpy((void*)&TABLE_PAGE(RPAGE_TUNE_TWO)->TablesD,	SmallTablesDFlash2Location,	MAINTABLE_SIZE);
 }
 
 
@@ -475,8 +474,8 @@ void initAllPagedAddresses() {
  *
  * Take the tables and config from flash up to RAM to allow live tuning.
  *
- * For the main tables and other paged config we need to adjust
- * the RPAGE value to the appropriate one before copying up.
+ * The main tables and other paged config are copied into the active bank of
+ * their RAM page, see tableBanks.h.
  *
  * This function is simply a delegator to the ones for each flash page. Each
  * one lives in the same paged space as the data it is copying up.
@@ -487,7 +486,8 @@ void initAllPagedRAM() {
   /* Setup the flash block pointers before copying flash to RAM using them */
   initAllPagedAddresses();
 
-  /*Copy the tables up to their paged RAM blocks through the window from flash*/
+  /* Copy the tables up to their paged RAM blocks from flash */
+  initTableBanks();
   initPagedRAMFuel();
   initPagedRAMTime();
   initPagedRAMTune();
@@ -505,41 +505,25 @@ void initVariables() {
   /* And the opposite for the other halves */
   //CoreVars = &CoreVars0;
   //DerivedVars = &DerivedVars0;
-  ADCArrays = &ADCArrays0;
-  ADCArraysRecord = &ADCArrays1;
   asyncADCArrays = &asyncADCArrays0;
   asyncADCArraysRecord = &asyncADCArrays1;
-  currentDwellMath = &currentDwell0;
-  currentDwellRealtime = &currentDwell1;
 
-  injectorMainPulseWidthsMath = injectorMainPulseWidths0;
-  injectorMainPulseWidthsRealtime = injectorMainPulseWidths1;
-  injectorStagedPulseWidthsMath = injectorStagedPulseWidths0;
-  injectorStagedPulseWidthsRealtime = injectorStagedPulseWidths1;
-
-  // TODO temp, remove
-  mathSampleTimeStamp = &ISRLatencyVars.mathSampleTimeStamp0;
-  // TODO temp, remove
-  mathSampleTimeStampRecord = &ISRLatencyVars.mathSampleTimeStamp1;
+  /* The main loop owns the first sensor snapshot until the engine position
+   * ISR publishes a fresh one */
+  tripleBufferInit(&sensorSnapshotBuffer);
+  unsigned char snapshot;
+  for (snapshot = 0; snapshot < 3; snapshot++) {
+    sensorSnapshots[snapshot].ADCBuffer = hal_adc_acquire();
+  }
+  ADCArrays = (ADCArray*)hal_adc_buffer(sensorSnapshots[sensorSnapshotBuffer.reading].ADCBuffer);
   // TODO temp, remove
-  RPM = &RPM0;
+  mathSampleTimeStamp = &sensorSnapshots[sensorSnapshotBuffer.reading].sampleTimeStamp;
   // TODO temp, remove
-  RPMRecord = &RPM1;
-
-  /* Setup the pointers to the registers for fueling use, this does NOT work if
-   * done in global.c, I still don't know why. */
-  injectorMainTimeRegisters[0] = TC2_ADDR;
-  injectorMainTimeRegisters[1] = TC3_ADDR;
-  injectorMainTimeRegisters[2] = TC4_ADDR;
-  injectorMainTimeRegisters[3] = TC5_ADDR;
-  injectorMainTimeRegisters[4] = TC6_ADDR;
-  injectorMainTimeRegisters[5] = TC7_ADDR;
-  injectorMainControlRegisters[0] = TCTL2_ADDR;
-  injectorMainControlRegisters[1] = TCTL2_ADDR;
-  injectorMainControlRegisters[2] = TCTL1_ADDR;
-  injectorMainControlRegisters[3] = TCTL1_ADDR;
-  injectorMainControlRegisters[4] = TCTL1_ADDR;
-  injectorMainControlRegisters[5] = TCTL1_ADDR;
+  RPM = &sensorSnapshots[sensorSnapshotBuffer.reading].RPM;
+
+  /* The ISRs own the first (empty) math result until the main loop publishes
+   * its first calculation */
+  tripleBufferInit(&mathResultBuffer);
 
   configuredBasicDatalogLength = maxBasicDatalogLength;
 
@@ -837,6 +821,9 @@ void initConfiguration() {
   /* The ADC range used to generate TPS percentage */
   TPSADCRange = fixedConfigs2.sensorRanges.TPSMaximumADC - fixedConfigs2.sensorRanges.TPSMinimumADC;
 
+  /* Pick the sensor, load and air flow conversions */
+  resolveSensorPipeline();
+
 
   /* Use like flags for now, just add one for each later */
   unsigned char cumulativeConfigErrors = 0;
@@ -42,8 +42,12 @@
 #include "inc/freeEMS.h"
 #include "inc/interrupts.h"
 #include "inc/injectionISRs.h"
+#include "inc/tripleBuffer.h"
+#include "inc/latencyChains.h"
+#include "inc/isrLatency.h"
 #include <hal/ems/freeems_hal.h>
 #include <hal/log.h>
+#include <ems/deferredLog.h>
 
 /* Staged control algorithms for PIT2 and PIT3 */
 /* Staged injection switch on timer */
@@ -87,6 +91,8 @@ void StagedOffISR(void) {
 
 /* Define the variables correctly for each channel then import the code */
 
+/* Only the channels selected at build time are generated, see channels.h */
+
 /* Channel 1 */
 #define INJECTOR_CHANNEL_NUMBER 0
 #define InjectorXISR Injector1ISR
@@ -100,6 +106,7 @@ void StagedOffISR(void) {
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
 
+#if INJECTION_CHANNELS > 1
 /* Channel 2 */
 #define INJECTOR_CHANNEL_NUMBER 1
 #define InjectorXISR Injector2ISR
@@ -112,7 +119,9 @@ void StagedOffISR(void) {
 #undef STAGEDXOFF
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
+#endif
 
+#if INJECTION_CHANNELS > 2
 /* Channel 3 */
 #define INJECTOR_CHANNEL_NUMBER 2
 #define InjectorXISR Injector3ISR
@@ -125,7 +134,9 @@ void StagedOffISR(void) {
 #undef STAGEDXOFF
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
+#endif
 
+#if INJECTION_CHANNELS > 3
 /* Channel 4 */
 #define INJECTOR_CHANNEL_NUMBER 3
 #define InjectorXISR Injector4ISR
@@ -138,7 +149,9 @@ void StagedOffISR(void) {
 #undef STAGEDXOFF
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
+#endif
 
+#if INJECTION_CHANNELS > 4
 /* Channel 5 */
 #define INJECTOR_CHANNEL_NUMBER 4
 #define InjectorXISR Injector5ISR
@@ -151,7 +164,9 @@ void StagedOffISR(void) {
 #undef STAGEDXOFF
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
+#endif
 
+#if INJECTION_CHANNELS > 5
 /* Channel 6 */
 #define INJECTOR_CHANNEL_NUMBER 5
 #define InjectorXISR Injector6ISR
@@ -164,6 +179,94 @@ void StagedOffISR(void) {
 #undef STAGEDXOFF
 #undef STAGEDXON
 #undef INJECTOR_CHANNEL_NUMBER
+#endif
+
+#if INJECTION_CHANNELS > 6
+/* Channel 7 */
+#define INJECTOR_CHANNEL_NUMBER 6
+#define InjectorXISR Injector7ISR
+#define InjectorXISR_wrapped Injector7ISR_wrapped
+#define STAGEDXOFF STAGED7OFF
+#define STAGEDXON STAGED7ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
+
+#if INJECTION_CHANNELS > 7
+/* Channel 8 */
+#define INJECTOR_CHANNEL_NUMBER 7
+#define InjectorXISR Injector8ISR
+#define InjectorXISR_wrapped Injector8ISR_wrapped
+#define STAGEDXOFF STAGED8OFF
+#define STAGEDXON STAGED8ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
+
+#if INJECTION_CHANNELS > 8
+/* Channel 9 */
+#define INJECTOR_CHANNEL_NUMBER 8
+#define InjectorXISR Injector9ISR
+#define InjectorXISR_wrapped Injector9ISR_wrapped
+#define STAGEDXOFF STAGED9OFF
+#define STAGEDXON STAGED9ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
 
-/* If switching to 8 OC channels with non-IC engine input, place two more sets
- * of defines here :-) (along with all the other mods needed of course) */
+#if INJECTION_CHANNELS > 9
+/* Channel 10 */
+#define INJECTOR_CHANNEL_NUMBER 9
+#define InjectorXISR Injector10ISR
+#define InjectorXISR_wrapped Injector10ISR_wrapped
+#define STAGEDXOFF STAGED10OFF
+#define STAGEDXON STAGED10ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
+
+#if INJECTION_CHANNELS > 10
+/* Channel 11 */
+#define INJECTOR_CHANNEL_NUMBER 10
+#define InjectorXISR Injector11ISR
+#define InjectorXISR_wrapped Injector11ISR_wrapped
+#define STAGEDXOFF STAGED11OFF
+#define STAGEDXON STAGED11ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
+
+#if INJECTION_CHANNELS > 11
+/* Channel 12 */
+#define INJECTOR_CHANNEL_NUMBER 11
+#define InjectorXISR Injector12ISR
+#define InjectorXISR_wrapped Injector12ISR_wrapped
+#define STAGEDXOFF STAGED12OFF
+#define STAGEDXON STAGED12ON
+#include "inc/injectorISR.c"
+#undef InjectorXISR
+#undef InjectorXISR_wrapped
+#undef STAGEDXOFF
+#undef STAGEDXON
+#undef INJECTOR_CHANNEL_NUMBER
+#endif
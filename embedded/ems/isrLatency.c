@@ -0,0 +1,81 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file isrLatency.c
+ * @brief Histograms of the interrupt latencies
+ *
+ * See isrLatency.h for the sources and buckets.
+ */
+
+#define ISRLATENCY_C
+#include "inc/freeEMS.h"
+#include "inc/commsCore.h"
+#include "inc/isrLatency.h"
+#include "inc/histogram.h"
+#include <hal/ems/freeems_hal.h>
+#include <string.h>
+
+
+/** @brief Count one latency of a source, ISRs only
+ *
+ * Runs in constant time, see histogram.h for the buckets.
+ *
+ * @param source is one of the ISR_LATENCY_ sources.
+ * @param latency is the time from the event to the start of the ISR.
+ */
+void isrLatencyRecord(unsigned char source, unsigned short latency) {
+  isrLatencyHistogram* histogram = &isrLatencyHistograms[source];
+  histogramCount(histogram->buckets, ISR_LATENCY_BUCKETS, latency);
+  if(histogram->count != 0xFFFF) {
+    histogram->count++;
+  }
+  if(latency > histogram->max) {
+    histogram->max = latency;
+  }
+}
+
+
+/** @brief Populate an ISR latency histogram packet
+ *
+ * Writes the source and its histogram at TXBufferCurrentPositionHandler.
+ *
+ * @param source is one of the ISR_LATENCY_ sources.
+ * @param clear is nonzero to start the histogram over once it is copied.
+ *
+ * @return the length of the payload written
+ */
+unsigned short populateISRLatencyHistogram(unsigned char source, unsigned char clear) {
+  unsigned char* start = TXBufferCurrentPositionHandler;
+  isrLatencyHistogram histogram;
+
+  ATOMIC_START();
+  histogram = isrLatencyHistograms[source];
+  if(clear) {
+    memset(&isrLatencyHistograms[source], 0, sizeof(isrLatencyHistogram));
+  }
+  ATOMIC_END();
+
+  *TXBufferCurrentPositionHandler++ = source;
+  memcpy(TXBufferCurrentPositionHandler, &histogram, sizeof(isrLatencyHistogram));
+  TXBufferCurrentPositionHandler += sizeof(isrLatencyHistogram);
+
+  return TXBufferCurrentPositionHandler - start;
+}
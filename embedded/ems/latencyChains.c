@@ -0,0 +1,153 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file latencyChains.c
+ * @brief Edge to actuation latency of every injection and ignition event
+ *
+ * See latencyChains.h for the meaning of the stages and buckets.
+ */
+
+#define LATENCYCHAINS_C
+#include "inc/freeEMS.h"
+#include "inc/commsCore.h"
+#include "inc/latencyChains.h"
+#include "inc/histogram.h"
+#include <hal/ems/freeems_hal.h>
+#include <string.h>
+
+
+/** @brief Open the chain of a scheduled event, ISRs only
+ *
+ * A chain that is still open for the channel is dropped, its output never
+ * switched.
+ *
+ * @param kind is one of the LATENCY_ event kinds.
+ * @param channel is the output channel of the event.
+ * @param edge is the time stamp of the tooth edge the event is scheduled from.
+ * @param entry is the time the decoder ISR started running.
+ * @param due is the time the output should switch.
+ * @param programmed is nonzero if the output timer was programmed just now,
+ *        zero if the event waits in a queue until latencyChainProgrammed().
+ */
+void latencyChainOpen(unsigned char kind, unsigned char channel, uint32_t edge,
+                      uint32_t entry, uint32_t due, unsigned char programmed) {
+  if((kind >= LATENCY_KINDS) || (channel >= EMS_CHANNELS)) {
+    return;
+  }
+  latencyChain* chain = &latencyChains[kind][channel];
+  chain->edge = edge;
+  chain->entry = entry;
+  chain->due = due;
+  if(programmed) {
+    chain->programmed = hal_timer_time_get32();
+    chain->state = LATENCY_CHAIN_ARMED;
+  }
+  else {
+    chain->state = LATENCY_CHAIN_QUEUED;
+  }
+}
+
+
+/** @brief Note that a queued event got its output timer programmed, ISRs only
+ *
+ * @param kind is one of the LATENCY_ event kinds.
+ * @param channel is the output channel of the event.
+ */
+void latencyChainProgrammed(unsigned char kind, unsigned char channel) {
+  if((kind >= LATENCY_KINDS) || (channel >= EMS_CHANNELS)) {
+    return;
+  }
+  latencyChain* chain = &latencyChains[kind][channel];
+  if(chain->state == LATENCY_CHAIN_QUEUED) {
+    chain->programmed = hal_timer_time_get32();
+    chain->state = LATENCY_CHAIN_ARMED;
+  }
+}
+
+
+/** @brief Close the chain of an event whose output just switched, ISRs only
+ *
+ * Outputs without an armed chain, e.g. those scheduled before a reset of the
+ * histograms, are ignored.
+ *
+ * @param kind is one of the LATENCY_ event kinds.
+ * @param channel is the output channel of the event.
+ * @param actual is the time the output switched.
+ */
+void latencyChainClose(unsigned char kind, unsigned char channel, uint32_t actual) {
+  if((kind >= LATENCY_KINDS) || (channel >= EMS_CHANNELS)) {
+    return;
+  }
+  latencyChain* chain = &latencyChains[kind][channel];
+  if(chain->state != LATENCY_CHAIN_ARMED) {
+    return;
+  }
+  chain->state = LATENCY_CHAIN_IDLE;
+
+  latencyHistogram* histogram = &latencyHistograms[kind][channel];
+  if(histogram->events != 0xFFFF) {
+    histogram->events++;
+  }
+  histogramCount(histogram->buckets[LATENCY_STAGE_ENTRY], LATENCY_BUCKETS, chain->entry - chain->edge);
+  histogramCount(histogram->buckets[LATENCY_STAGE_PROGRAMMED], LATENCY_BUCKETS, chain->programmed - chain->edge);
+  histogramCount(histogram->buckets[LATENCY_STAGE_TOTAL], LATENCY_BUCKETS, actual - chain->edge);
+
+  uint32_t error = actual - chain->due;
+  if(error > LONGHALF) {
+    if(histogram->early != 0xFFFF) {
+      histogram->early++;
+    }
+  }
+  else {
+    histogramCount(histogram->buckets[LATENCY_STAGE_ERROR], LATENCY_BUCKETS, error);
+  }
+}
+
+
+/** @brief Populate a latency histogram packet
+ *
+ * Writes the kind, the channel and the histogram of that channel at
+ * TXBufferCurrentPositionHandler.
+ *
+ * @param kind is one of the LATENCY_ event kinds.
+ * @param channel is the output channel.
+ * @param clear is nonzero to start the histogram over once it is copied.
+ *
+ * @return the length of the payload written
+ */
+unsigned short populateLatencyHistogram(unsigned char kind, unsigned char channel, unsigned char clear) {
+  unsigned char* start = TXBufferCurrentPositionHandler;
+  latencyHistogram histogram;
+
+  ATOMIC_START();
+  histogram = latencyHistograms[kind][channel];
+  if(clear) {
+    memset(&latencyHistograms[kind][channel], 0, sizeof(latencyHistogram));
+  }
+  ATOMIC_END();
+
+  *TXBufferCurrentPositionHandler++ = kind;
+  *TXBufferCurrentPositionHandler++ = channel;
+  memcpy(TXBufferCurrentPositionHandler, &histogram, sizeof(latencyHistogram));
+  TXBufferCurrentPositionHandler += sizeof(latencyHistogram);
+
+  return TXBufferCurrentPositionHandler - start;
+}
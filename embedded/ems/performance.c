@@ -0,0 +1,117 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file performance.c
+ * @brief Output of the performance measurements
+ *
+ * The ISRs only store their measurements, formatting and output happen in the
+ * main loop, so the output does not add to the measured times. The lines
+ * printed are the ones the wrappers used to print, followed by the time stamp
+ * of the end of the ISR, see doc/log-format.txt. The totals of the profiling
+ * regions are printed from the main loop as well.
+ */
+
+#include <hal/ems/freeems_hal.h>
+#include <hal/log.h>
+#include <ems/performance.h>
+#include <ems/barrier.h>
+
+#ifdef __PERF__
+
+perf_record_t perf_ring[PERF_RING_LENGTH];
+volatile unsigned short perf_ring_head;
+volatile unsigned short perf_ring_tail;
+volatile unsigned int perf_ring_overflows;
+
+static unsigned int perf_ring_overflows_reported;
+
+
+/* Not every perf_printf knows %llu, the gprintf of nios2 does not */
+static const char* perf_u64_string(uint64_t value, char* end) {
+  *end = '\0';
+  do {
+    *--end = '0' + (char)(value % 10);
+    value /= 10;
+  } while (value != 0);
+  return end;
+}
+
+
+void perf_ring_output(void) {
+  unsigned short tail = perf_ring_tail;
+  unsigned short head = perf_ring_head;
+  COMPILER_BARRIER();
+
+  while (tail != head) {
+    const perf_record_t* record = &perf_ring[tail & PERF_RING_MASK];
+    char digits[12];
+    const char* nested = "";
+    /* Only measurements that were preempted by others carry a second time */
+    if (record->inclusive != record->cycles) {
+      char* start = (char*)perf_u64_string(record->inclusive, &digits[11]);
+      *--start = '/';
+      nested = start;
+    }
+    if (record->path != 0) {
+      perf_printf("*%s%c%u%s@%lu\r\n", record->id, record->path,
+                  record->cycles, nested, (unsigned long)record->timeStamp);
+    } else {
+      perf_printf("*%s%u%s@%lu\r\n", record->id, record->cycles, nested,
+                  (unsigned long)record->timeStamp);
+    }
+    tail++;
+    COMPILER_BARRIER();
+    perf_ring_tail = tail;
+  }
+
+  unsigned int overflows = perf_ring_overflows;
+  if (overflows != perf_ring_overflows_reported) {
+    perf_printf("**PerfOverflow %u\r\n", overflows);
+    perf_ring_overflows_reported = overflows;
+  }
+}
+
+
+void perf_region_output(void) {
+  static const char* const names[PERF_REGIONS] = PERF_REGION_NAMES;
+  uint64_t cycles[PERF_REGIONS];
+  uint32_t entries[PERF_REGIONS];
+  bool counted[PERF_REGIONS];
+  uint8_t region;
+
+  ATOMIC_START();
+  for (region = PERF_REGION_NONE + 1; region < PERF_REGIONS; region++) {
+    counted[region] = hal_performance_regionRead(region, &cycles[region],
+                      &entries[region]);
+  }
+  ATOMIC_END();
+
+  for (region = PERF_REGION_NONE + 1; region < PERF_REGIONS; region++) {
+    if (counted[region]) {
+      char digits[21];
+      perf_printf("**Region %s %s %lu\r\n", names[region],
+                  perf_u64_string(cycles[region], &digits[20]),
+                  (unsigned long)entries[region]);
+    }
+  }
+}
+
+#endif // __PERF__
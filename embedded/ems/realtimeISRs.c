@@ -69,7 +69,7 @@ void RTIISR_wrapped()
 #else
 void RTIISR()
 #endif // __PERF__*/
-PERF_WRAP_PATH(RTIISR, "rt") {
+PERF_WRAP_PATH(RTIISR, "rt", PERF_REGION_RTI) {
 //void RTIISR() {
   PERF_PATH_INIT('x');
   /* Record time stamp for code run time reporting */
@@ -97,8 +97,8 @@ PERF_WRAP_PATH(RTIISR, "rt") {
     Clocks.timeoutADCreadingClock++;
     if(Clocks.timeoutADCreadingClock > fixedConfigs2.sensorSettings.readingTimeout) {
       PERF_PATH_SET('b');
-      /* Set force read adc flag */
-      coreStatusA |= FORCE_READING;
+      /* Request a forced adc reading from the main loop */
+      forcedReadingRequests++;
       Clocks.timeoutADCreadingClock = 0;
     }
 
@@ -0,0 +1,487 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file sensorPipeline.c
+ * @ingroup measurementsAndCalculations
+ *
+ * @brief Configurable sensor, load and air flow conversions
+ *
+ * Each core variable read from a sensor has a small set of conversion routines,
+ * one per supported source. resolveSensorPipeline() picks one per variable
+ * according to fixedConfigs2.sensorSources, falling back to a fail safe routine
+ * that also reports the problem if the configured source is not supported.
+ *
+ * <h> original author</h> Fred Cooke
+ * @author Andreas Meixner, Claudius Heine,
+ * Florian Kluge <kluge@informatik.uni-augsburg.de>
+ *
+ * This file is based on the original FreeEMS 0.1.1 code by Fred Cooke.
+ */
+
+#define SENSORPIPELINE_C
+#include "inc/freeEMS.h"
+#include "inc/commsCore.h"
+#include "inc/sensorPipeline.h"
+#include <stddef.h>
+
+
+/* Number of SOURCE_* values */
+#define SENSOR_SOURCE_COUNT (SOURCE_NONE + 1)
+/* Position of a core variable within CoreVar */
+#define CORE_VAR_INDEX(var) (offsetof(CoreVar, var) / CORE_VARS_UNIT)
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& BRV &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get BRV from ADC using transfer variables */
+static unsigned short BRVFromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->BRV * fixedConfigs2.sensorRanges.BRVRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.BRVMinimum;
+}
+
+static unsigned short BRVFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetBRV;
+}
+
+static unsigned short BRVFailSafe(const CoreVar* readings) {
+  /* If anyone is listening, let them know something is wrong */
+  sendErrorIfClear(BRV_NOT_CONFIGURED_CODE);
+  /* Default to normal alternator charging voltage 14.4V */
+  return runningVoltage;
+}
+
+static const sensorConversion BRVConversions[SENSOR_SOURCE_COUNT] = {
+  BRVFromPreset, BRVFromSensor, 0, 0, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& CHT &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get CHT from ADC using the transfer table */
+static unsigned short CHTFromSensor(const CoreVar* readings) {
+  return CHTTransferTable[ADCArrays->CHT];
+}
+
+/* Transfer the ADC reading to an engine temperature in a reasonable way */
+/* 0 ADC = 0C = 273.15K = 27315, 1023 ADC = 102.3C = 375.45K = 37545 */
+static unsigned short CHTFromDashpot(const CoreVar* readings) {
+  return (ADCArrays->CHT * 10) + freezingPoint;
+}
+
+static unsigned short CHTFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetCHT;
+}
+
+static unsigned short CHTFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(CHT_NOT_CONFIGURED_CODE);
+  /* Default to normal running temperature of 85C/358K */
+  return runningTemperature;
+}
+
+static const sensorConversion CHTConversions[SENSOR_SOURCE_COUNT] = {
+  CHTFromPreset, CHTFromSensor, CHTFromDashpot, 0, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& IAT &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get IAT from ADC using the transfer table. Configure the preset instead to
+ * default to room temp, useful with heatsoaked OEM sensors like the Volvo's */
+static unsigned short IATFromSensor(const CoreVar* readings) {
+  return IATTransferTable[ADCArrays->IAT];
+}
+
+/* 0 ADC = 0C = 273.15K = 27315, 1023 ADC = 102.3C = 375.45K = 37545 */
+static unsigned short IATFromDashpot(const CoreVar* readings) {
+  return (ADCArrays->IAT * 10) + freezingPoint;
+}
+
+static unsigned short IATFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetIAT;
+}
+
+static unsigned short IATFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(IAT_NOT_CONFIGURED_CODE);
+  /* Default to normal air temperature of 20C/293K */
+  return roomTemperature;
+}
+
+static const sensorConversion IATConversions[SENSOR_SOURCE_COUNT] = {
+  IATFromPreset, IATFromSensor, IATFromDashpot, 0, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& MAT &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get MAT from ADC using same transfer table as IAT (too much space to waste on
+ * having two) */
+static unsigned short MATFromSensor(const CoreVar* readings) {
+  return IATTransferTable[ADCArrays->MAT];
+}
+
+static unsigned short MATFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetMAT;
+}
+
+/* Same value as IAT */
+static unsigned short MATFromIAT(const CoreVar* readings) {
+  return readings->IAT;
+}
+
+static unsigned short MATFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(MAT_NOT_CONFIGURED_CODE);
+  return readings->IAT;
+}
+
+static const sensorConversion MATConversions[SENSOR_SOURCE_COUNT] = {
+  MATFromPreset, MATFromSensor, 0, MATFromIAT, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& MAP &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get MAP from ADC using transfer variables */
+static unsigned short MAPFromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->MAP * fixedConfigs2.sensorRanges.MAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.MAPMinimum;
+}
+
+/* Get MAP from ADC via conversion to internal kPa figure where
+ * 1023ADC = 655kPa */
+static unsigned short MAPFromDashpot(const CoreVar* readings) {
+  return ADCArrays->MAP << 6;
+}
+
+/* Imitate a MAP signal from the TPS ADC reading */
+static unsigned short MAPFromTPS(const CoreVar* readings) {
+  return (((unsigned long)boundedTPSADC * TPSMAPRange) / TPSADCRange) + fixedConfigs2.sensorRanges.TPSClosedMAP;
+}
+
+static unsigned short MAPFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetMAP;
+}
+
+static unsigned short MAPFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(MAP_NOT_CONFIGURED_CODE);
+  /* Default to zero to nulify all other calcs and effectively cut fuel */
+  return 0;
+}
+
+static const sensorConversion MAPConversions[SENSOR_SOURCE_COUNT] = {
+  MAPFromPreset, MAPFromSensor, MAPFromDashpot, MAPFromTPS, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& IAP &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get IAP from ADC using the same transfer variables as MAP as they both need
+ * to read the same range */
+static unsigned short IAPFromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->IAP * fixedConfigs2.sensorRanges.MAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.MAPMinimum;
+}
+
+/* 1023ADC = 655kPa */
+static unsigned short IAPFromDashpot(const CoreVar* readings) {
+  return ADCArrays->IAP << 6;
+}
+
+static unsigned short IAPFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetIAP;
+}
+
+static unsigned short IAPFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(IAP_NOT_CONFIGURED_CODE);
+  /* No boost */
+  return seaLevelKPa;
+}
+
+static const sensorConversion IAPConversions[SENSOR_SOURCE_COUNT] = {
+  IAPFromPreset, IAPFromSensor, IAPFromDashpot, 0, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& MAF &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+static unsigned short MAFFromSensor(const CoreVar* readings) {
+  return MAFTransferTable[ADCArrays->MAF];
+}
+
+/* Not required for anything except main PW calcs optionally */
+static unsigned short MAFNotFitted(const CoreVar* readings) {
+  return 0;
+}
+
+static const sensorConversion MAFConversions[SENSOR_SOURCE_COUNT] = {
+  0, MAFFromSensor, 0, 0, 0, MAFNotFitted
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& AAP &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get AAP from ADC using separate vars to allow 115kPa sensor etc to be used */
+static unsigned short AAPFromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->AAP * fixedConfigs2.sensorRanges.AAPRange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.AAPMinimum;
+}
+
+/* Get AAP from ADC via conversion to internal kPa figure where
+ * 1023ADC = 102.3kPa */
+static unsigned short AAPFromDashpot(const CoreVar* readings) {
+  return ADCArrays->AAP * 10;
+}
+
+/* Get the AAP reading as saved during startup */
+static unsigned short AAPFromBootTime(const CoreVar* readings) {
+  return bootTimeAAP;
+}
+
+static unsigned short AAPFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetAAP;
+}
+
+static unsigned short AAPFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(AAP_NOT_CONFIGURED_CODE);
+  /* Default to sea level */
+  return seaLevelKPa;
+}
+
+static const sensorConversion AAPConversions[SENSOR_SOURCE_COUNT] = {
+  AAPFromPreset, AAPFromSensor, AAPFromDashpot, 0, AAPFromBootTime, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& EGO &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get EGO from ADCs using transfer variables */
+static unsigned short EGOFromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->EGO * fixedConfigs2.sensorRanges.EGORange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.EGOMinimum;
+}
+
+static unsigned short EGOFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetEGO;
+}
+
+static unsigned short EGOFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(EGO_NOT_CONFIGURED_CODE);
+  /* Default to stoichiometric */
+  return stoichiometricLambda; /* EGO / 32768 = Lambda */
+}
+
+static const sensorConversion EGOConversions[SENSOR_SOURCE_COUNT] = {
+  EGOFromPreset, EGOFromSensor, 0, 0, 0, 0
+};
+
+
+/* Get EGO2 from ADCs using same transfer variables as EGO */
+static unsigned short EGO2FromSensor(const CoreVar* readings) {
+  return (((unsigned long)ADCArrays->EGO2 * fixedConfigs2.sensorRanges.EGORange) / ADC_DIVISIONS) + fixedConfigs2.sensorRanges.EGOMinimum;
+}
+
+static unsigned short EGO2FromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetEGO2;
+}
+
+static unsigned short EGO2FailSafe(const CoreVar* readings) {
+  sendErrorIfClear(EGO2_NOT_CONFIGURED_CODE);
+  return stoichiometricLambda;
+}
+
+static const sensorConversion EGO2Conversions[SENSOR_SOURCE_COUNT] = {
+  EGO2FromPreset, EGO2FromSensor, 0, 0, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& TPS &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+/* Get TPS from ADC no need to add TPS min as we know it is zero by definition */
+static unsigned short TPSFromSensor(const CoreVar* readings) {
+  return ((unsigned long)boundedTPSADC * TPS_RANGE_MAX) / TPSADCRange;
+}
+
+/* Get TPS from ADC as shown : 1023 ADC = 100%, 0 ADC = 0% */
+static unsigned short TPSFromDashpot(const CoreVar* readings) {
+  return ((unsigned long)ADCArrays->TPS * TPS_RANGE_MAX) / ADC_DIVISIONS;
+}
+
+/* Imitate a TPS signal from MAP, boxed to the configured MAP range */
+static unsigned short TPSFromMAP(const CoreVar* readings) {
+  unsigned short MAP = readings->MAP;
+  if(MAP > fixedConfigs2.sensorRanges.TPSOpenMAP) {
+    /* Greater than ~95kPa */
+    return TPS_RANGE_MAX; /* 64000/640 = 100% */
+  }
+  else
+    if(MAP < fixedConfigs2.sensorRanges.TPSClosedMAP) {
+      /* Less than ~30kPa */
+      return 0;
+    }
+    else { /* Scale MAP range to TPS range */
+      return ((unsigned long)(MAP - fixedConfigs2.sensorRanges.TPSClosedMAP) * TPS_RANGE_MAX) / TPSMAPRange;
+    }
+}
+
+static unsigned short TPSFromPreset(const CoreVar* readings) {
+  return fixedConfigs2.sensorPresets.presetTPS;
+}
+
+static unsigned short TPSFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(TPS_NOT_CONFIGURED_CODE);
+  /* Default to 50% to not trigger any WOT or CT conditions */
+  return halfThrottle;
+}
+
+static const sensorConversion TPSConversions[SENSOR_SOURCE_COUNT] = {
+  TPSFromPreset, TPSFromSensor, TPSFromDashpot, TPSFromMAP, 0, 0
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& Load &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+static unsigned short loadFromMAP(const CoreVar* readings) {
+  return readings->MAP;
+}
+
+static unsigned short loadFromTPS(const CoreVar* readings) {
+  return readings->TPS;
+}
+
+static unsigned short loadFromAAPCorrectedMAP(const CoreVar* readings) {
+  return ((unsigned long)readings->MAP * readings->AAP) / seaLevelKPa;
+}
+
+static unsigned short loadFailSafe(const CoreVar* readings) {
+  sendErrorIfClear(LOAD_NOT_CONFIGURED_CODE);
+  /* Default to MAP */
+  return readings->MAP;
+}
+
+static const sensorConversion loadConversions[] = {
+  loadFromMAP, loadFromTPS, loadFromAAPCorrectedMAP
+};
+
+
+/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& Air flow &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+
+static unsigned short airFlowFromSpeedDensity(unsigned short* airInletTemp) {
+  /* This won't overflow until 512kPa or about 60psi of boost with 128% VE. */
+  return ((unsigned long)CoreVars->MAP * DerivedVars->VEMain) / oneHundredPercentVE;
+  /* Result is 450 - 65535 always. */
+}
+
+/* Not actually VE, but rather tuned air flow without density information */
+static unsigned short airFlowFromAlphaN(unsigned short* airInletTemp) {
+  return DerivedVars->VEMain;
+}
+
+static unsigned short airFlowFromMAF(unsigned short* airInletTemp) {
+  /* Just fix temperature at appropriate level to provide correct Lambda */
+  /// @todo TODO figure out what the correct "temperature" is to make MAF work
+  ///       correctly!
+  // 293.15k is 20c * 100 to get value, so divide by 100 to get real number
+  *airInletTemp = roomTemperature;
+  return CoreVars->MAF;
+}
+
+/* Fixed air flow from config */
+static unsigned short airFlowFromPreset(unsigned short* airInletTemp) {
+  return fixedConfigs2.sensorPresets.presetAF;
+}
+
+static unsigned short airFlowFailSafe(unsigned short* airInletTemp) {
+  sendErrorIfClear(AIRFLOW_NOT_CONFIGURED_CODE);
+  /* Default to no fuel delivery */
+  return 0;
+}
+
+static const airFlowConverter airFlowConversions[] = {
+  airFlowFromSpeedDensity, airFlowFromAlphaN, airFlowFromMAF, airFlowFromPreset
+};
+
+
+/** @brief Pick the conversion for one pipeline stage
+ *
+ * @param stage position in the pipeline
+ * @param index destination within CoreVar
+ * @param source configured SOURCE_* value
+ * @param conversions supported conversions indexed by source, 0 if unsupported
+ * @param failSafe used if the source is not supported
+ */
+static void resolveStage(unsigned char stage, unsigned char index, unsigned char source, const sensorConversion* conversions, sensorConversion failSafe) {
+  sensorPipeline[stage].index = index;
+  if((source < SENSOR_SOURCE_COUNT) && (conversions[source] != 0)) {
+    sensorPipeline[stage].convert = conversions[source];
+  }
+  else {
+    sensorPipeline[stage].convert = failSafe;
+  }
+}
+
+
+/** @brief Resolve the configured sensor sources
+ *
+ * Fills the sensor pipeline and the load and air flow conversions from
+ * fixedConfigs2.sensorSources. Must be called at init and again whenever fixed
+ * config 2 has been replaced.
+ *
+ * The stage order matters: MAT may be taken from IAT and TPS from MAP.
+ */
+void resolveSensorPipeline() {
+  resolveStage(0, CORE_VAR_INDEX(BRV), fixedConfigs2.sensorSources.BRVSource, BRVConversions, BRVFailSafe);
+  resolveStage(1, CORE_VAR_INDEX(CHT), fixedConfigs2.sensorSources.CHTSource, CHTConversions, CHTFailSafe);
+  resolveStage(2, CORE_VAR_INDEX(IAT), fixedConfigs2.sensorSources.IATSource, IATConversions, IATFailSafe);
+  resolveStage(3, CORE_VAR_INDEX(MAT), fixedConfigs2.sensorSources.MATSource, MATConversions, MATFailSafe);
+  resolveStage(4, CORE_VAR_INDEX(MAP), fixedConfigs2.sensorSources.MAPSource, MAPConversions, MAPFailSafe);
+  resolveStage(5, CORE_VAR_INDEX(IAP), fixedConfigs2.sensorSources.IAPSource, IAPConversions, IAPFailSafe);
+  resolveStage(6, CORE_VAR_INDEX(MAF), fixedConfigs2.sensorSources.MAFSource, MAFConversions, MAFNotFitted);
+  resolveStage(7, CORE_VAR_INDEX(AAP), fixedConfigs2.sensorSources.AAPSource, AAPConversions, AAPFailSafe);
+  resolveStage(8, CORE_VAR_INDEX(EGO), fixedConfigs2.sensorSources.EGOSource, EGOConversions, EGOFailSafe);
+  resolveStage(9, CORE_VAR_INDEX(EGO2), fixedConfigs2.sensorSources.EGO2Source, EGO2Conversions, EGO2FailSafe);
+  resolveStage(10, CORE_VAR_INDEX(TPS), fixedConfigs2.sensorSources.TPSSource, TPSConversions, TPSFailSafe);
+
+  unsigned char loadSource = fixedConfigs2.sensorSources.loadSource;
+  if(loadSource < (sizeof(loadConversions) / sizeof(loadConversions[0]))) {
+    loadConversion = loadConversions[loadSource];
+  }
+  else {
+    loadConversion = loadFailSafe;
+  }
+
+  unsigned char airFlowSource = fixedConfigs2.sensorSources.airFlowSource;
+  if(airFlowSource < (sizeof(airFlowConversions) / sizeof(airFlowConversions[0]))) {
+    airFlowConversion = airFlowConversions[airFlowSource];
+  }
+  else {
+    airFlowConversion = airFlowFailSafe;
+  }
+}
+
+
+/** @brief Run the sensor pipeline
+ *
+ * Converts the current ADC readings into the sensor based core variables in
+ * readings. All other members of readings are left untouched.
+ *
+ * @param readings destination for the converted values
+ */
+void runSensorPipeline(CoreVar* readings) {
+  unsigned short* readingsArray = (unsigned short*)readings;
+  unsigned char stage;
+  for(stage = 0; stage < SENSOR_PIPELINE_LENGTH; stage++) {
+    readingsArray[sensorPipeline[stage].index] = sensorPipeline[stage].convert(readings);
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file tableBanks.c
+ * @brief A/B banks for the tables in RAM
+ *
+ * Replaces the RPAGE window of the original code. See tableBanks.h for the
+ * rules of use.
+ */
+
+#define TABLEBANKS_C
+#include "inc/freeEMS.h"
+#include "inc/tableBanks.h"
+#include <ems/barrier.h>
+#include <string.h>
+
+
+/* One bit per page, set while the inactive bank lacks the last edit */
+static unsigned char staleBanks;
+
+
+/** @brief Get the bank of a page that is not read by the calculations */
+static inline tablePage* inactiveBank(unsigned char index) {
+  if(activeTablePages[index] == &tablePageBanks[index][0]) {
+    return &tablePageBanks[index][1];
+  }
+  return &tablePageBanks[index][0];
+}
+
+
+/** @brief Set up the table banks
+ *
+ * Makes the first bank of each page active. The second banks are filled from
+ * the first ones on their first edit, so the pages can be loaded through
+ * TABLE_PAGE() after this.
+ */
+void initTableBanks() {
+  unsigned char index;
+  for(index = 0; index < TABLE_PAGES; index++) {
+    activeTablePages[index] = &tablePageBanks[index][0];
+  }
+  staleBanks = (1 << TABLE_PAGES) - 1;
+}
+
+
+/** @brief Start an edit of a table page
+ *
+ * Brings the inactive bank of the page up to date if required and translates
+ * an address within the active bank into the same spot in the inactive one.
+ * Any number of changes may be made there before tableBankCommit() is called.
+ *
+ * @param RAMPage is the RPAGE value of the page to edit.
+ * @param liveAddress is an address within the active bank of that page, as
+ *        given by TABLE_PAGE() or lookupBlockDetails().
+ *
+ * @return The address to write to instead.
+ */
+void* tableBankEditAddress(unsigned char RAMPage, void* liveAddress) {
+  unsigned char index = RAMPage - RPAGE_MIN;
+  tablePage* live = activeTablePages[index];
+  tablePage* shadow = inactiveBank(index);
+
+  if(staleBanks & (1 << index)) {
+    memcpy(shadow, live, sizeof(tablePage));
+    staleBanks &= ~(1 << index);
+  }
+
+  return (unsigned char*)shadow + ((unsigned char*)liveAddress - (unsigned char*)live);
+}
+
+
+/** @brief Make the edits of a table page live
+ *
+ * @param RAMPage is the RPAGE value of the page edited.
+ */
+void tableBankCommit(unsigned char RAMPage) {
+  unsigned char index = RAMPage - RPAGE_MIN;
+  tablePage* shadow = inactiveBank(index);
+  COMPILER_BARRIER();
+  activeTablePages[index] = shadow;
+  staleBanks |= 1 << index;
+}
+
+
+/** @brief Throw away the edits of a table page
+ *
+ * For an edit that failed part way. The inactive bank is copied from the
+ * active one again when the next edit of that page starts.
+ *
+ * @param RAMPage is the RPAGE value of the page edited.
+ */
+void tableBankDiscard(unsigned char RAMPage) {
+  staleBanks |= 1 << (RAMPage - RPAGE_MIN);
+}
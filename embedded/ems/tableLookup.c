@@ -35,28 +35,13 @@
 #include "inc/freeEMS.h"
 #include "inc/commsISRs.h"
 #include "inc/tableLookup.h"
+#include "inc/tableBanks.h"
 #include "inc/pagedLocationBuffers.h"
 
 
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&& ******* ******* ******* &&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&& ******* WARNING ******* &&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&& ******* ******* ******* &&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&                                                               &&&&&&*/
-/*&&&&&&& These routines rely on the fact that there are no ISRs trying &&&&&&*/
-/*&&&&&&& to access the small tables and other live settings in the ram &&&&&&*/
-/*&&&&&&& window as specified by the RPAGE value. If they are then bad  &&&&&&*/
-/*&&&&&&& values WILL be occasionally read from random parts of the big &&&&&&*/
-/*&&&&&&& tables instead of the correct place. If that occurs it WILL   &&&&&&*/
-/*&&&&&&& cause unpredictable and VERY hard to find bugs!!              &&&&&&*/
-/*&&&&&&&                                                               &&&&&&*/
-/*&&&&&&&  *******  *******  YOU HAVE BEEN WARNED!!!  *******  *******  &&&&&&*/
-/*&&&&&&&                                                               &&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
-/*&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&*/
+/* Lookups read the table they are given directly, callers pass a table within
+ * the active bank of its page. Setters never touch the active bank, they edit
+ * the inactive one and swap the banks when done, see tableBanks.h. */
 
 
 /* Yet to be implemented :
@@ -69,6 +54,84 @@ signed short lookup16Bit3dSS(
 signed char lookup8Bit3D( */
 
 
+/* The pair of axis points and indices that a value lies between */
+typedef struct {
+  unsigned char lowIndex;
+  unsigned char highIndex;
+  unsigned short lowValue;
+  unsigned short highValue;
+} axisBounds;
+
+
+/** @brief Find the bounding axis points on a 16 bit axis
+ *
+ * If the value is exactly on an axis point or outside of the axis, both
+ * bounds are set to that point or to the nearest end of the axis.
+ *
+ * @param axis is the sorted array of axis values.
+ * @param length is the number of valid axis values.
+ * @param value is the position to find the bounds for.
+ * @param bounds is where the result is stored.
+ */
+static inline void findAxisBounds(const unsigned short* axis, unsigned char length, unsigned short value, axisBounds* bounds) {
+  /* If never set in the loop, low value will equal high value and will be on
+   * the edge of the map */
+  bounds->lowIndex = 0;
+  bounds->highIndex = length - 1;
+  bounds->lowValue = axis[0];
+  bounds->highValue = axis[length - 1];
+
+  unsigned char index;
+  for(index = 0; index < length; index++) {
+    if(axis[index] < value) {
+      bounds->lowValue = axis[index];
+      bounds->lowIndex = index;
+    }
+    else {
+      if(axis[index] > value) {
+        bounds->highValue = axis[index];
+        bounds->highIndex = index;
+      }
+      else {
+        bounds->lowValue = axis[index];
+        bounds->highValue = axis[index];
+        bounds->lowIndex = index;
+        bounds->highIndex = index;
+      }
+      break;
+    }
+  }
+}
+
+
+/** @brief Interpolate between two cells along one axis
+ *
+ * Returns the low cell if both bounds are the same axis point, which is the
+ * case on an axis point and outside of the table.
+ */
+static inline signed long interpolate(signed long lowCell, signed long highCell, unsigned short value, const axisBounds* bounds) {
+  unsigned short span = bounds->highValue - bounds->lowValue;
+  if(span == 0) {
+    return lowCell;
+  }
+  return lowCell + (((highCell - lowCell) * (signed long)(value - bounds->lowValue)) / span);
+}
+
+
+/** @brief Interpolate the four corners around a spot down to one value
+ *
+ * Reminder : X/RPM is horizontal, Y/Load is vertical
+ */
+static inline signed long interpolateCorners(signed long lowRPMLowLoad, signed long lowRPMHighLoad, signed long highRPMLowLoad, signed long highRPMHighLoad, unsigned short realRPM, unsigned short realLoad, const axisBounds* RPMBounds, const axisBounds* LoadBounds) {
+  /* Find the two side values to interpolate between by interpolation */
+  signed long lowRPMIntLoad = interpolate(lowRPMLowLoad, lowRPMHighLoad, realLoad, LoadBounds);
+  signed long highRPMIntLoad = interpolate(highRPMLowLoad, highRPMHighLoad, realLoad, LoadBounds);
+
+  /* Interpolate between the two side values */
+  return interpolate(lowRPMIntLoad, highRPMIntLoad, realRPM, RPMBounds);
+}
+
+
 /** @brief Main table read function
  *
  * Looks up a value from a main table using interpolation.
@@ -104,98 +167,26 @@ signed char lookup8Bit3D( */
  * @param Table is a pointer to the table to read from.
  * @param realRPM is the current RPM for which a table value is required.
  * @param realLoad is the current load for which a table value is required.
- * @param RAMPage is the RAM page that the table is stored in.
  *
  * @return The interpolated value for the location specified.
  */
-unsigned short lookupPagedMainTableCellValue(mainTable* Table, unsigned short realRPM, unsigned short realLoad, unsigned char RAMPage) {
-
-  /* Save the RPAGE value for restoration and switch pages. */
-  unsigned char oldRPage = RPAGE;
-  RPAGE = RAMPage;
+unsigned short lookupPagedMainTableCellValue(mainTable* Table, unsigned short realRPM, unsigned short realLoad) {
 
-  //mainTable* Table = getTablePointer(originalTable, RAMPage);
-
-  /* Find the bounding axis values and indices for RPM */
-  unsigned char lowRPMIndex = 0;
-  unsigned char highRPMIndex = Table->RPMLength - 1;
-  /* If never set in the loop, low value will equal high value and will be on
-   * the edge of the map */
-  unsigned short lowRPMValue = Table->RPM[0];
-  unsigned short highRPMValue = Table->RPM[Table->RPMLength -1];
-
-  // TODO: AM: this can be optimised by a recursive funktion that always halfs
-  //           the search interval. It should be checked whether recursion is a
-  //           good thing when programming an embedded system. At least this
-  //           search should be genrealised and put into an funktion, because it
-  //           is used several times on different tables
-  unsigned char RPMIndex;
-  for(RPMIndex=0; RPMIndex<Table->RPMLength; RPMIndex++) {
-    if(Table->RPM[RPMIndex] < realRPM) {
-      lowRPMValue = Table->RPM[RPMIndex];
-      lowRPMIndex = RPMIndex;
-    }
-    else
-      if(Table->RPM[RPMIndex] > realRPM) {
-        highRPMValue = Table->RPM[RPMIndex];
-        highRPMIndex = RPMIndex;
-        break;
-      }
-      else
-        if(Table->RPM[RPMIndex] == realRPM) {
-          lowRPMValue = Table->RPM[RPMIndex];
-          highRPMValue = Table->RPM[RPMIndex];
-          lowRPMIndex = RPMIndex;
-          highRPMIndex = RPMIndex;
-          break;
-        }
-  }
-
-  /* Find the bounding cell values and indices for Load */
-  unsigned char lowLoadIndex = 0;
-  unsigned char highLoadIndex = Table->LoadLength -1;
-  /* If never set in the loop, low value will equal high value and will be on
-   * the edge of the map */
-  unsigned short lowLoadValue = Table->Load[0];
-  unsigned short highLoadValue = Table->Load[Table->LoadLength -1];
-
-  unsigned char LoadIndex;
-  for(LoadIndex=0; LoadIndex<Table->LoadLength; LoadIndex++) {
-    if(Table->Load[LoadIndex] < realLoad) {
-      lowLoadValue = Table->Load[LoadIndex];
-      lowLoadIndex = LoadIndex;
-    }
-    else
-      if(Table->Load[LoadIndex] > realLoad) {
-        highLoadValue = Table->Load[LoadIndex];
-        highLoadIndex = LoadIndex;
-        break;
-      }
-      else
-        if(Table->Load[LoadIndex] == realLoad) {
-          lowLoadValue = Table->Load[LoadIndex];
-          highLoadValue = Table->Load[LoadIndex];
-          lowLoadIndex = LoadIndex;
-          highLoadIndex = LoadIndex;
-          break;
-        }
-  }
+  /* Find the bounding axis values and indices for RPM and Load */
+  axisBounds RPMBounds;
+  axisBounds LoadBounds;
+  findAxisBounds(Table->RPM, Table->RPMLength, realRPM, &RPMBounds);
+  findAxisBounds(Table->Load, Table->LoadLength, realLoad, &LoadBounds);
 
   /* Obtain the four corners surrounding the spot of interest */
-  unsigned short lowRPMLowLoad = Table->Table[(Table->LoadLength * lowRPMIndex) + lowLoadIndex];
-  unsigned short lowRPMHighLoad = Table->Table[(Table->LoadLength * lowRPMIndex) + highLoadIndex];
-  unsigned short highRPMLowLoad = Table->Table[(Table->LoadLength * highRPMIndex) + lowLoadIndex];
-  unsigned short highRPMHighLoad = Table->Table[(Table->LoadLength * highRPMIndex) + highLoadIndex];
-
-  /* Restore the ram page before doing the math */
-  RPAGE = oldRPage;
-
-  /* Find the two side values to interpolate between by interpolation */
-  unsigned short lowRPMIntLoad = lowRPMLowLoad + (((signed long)((signed long)lowRPMHighLoad - lowRPMLowLoad) * (realLoad - lowLoadValue))/ (highLoadValue - lowLoadValue));
-  unsigned short highRPMIntLoad = highRPMLowLoad + (((signed long)((signed long)highRPMHighLoad - highRPMLowLoad) * (realLoad - lowLoadValue))/ (highLoadValue - lowLoadValue));
-
-  /* Interpolate between the two side values and return the result */
-  return lowRPMIntLoad + (((signed long)((signed long)highRPMIntLoad - lowRPMIntLoad) * (realRPM - lowRPMValue))/ (highRPMValue - lowRPMValue));
+  unsigned short lowRow = Table->LoadLength * RPMBounds.lowIndex;
+  unsigned short highRow = Table->LoadLength * RPMBounds.highIndex;
+  unsigned short lowRPMLowLoad = Table->Table[lowRow + LoadBounds.lowIndex];
+  unsigned short lowRPMHighLoad = Table->Table[lowRow + LoadBounds.highIndex];
+  unsigned short highRPMLowLoad = Table->Table[highRow + LoadBounds.lowIndex];
+  unsigned short highRPMHighLoad = Table->Table[highRow + LoadBounds.highIndex];
+
+  return (unsigned short)interpolateCorners(lowRPMLowLoad, lowRPMHighLoad, highRPMLowLoad, highRPMHighLoad, realRPM, realLoad, &RPMBounds, &LoadBounds);
 }
 
 
@@ -291,7 +282,7 @@ unsigned short setAxisValue(unsigned short index, unsigned short value, unsigned
  * @author Fred Cooke
  *
  * @param RPageValue The page of RAM that the table is in.
- * @param Table A pointer to the table to adjust.
+ * @param Table A pointer to the table to adjust, in the active bank.
  * @param RPMIndex The RPM position of the cell to adjust.
  * @param LoadIndex The load position of the cell to adjust.
  * @param cellValue The value to set the cell to.
@@ -299,12 +290,12 @@ unsigned short setAxisValue(unsigned short index, unsigned short value, unsigned
  * @return An error code. Zero means success, anything else is a failure.
  */
 unsigned short setPagedMainTableCellValue(unsigned char RPageValue, mainTable* Table, unsigned short RPMIndex, unsigned short LoadIndex, unsigned short cellValue) {
-  unsigned char oldRPage = RPAGE;
   unsigned short errorID = 0;
-  RPAGE = RPageValue;
   if(RPMIndex < Table->RPMLength) {
     if(LoadIndex < Table->LoadLength) {
-      Table->Table[(Table->LoadLength * RPMIndex) + LoadIndex] = cellValue;
+      mainTable* edit = tableBankEditAddress(RPageValue, Table);
+      edit->Table[(Table->LoadLength * RPMIndex) + LoadIndex] = cellValue;
+      tableBankCommit(RPageValue);
     }
     else {
       errorID = invalidMainTableLoadIndex;
@@ -313,7 +304,6 @@ unsigned short setPagedMainTableCellValue(unsigned char RPageValue, mainTable* T
   else {
     errorID = invalidMainTableRPMIndex;
   }
-  RPAGE = oldRPage;
   return errorID;
 }
 
@@ -326,17 +316,18 @@ unsigned short setPagedMainTableCellValue(unsigned char RPageValue, mainTable* T
  * @author Fred Cooke
  *
  * @param RPageValue The page of RAM that the table is in.
- * @param Table is a pointer to the table to adjust.
+ * @param Table is a pointer to the table to adjust, in the active bank.
  * @param RPMIndex The RPM position of the cell to adjust.
  * @param RPMValue The value to set the RPM axis cell to.
  *
  * @return An error code. Zero means success, anything else is a failure.
  */
 unsigned short setPagedMainTableRPMValue(unsigned char RPageValue, mainTable* Table, unsigned short RPMIndex, unsigned short RPMValue) {
-  unsigned char oldRPage = RPAGE;
-  RPAGE = RPageValue;
-  unsigned short errorID = setAxisValue(RPMIndex, RPMValue, Table->RPM, Table->RPMLength, errorBaseMainTableRPM);
-  RPAGE = oldRPage;
+  mainTable* edit = tableBankEditAddress(RPageValue, Table);
+  unsigned short errorID = setAxisValue(RPMIndex, RPMValue, edit->RPM, edit->RPMLength, errorBaseMainTableRPM);
+  if(errorID == 0) {
+    tableBankCommit(RPageValue);
+  }
   return errorID;
 }
 
@@ -349,17 +340,18 @@ unsigned short setPagedMainTableRPMValue(unsigned char RPageValue, mainTable* Ta
  * @author Fred Cooke
  *
  * @param RPageValue The page of RAM that the table is in.
- * @param Table is a pointer to the table to adjust.
+ * @param Table is a pointer to the table to adjust, in the active bank.
  * @param LoadIndex The load position of the cell to adjust.
  * @param LoadValue The value to set the load axis cell to.
  *
  * @return An error code. Zero means success, anything else is a failure.
  */
 unsigned short setPagedMainTableLoadValue(unsigned char RPageValue, mainTable* Table, unsigned short LoadIndex, unsigned short LoadValue) {
-  unsigned char oldRPage = RPAGE;
-  RPAGE = RPageValue;
-  unsigned short errorID = setAxisValue(LoadIndex, LoadValue, Table->Load, Table->LoadLength, errorBaseMainTableLoad);
-  RPAGE = oldRPage;
+  mainTable* edit = tableBankEditAddress(RPageValue, Table);
+  unsigned short errorID = setAxisValue(LoadIndex, LoadValue, edit->Load, edit->LoadLength, errorBaseMainTableLoad);
+  if(errorID == 0) {
+    tableBankCommit(RPageValue);
+  }
   return errorID;
 }
 
@@ -372,7 +364,7 @@ unsigned short setPagedMainTableLoadValue(unsigned char RPageValue, mainTable* T
  * @author Fred Cooke
  *
  * @param RPageValue The page of RAM that the table is in.
- * @param Table is a pointer to the table to adjust.
+ * @param Table is a pointer to the table to adjust, in the active bank.
  * @param cellIndex The position of the cell to adjust.
  * @param cellValue The value to set the cell to.
  *
@@ -383,10 +375,9 @@ unsigned short setPagedTwoDTableCellValue(unsigned char RPageValue, twoDTableUS*
     return invalidTwoDTableIndex;
   }
   else {
-    unsigned char oldRPage = RPAGE;
-    RPAGE = RPageValue;
-    Table->Values[cellIndex] = cellValue;
-    RPAGE = oldRPage;
+    twoDTableUS* edit = tableBankEditAddress(RPageValue, Table);
+    edit->Values[cellIndex] = cellValue;
+    tableBankCommit(RPageValue);
     return 0;
   }
 }
@@ -400,17 +391,18 @@ unsigned short setPagedTwoDTableCellValue(unsigned char RPageValue, twoDTableUS*
  * @author Fred Cooke
  *
  * @param RPageValue The page of RAM that the table is in.
- * @param Table is a pointer to the table to adjust.
+ * @param Table is a pointer to the table to adjust, in the active bank.
  * @param axisIndex The position of the axis cell to adjust.
  * @param axisValue The value to set the axis cell to.
  *
  * @return An error code. Zero means success, anything else is a failure.
  */
 unsigned short setPagedTwoDTableAxisValue(unsigned char RPageValue, twoDTableUS* Table, unsigned short axisIndex, unsigned short axisValue) {
-  unsigned char oldRPage = RPAGE;
-  RPAGE = RPageValue;
-  unsigned short errorID = setAxisValue(axisIndex, axisValue, Table->Axis, 16, errorBaseTwoDTableAxis);
-  RPAGE = oldRPage;
+  twoDTableUS* edit = tableBankEditAddress(RPageValue, Table);
+  unsigned short errorID = setAxisValue(axisIndex, axisValue, edit->Axis, 16, errorBaseTwoDTableAxis);
+  if(errorID == 0) {
+    tableBankCommit(RPageValue);
+  }
   return errorID;
 }
 
@@ -490,104 +482,104 @@ mainTable* getTablePointer(mainTable* originalTableAddress, unsigned char RAMPag
   mainTable* retval = 0;
   switch(RAMPage) {
   case RPAGE_FUEL_ONE:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = VETableMainFlashLocation;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = VETableSecondaryFlashLocation;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = VETableTertiaryFlashLocation;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = LambdaTableFlashLocation;
           }
     break;
   case RPAGE_FUEL_TWO:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = VETableMainFlash2Location;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = VETableSecondaryFlash2Location;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = VETableTertiaryFlash2Location;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = LambdaTableFlash2Location;
           }
     break;
   case RPAGE_TIME_ONE:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = IgnitionAdvanceTableMainFlashLocation;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = IgnitionAdvanceTableSecondaryFlashLocation;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = InjectionAdvanceTableMainFlashLocation;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = InjectionAdvanceTableSecondaryFlashLocation;
           }
     break;
   case RPAGE_TIME_TWO:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = IgnitionAdvanceTableMainFlash2Location;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = IgnitionAdvanceTableSecondaryFlash2Location;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = InjectionAdvanceTableMainFlash2Location;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = InjectionAdvanceTableSecondaryFlash2Location;
           }
     break;
   case RPAGE_TUNE_ONE:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = SmallTablesAFlashLocation;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = SmallTablesBFlashLocation;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = SmallTablesCFlashLocation;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = SmallTablesDFlashLocation;
           }
     break;
   case RPAGE_TUNE_TWO:
-    if(originalTableAddress == (void*)&TablesA) {
+    if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesA) {
       retval = SmallTablesAFlash2Location;
     }
     else
-      if(originalTableAddress == (void*)&TablesB) {
+      if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesB) {
         retval = SmallTablesBFlash2Location;
       }
       else
-        if(originalTableAddress == (void*)&TablesC) {
+        if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesC) {
           retval = SmallTablesCFlash2Location;
         }
         else
-          if(originalTableAddress == (void*)&TablesD) {
+          if(originalTableAddress == (void*)&TABLE_PAGE(RAMPage)->TablesD) {
             retval = SmallTablesDFlash2Location;
           }
     break;
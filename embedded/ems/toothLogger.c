@@ -0,0 +1,109 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file toothLogger.c
+ * @brief Log of the crank and cam input edges
+ *
+ * See toothLogger.h for the rules of use.
+ */
+
+#define TOOTHLOGGER_C
+#include "inc/freeEMS.h"
+#include "inc/commsCore.h"
+#include "inc/toothLogger.h"
+#include <ems/barrier.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/** @brief Store one edge, ISRs only
+ *
+ * @param timeStamp is the 32 bit capture time of the edge.
+ * @param flags is a combination of the TOOTH_LOG_ flags.
+ */
+void toothLogRecord(unsigned long timeStamp, unsigned char flags) {
+  if(asyncDatalogType != asyncDatalogTrigger) {
+    return;
+  }
+
+  unsigned short head = toothLogHead;
+  if((unsigned short)(head - toothLogTail) >= TOOTH_LOG_LENGTH) {
+    toothLogOverflows++;
+    return;
+  }
+
+  toothLogEntry* entry = &toothLog[head & TOOTH_LOG_MASK];
+  entry->timeStamp = timeStamp;
+  entry->flags = flags;
+  COMPILER_BARRIER();
+  toothLogHead = head + 1;
+}
+
+
+/** @brief Drop everything logged so far, main loop only */
+void toothLogDiscard() {
+  toothLogTail = toothLogHead;
+}
+
+
+/** @brief Check whether there are entries waiting to be sent */
+unsigned char toothLogPending() {
+  return toothLogHead != toothLogTail;
+}
+
+
+/** @brief Populate a tooth log packet
+ *
+ * Writes the overflow count and as many entries as fit into one packet at
+ * TXBufferCurrentPositionHandler and frees them in the ring.
+ *
+ * @return the length of the payload written
+ */
+unsigned short populateToothLog() {
+  unsigned char* start = TXBufferCurrentPositionHandler;
+  unsigned short tail = toothLogTail;
+  unsigned short available = toothLogHead - tail;
+  unsigned short room = (TX_MAX_PAYLOAD_SIZE - sizeof(unsigned short))
+                        / TOOTH_LOG_ENTRY_SIZE;
+  if(available > room) {
+    available = room;
+  }
+
+  unsigned short overflows = toothLogOverflows;
+  memcpy(TXBufferCurrentPositionHandler, &overflows, sizeof(unsigned short));
+  TXBufferCurrentPositionHandler += sizeof(unsigned short);
+
+  COMPILER_BARRIER();
+  while(available > 0) {
+    const toothLogEntry* entry = &toothLog[tail & TOOTH_LOG_MASK];
+    /* Always 32 bit on the wire, unsigned long may be wider */
+    uint32_t timeStamp = entry->timeStamp;
+    memcpy(TXBufferCurrentPositionHandler, &timeStamp, sizeof(uint32_t));
+    TXBufferCurrentPositionHandler[sizeof(uint32_t)] = entry->flags;
+    TXBufferCurrentPositionHandler += TOOTH_LOG_ENTRY_SIZE;
+    tail++;
+    available--;
+  }
+  COMPILER_BARRIER();
+  toothLogTail = tail;
+
+  return TXBufferCurrentPositionHandler - start;
+}
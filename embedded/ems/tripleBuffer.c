@@ -0,0 +1,115 @@
+/*
+ * This file is part of EmsBench.
+ *
+ * Copyright 2015 University of Augsburg
+ *
+ * EmsBench is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EmsBench is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EmsBench.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * $Id: header-ems.c 480 2015-10-27 12:42:40Z klugeflo $
+ * @file tripleBuffer.c
+ * @brief Single writer, single reader triple buffer
+ *
+ * Replaces the interrupt locked bank swaps of the original code. See
+ * tripleBuffer.h for the rules of use.
+ */
+
+#define TRIPLEBUFFER_C
+#include "inc/freeEMS.h"
+#include "inc/tripleBuffer.h"
+#include <ems/barrier.h>
+
+
+/** @brief Reset a triple buffer
+ *
+ * The reader owns buffer 0, which is also marked as the latest, so the first
+ * acquire only succeeds after the first publication.
+ *
+ * @param buffer the triple buffer to reset
+ */
+void tripleBufferInit(tripleBuffer* buffer) {
+  buffer->latest = 0;
+  buffer->reading = 0;
+  buffer->writing = 1;
+}
+
+
+/** @brief Select the buffer to fill
+ *
+ * Picks the buffer that is neither the latest published one nor owned by the
+ * reader. The reader can only move to the latest buffer, so the choice stays
+ * valid until tripleBufferPublish() is called.
+ *
+ * @param buffer the triple buffer to write to
+ *
+ * @return the index of the buffer to fill
+ */
+unsigned char tripleBufferWriteBegin(tripleBuffer* buffer) {
+  unsigned char latest = buffer->latest;
+  unsigned char reading = buffer->reading;
+  unsigned char writing = 0;
+  while ((writing == latest) || (writing == reading)) {
+    writing++;
+  }
+  buffer->writing = writing;
+  return writing;
+}
+
+
+/** @brief Publish the buffer filled since tripleBufferWriteBegin()
+ *
+ * @param buffer the triple buffer to publish to
+ */
+void tripleBufferPublish(tripleBuffer* buffer) {
+  COMPILER_BARRIER();
+  buffer->latest = buffer->writing;
+}
+
+
+/** @brief Take ownership of the latest published buffer
+ *
+ * The reader keeps the buffer in buffer->reading until the next call. If the
+ * writer preempts the reader between reading the latest index and claiming
+ * it, the claim is simply repeated; a writer running as ISR always completes
+ * a whole publication in that time.
+ *
+ * @param buffer the triple buffer to read from
+ *
+ * @return TRUE if a newer buffer was taken over, FALSE if nothing was
+ * published since the last call
+ */
+unsigned char tripleBufferAcquire(tripleBuffer* buffer) {
+  unsigned char latest = buffer->latest;
+  if (latest == buffer->reading) {
+    return FALSE;
+  }
+  do {
+    latest = buffer->latest;
+    buffer->reading = latest;
+  } while (latest != buffer->latest);
+  COMPILER_BARRIER();
+  return TRUE;
+}
+
+
+/** @brief Check for a publication without taking it over
+ *
+ * @param buffer the triple buffer to check
+ *
+ * @return TRUE if tripleBufferAcquire() would take over a newer buffer
+ */
+unsigned char tripleBufferPending(tripleBuffer* buffer) {
+  return buffer->latest != buffer->reading;
+}
@@ -37,89 +37,10 @@
 #include "inc/freeEMS.h"
 #include "inc/commsISRs.h"
 #include "inc/utils.h"
+#include "inc/DecoderInterface.h"
 #include <string.h>
 #include <stdint.h>
 
-/** @brief Add two unsigned shorts safely
- *
- * This will either return short max or the sum of the two arguments.
- *
- * @author Fred Cooke
- *
- * @param addend1
- * @param addend2
- */
-unsigned short safeAdd(unsigned short addend1, unsigned short addend2) {
-  if((SHORTMAX - addend1) > addend2) {
-    return addend1 + addend2;
-  }
-  else {
-    return SHORTMAX;
-  }
-}
-
-
-/** @brief Add two unsigned shorts safely
- *
- * This will either return short max or the sum of the two arguments.
- *
- * @author Fred Cooke
- *
- * @param addend1
- * @param addend2
- */
-unsigned short safeTrim(unsigned short addend1, signed short addend2) {
-
-  if(addend2 < 0) {
-    if(addend1 > -addend2) {
-      return addend1 + addend2;
-    }
-    else {
-      return 0;
-    }
-  }
-  else
-    if(addend2 > 0) {
-      if(addend2 < (SHORTMAX - addend1)) {
-        return addend1 + addend2;
-      }
-      else {
-        return SHORTMAX;
-      }
-    }
-    else {
-      return addend1;
-    }
-}
-
-
-/** @brief Scale without overflow
- *
- * Takes a base value and a scaler where 0x8000/32768 means 100%, 0 means 0%
- * and 0xFFFF/65535 means 200%, and returns the baseValue multiplied, in effect,
- * by the resulting percentage figure.
- *
- * @author Fred Cooke
- *
- * @param baseValue
- * @param scaler
- */
-unsigned short safeScale(unsigned short baseValue, unsigned short scaler) {
-  /* Perform the scaling */
-  unsigned short scaled = ((unsigned long)baseValue * scaler) / SHORTHALF;
-
-  /* If the trim is greater than 100% then the trimmedPW MUST be larger */
-  /* If it's less than 100% it can't have overflowed */
-  /* If it's not larger, it overflowed */
-  if((scaler > SHORTHALF) && (baseValue > scaled)) {
-    return SHORTMAX;
-  }
-  else {
-    return scaled;
-  }
-}
-
-
 /** @brief Setup tune switching
  *
  * Place the correct set of tables in RAM based on a boolean parameter
@@ -156,8 +77,8 @@ void setupPagedRAM(unsigned char bool) {
  */
 void resetToNonRunningState() {
   /* Reset RPM to zero */
-  RPM0 = 0;
-  RPM1 = 0;
+  RPMRecord = 0;
+  toothRingFill = 0;
 
   /* Ensure tacho reads lowest possible value */
   engineCyclePeriod = ticksPerCycleAtOneRPM;
@@ -292,26 +213,6 @@ void sleepMicro(unsigned short us) {
 }
 
 
-/** @brief Simple checksum
- *
- * Generate a simple additive checksum for a block of data.
- *
- * @author Fred Cooke
- *
- * @param block a pointer to a memory region to checksum.
- * @param length how large the memory region to checksum is.
- *
- * @return a simple additive checksum.
- */
-unsigned char checksum(unsigned char *block, unsigned short length) {
-  unsigned char sum = 0;
-  while (length-- > 0) {
-    sum += *block++;
-  }
-  return sum;
-}
-
-
 /** @brief Homebrew strcpy()
  *
  * strcpy() wouldn't compile for me for some reason so I wrote my own.
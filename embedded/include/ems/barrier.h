@@ -0,0 +1,18 @@
+/**
+ * @file barrier.h
+ * @brief Compiler barrier for lock-free hand over between ISRs and main loop
+ *
+ * All targets are single core, so ISR/main hand over only needs the compiler
+ * to keep the data accesses on their side of the index or flag update, no
+ * hardware barrier is needed.
+ */
+
+#ifndef EMS_BARRIER_H
+#define EMS_BARRIER_H
+
+/**
+ * @brief Keep the compiler from moving memory accesses across this point
+ */
+#define COMPILER_BARRIER() __asm__ __volatile__ ("" : : : "memory")
+
+#endif /* EMS_BARRIER_H */
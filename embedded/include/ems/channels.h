@@ -0,0 +1,34 @@
+/**
+ * @file channels.h
+ * @brief Number of injection and ignition channels
+ *
+ * The number of cylinders is fixed at build time by defining __CYLINDERS__
+ * (see option -c of build-ems.py). Both the EMS and its HAL derive their
+ * channel counts from it, each HAL checks that it has enough output compare
+ * channels for the selected count.
+ */
+
+#ifndef EMS_CHANNELS_H
+#define EMS_CHANNELS_H
+
+#ifndef __CYLINDERS__
+#define __CYLINDERS__ 6
+#endif
+
+/**
+ * @brief Number of injection and ignition channels in use
+ */
+#define EMS_CHANNELS (__CYLINDERS__)
+
+/**
+ * @brief Largest supported number of channels
+ * Data that is exchanged with tuning tools always holds this many channels,
+ * so that its layout does not depend on the build.
+ */
+#define EMS_CHANNELS_MAX 12
+
+#if (EMS_CHANNELS < 1) || (EMS_CHANNELS > EMS_CHANNELS_MAX)
+#error "__CYLINDERS__ must be between 1 and 12"
+#endif
+
+#endif // EMS_CHANNELS_H
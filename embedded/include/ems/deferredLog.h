@@ -0,0 +1,80 @@
+/**
+ * @file deferredLog.h
+ * @brief Logging from ISRs without formatting
+ *
+ * log_event() takes the same arguments as log_printf(), but is meant for the
+ * ISRs. With __LOG__ alone it is log_printf(). With __LOG_DEFERRED__ as well
+ * it only stores the address of the format string, the time and up to
+ * DEFERRED_LOG_ARGS arguments as 32 bit integers in a ring. The main loop
+ * prints the records as lines of numbers, perfan/logdecode.py rebuilds the
+ * text with the strings from the ELF file, see doc/log-format.txt. Thus the
+ * format strings of log_event() may only contain integer conversions.
+ */
+
+#ifndef EMS_DEFERRED_LOG_H
+#define EMS_DEFERRED_LOG_H
+
+#include <hal/log.h>
+
+#if defined(__LOG__) && defined(__LOG_DEFERRED__)
+#include <stdint.h>
+
+/**
+ * @brief Number of records the deferred log can hold, power of two
+ */
+#ifndef DEFERRED_LOG_LENGTH
+#define DEFERRED_LOG_LENGTH 256
+#endif
+#define DEFERRED_LOG_MASK (DEFERRED_LOG_LENGTH - 1)
+
+/**
+ * @brief Largest number of arguments stored per record, more are dropped
+ */
+#define DEFERRED_LOG_ARGS 4
+
+/**
+ * @brief One call of log_event()
+ */
+typedef struct {
+  const char* format;              /**< format string given to log_event() */
+  uint32_t timeStamp;              /**< hal_timer_time_get32() of the call */
+  uint32_t args[DEFERRED_LOG_ARGS];/**< the arguments */
+  unsigned char count;             /**< number of arguments stored */
+} deferred_log_record_t;
+
+/**
+ * @brief Format strings are identified by their distance to this symbol
+ */
+extern const char deferred_log_base[];
+
+/**
+ * @brief Store one record, single producer
+ *
+ * All ISRs that log run at the same priority, so they never preempt each
+ * other. Records are dropped and counted when the main loop does not keep up.
+ * @param format the format string
+ * @param count number of arguments
+ * @param args the arguments
+ */
+extern void deferred_log_record(const char* format, unsigned char count,
+                                const uint32_t* args);
+
+/**
+ * @brief Print all records stored so far through log_printf, main loop only
+ */
+extern void deferred_log_output(void);
+
+#define log_event(format, args...) do {					\
+    const uint32_t deferred_log_args[] = { 0, ## args };		\
+    deferred_log_record(format,						\
+                        (sizeof(deferred_log_args) / sizeof(uint32_t)) - 1, \
+                        deferred_log_args + 1);				\
+  } while (0)
+#define output_deferred_log() deferred_log_output()
+
+#else
+#define log_event log_printf
+#define output_deferred_log() ((void)0)
+#endif
+
+#endif // EMS_DEFERRED_LOG_H
@@ -0,0 +1,45 @@
+/**
+ * @file perfRegions.h
+ * @brief Named regions for performance profiling
+ *
+ * Code enclosed in PERF_REGION_BEGIN()/PERF_REGION_END() accumulates its
+ * cycles and entries in the region given. Regions may overlap and nest. Each
+ * HAL decides which regions it can count, see hal_performance_regionRead().
+ */
+
+#ifndef EMS_PERF_REGIONS_H
+#define EMS_PERF_REGIONS_H
+
+/** @brief Not a region, counts nothing */
+#define PERF_REGION_NONE          0
+/** @brief generateCoreVars() */
+#define PERF_REGION_CORE_VARS     1
+/** @brief generateDerivedVars() */
+#define PERF_REGION_DERIVED_VARS  2
+/** @brief calculateFuelAndIgnition() */
+#define PERF_REGION_FUEL_IGNITION 3
+/** @brief Handling of received packets and sending of datalogs */
+#define PERF_REGION_COMMS         4
+/** @brief PrimaryRPMISR() */
+#define PERF_REGION_PRIMARY_RPM   5
+/** @brief SecondaryRPMISR() */
+#define PERF_REGION_SECONDARY_RPM 6
+/** @brief All injector ISRs */
+#define PERF_REGION_INJECTION     7
+/** @brief IgnitionDwellISR() */
+#define PERF_REGION_DWELL         8
+/** @brief IgnitionFireISR() */
+#define PERF_REGION_FIRE          9
+/** @brief RTIISR() */
+#define PERF_REGION_RTI           10
+
+/** @brief Number of regions including PERF_REGION_NONE */
+#define PERF_REGIONS              11
+
+/**
+ * @brief Names of the regions in the order of their IDs, used for output
+ */
+#define PERF_REGION_NAMES { "none", "coreVars", "derivedVars", "fuelIgnition", \
+      "comms", "primaryRPM", "secondaryRPM", "injection", "dwell", "fire", "rti" }
+
+#endif // EMS_PERF_REGIONS_H
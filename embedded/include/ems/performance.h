@@ -10,20 +10,97 @@
 
 #include <hal/ems/hal_performance.h>
 
+#ifdef __PERF__
+#include <stdint.h>
+#include <hal/ems/hal_timer.h>
+#include <ems/barrier.h>
+
+/**
+ * @brief Number of records the performance ring can hold, power of two
+ */
+#ifndef PERF_RING_LENGTH
+#define PERF_RING_LENGTH 128
+#endif
+#define PERF_RING_MASK (PERF_RING_LENGTH - 1)
+
+/**
+ * @brief One measurement of a wrapped ISR
+ */
+typedef struct {
+  const char* id;     /**< ID string given to the wrapper */
+  uint32_t timeStamp; /**< hal_timer_time_get32() when the ISR finished */
+  unsigned int cycles;/**< execution time as returned by the HAL counter */
+  unsigned int inclusive;/**< execution time including nested measurements */
+  char path;          /**< path identifier, 0 for PERF_WRAP_SIMPLE */
+} perf_record_t;
+
+extern perf_record_t perf_ring[PERF_RING_LENGTH];
+extern volatile unsigned short perf_ring_head;
+extern volatile unsigned short perf_ring_tail;
+extern volatile unsigned int perf_ring_overflows;
+
+/**
+ * @brief Store one measurement, ISRs only
+ *
+ * The wrapped ISRs do not preempt each other, so there is a single producer
+ * and the main loop is the single consumer. Records are dropped and counted
+ * when the main loop does not keep up.
+ * @param id ID string of the ISR
+ * @param path path identifier, 0 if none
+ * @param cycles measured execution time
+ * @param inclusive measured execution time including nested measurements
+ */
+static inline void perf_ring_push(const char* id, char path, unsigned int cycles,
+                                  unsigned int inclusive) {
+  unsigned short head = perf_ring_head;
+  if ((unsigned short)(head - perf_ring_tail) >= PERF_RING_LENGTH) {
+    perf_ring_overflows++;
+    return;
+  }
+  perf_record_t* record = &perf_ring[head & PERF_RING_MASK];
+  record->id = id;
+  record->timeStamp = hal_timer_time_get32();
+  record->cycles = cycles;
+  record->inclusive = inclusive;
+  record->path = path;
+  COMPILER_BARRIER();
+  perf_ring_head = head + 1;
+}
+
+/**
+ * @brief Print all records stored so far through perf_printf, main loop only
+ * @see output_performance_log()
+ */
+extern void perf_ring_output(void);
+
+/**
+ * @brief Print the totals of all regions counted by the HAL, main loop only
+ *
+ * The totals are read in one atomic block, so they are consistent with each
+ * other.
+ */
+extern void perf_region_output(void);
+#endif // __PERF__
+
 #ifdef __PERF__
 /**
  * @brief Wrapper for ISRs without execution path tracking.
  * @author Florian Kluge
  * @param name Name of the ISR
  * @param idc ID-char (as string!) for performance output
+ * @param region profiling region of the ISR, see ems/perfRegions.h
  */
-#define PERF_WRAP_SIMPLE(name, idc)					\
+#define PERF_WRAP_SIMPLE(name, idc, region)				\
   void name##_wrapped();						\
   void name () {							\
+    hal_performance_regionBegin(region);				\
     hal_performance_startCounter();					\
     name## _wrapped();							\
-    unsigned int executionDuration = hal_performance_stopCounter();	\
-    perf_printf("*" idc "%u\r\n", executionDuration);			\
+    unsigned int inclusiveDuration;					\
+    unsigned int executionDuration =					\
+      hal_performance_stopCounterNested(&inclusiveDuration);		\
+    hal_performance_regionEnd(region);					\
+    perf_ring_push(idc, 0, executionDuration, inclusiveDuration);	\
   }									\
   void name## _wrapped()
 
@@ -32,14 +109,20 @@
  * @author Florian Kluge
  * @param name Name of the ISR
  * @param idc ID-char (as string!) for performance output
+ * @param region profiling region of the ISR, see ems/perfRegions.h
  */
-#define PERF_WRAP_PATH(name, idc)					\
+#define PERF_WRAP_PATH(name, idc, region)				\
   char name##_wrapped();						\
   void name () {							\
+    hal_performance_regionBegin(region);				\
     hal_performance_startCounter();					\
     char executionPathIdentifier = name## _wrapped();			\
-    unsigned int executionDuration = hal_performance_stopCounter();	\
-    perf_printf("*" idc "%c%u\r\n", executionPathIdentifier, executionDuration); \
+    unsigned int inclusiveDuration;					\
+    unsigned int executionDuration =					\
+      hal_performance_stopCounterNested(&inclusiveDuration);		\
+    hal_performance_regionEnd(region);					\
+    perf_ring_push(idc, executionPathIdentifier, executionDuration,	\
+                   inclusiveDuration);					\
   }									\
   char name## _wrapped()
 
@@ -66,6 +149,18 @@
  */
 #define PERF_PATH_RETURN() return perf_executionPathIdentifier;
 
+/**
+ * @brief Enter a profiling region
+ * @param region one of the PERF_REGION_ IDs, see ems/perfRegions.h
+ */
+#define PERF_REGION_BEGIN(region) hal_performance_regionBegin(region)
+
+/**
+ * @brief Leave a profiling region
+ * @param region the region given to PERF_REGION_BEGIN()
+ */
+#define PERF_REGION_END(region) hal_performance_regionEnd(region)
+
 #else // __PERF__
 
 /**
@@ -73,8 +168,9 @@
  * @author Florian Kluge
  * @param name Name of the ISR
  * @param idc ignored in !__PERF__
+ * @param region ignored in !__PERF__
  */
-#define PERF_WRAP_SIMPLE(name, idc)		\
+#define PERF_WRAP_SIMPLE(name, idc, region)	\
   void name ()
 
 /**
@@ -82,8 +178,9 @@
  * @author Florian Kluge
  * @param name Name of the ISR
  * @param idc ignored in !__PERF__
+ * @param region ignored in !__PERF__
  */
-#define PERF_WRAP_PATH(name, idc)		\
+#define PERF_WRAP_PATH(name, idc, region)	\
   void name ()
 
 /**
@@ -104,6 +201,16 @@
  */
 #define PERF_PATH_RETURN() return;
 
+/**
+ * @brief Ignored in !__PERF__
+ */
+#define PERF_REGION_BEGIN(region) ((void)0)
+
+/**
+ * @brief Ignored in !__PERF__
+ */
+#define PERF_REGION_END(region) ((void)0)
+
 #endif // __PERF__
 
 
@@ -1,4 +1,11 @@
 # $Id: files.mk 535 2016-02-10 15:14:45Z klugeflo $
 # List all wcetbench source files
 
-APP_C_SRC = main.c isrs.c
+# The EMS kernels are measured in the real EMS code, so all of the ems sources
+# except its main() are linked in. Their objects end up in the ems/
+# subdirectory of the build directory. The tunable tables are added, without
+# them all curve axes are zero and the lookups divide by zero.
+include $(BASE)/ems/files.mk
+EMS_C_SRC := $(filter-out main.c, $(APP_C_SRC)) TunableConfig.c TunableConfig2.c
+
+APP_C_SRC := main.c kernels.c $(EMS_C_SRC:%=../ems/%)
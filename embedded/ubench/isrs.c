@@ -1,53 +0,0 @@
-/**
- * $Id: isrs.c 535 2016-02-10 15:14:45Z klugeflo $
- * @brief Dummy ISRs, so we can use the EMS HAL
- * @author Florian Kluge <kluge@informatik.uni-augsburg.de>
- */
-
-void PrimaryRPMISR() {
-}
-
-
-void SecondaryRPMISR() {
-}
-
-
-void IgnitionDwellISR() {
-}
-
-
-void IgnitionFireISR() {
-}
-
-
-void Injector1ISR() {
-}
-
-
-void Injector2ISR() {
-}
-
-
-void Injector3ISR() {
-}
-
-
-void Injector4ISR() {
-}
-
-
-void Injector5ISR() {
-}
-
-
-void Injector6ISR() {
-}
-
-
-void RTIISR() {
-}
-
-
-void TimerOverflow() {
-}
-
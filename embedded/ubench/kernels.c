@@ -0,0 +1,218 @@
+/**
+ * @brief Measurements of the EMS kernels over input sweeps
+ *
+ * Every point of a sweep is measured KERNEL_RUNS times, the output line
+ * "**kernel x y (result): min median max" gives the cycles of the fastest,
+ * the median and the slowest run. The tables and configuration are the ones
+ * the EMS starts with.
+ */
+
+#include <hal/ems/freeems_hal.h>
+#include <hal/log.h>
+#include <ems/performance.h>
+#include "../ems/inc/main.h"
+#include "../ems/inc/tableLookup.h"
+#include "../ems/inc/saturatingMath.h"
+
+/** @brief Measurements per sweep point, odd to give a proper median */
+#define KERNEL_RUNS 15
+/** @brief Points per sweep axis, spread evenly across the full input range */
+#define KERNEL_SWEEP 5
+/** @brief Channels the saturating helpers are applied to per call */
+#define KERNEL_CHANNELS 8
+/** @brief Input value at sweep point i of KERNEL_SWEEP within [0, max] */
+#define KERNEL_POINT(i, max) ((unsigned short)(((unsigned long)(i) * (max)) / (KERNEL_SWEEP - 1)))
+
+static unsigned int kernelDurations[KERNEL_RUNS];
+static ADCArray kernelADC;
+
+/* Scalers from 0% to 200% and trims across the full signed range, applied to
+ * one base value like the per channel fuel trims */
+static const unsigned short kernelScalers[KERNEL_CHANNELS] = {
+  0x0000, 0x2000, 0x4000, 0x6000, 0x8000, 0xA000, 0xC000, 0xFFFF
+};
+static const signed short kernelTrims[KERNEL_CHANNELS] = {
+  -32768, -16384, -4096, -1, 0, 4096, 16384, 32767
+};
+
+
+/**
+ * @brief Sorts the durations of the last point in ascending order
+ *
+ * Insertion sort, the array is short.
+ */
+static void kernel_sort(void) {
+  int i;
+  for (i = 1; i < KERNEL_RUNS; ++i) {
+    unsigned int duration = kernelDurations[i];
+    int j = i;
+    while ((j > 0) && (kernelDurations[j - 1] > duration)) {
+      kernelDurations[j] = kernelDurations[j - 1];
+      --j;
+    }
+    kernelDurations[j] = duration;
+  }
+}
+
+
+#define KERNEL_REPORT(function, x, y, rv) {				\
+    (void)(rv);							\
+    kernel_sort();							\
+    perf_printf("**"#function" %u %u (%d): %u %u %u\r\n", (x), (y), (rv), \
+                kernelDurations[0], kernelDurations[KERNEL_RUNS / 2],	\
+                kernelDurations[KERNEL_RUNS - 1]);			\
+  }
+
+/** @brief Measure a kernel returning a value at sweep point (x, y) */
+#define KNMEAS(function, x, y, args...) {				\
+    int rv = 0;								\
+    int run;								\
+    for (run = 0; run < KERNEL_RUNS; ++run) {				\
+      hal_performance_startCounter();					\
+      rv = function(args);						\
+      kernelDurations[run] = hal_performance_stopCounter();		\
+    }									\
+    KERNEL_REPORT(function, x, y, rv);					\
+  }
+
+/** @brief Measure a kernel without return value at sweep point (x, y) */
+#define KVMEAS(function, x, y, args...) {				\
+    int run;								\
+    for (run = 0; run < KERNEL_RUNS; ++run) {				\
+      hal_performance_startCounter();					\
+      function(args);							\
+      kernelDurations[run] = hal_performance_stopCounter();		\
+    }									\
+    KERNEL_REPORT(function, x, y, 0);					\
+  }
+
+
+/**
+ * @brief safeScale() over all channels, as the fuel trims use it
+ *
+ * The saturating helpers are inlined into their callers, so a single call
+ * would only measure the counter overhead.
+ */
+static int __attribute__((noinline)) kernel_safeScale(unsigned short base) {
+  unsigned short result = 0;
+  unsigned char channel;
+  for (channel = 0; channel < KERNEL_CHANNELS; ++channel) {
+    result ^= safeScale(base, kernelScalers[channel]);
+  }
+  return result;
+}
+
+
+/**
+ * @brief safeTrim() over all channels, see kernel_safeScale()
+ */
+static int __attribute__((noinline)) kernel_safeTrim(unsigned short base) {
+  unsigned short result = 0;
+  unsigned char channel;
+  for (channel = 0; channel < KERNEL_CHANNELS; ++channel) {
+    result ^= safeTrim(base, kernelTrims[channel]);
+  }
+  return result;
+}
+
+
+/**
+ * @brief Input value at sweep point i along the axis of a curve
+ *
+ * lookupTwoDTableUS() divides by zero for values outside of the axis, which
+ * traps on the host, so the sweep stays between the first and last point.
+ */
+static unsigned short kernel_axis_point(const twoDTableUS* table, int i) {
+  unsigned short first = table->Axis[0];
+  return first + KERNEL_POINT(i, table->Axis[TWODTABLEUS_LENGTH - 1] - first);
+}
+
+
+/**
+ * @brief Set all ADC readings the core variables are generated from
+ */
+static void kernel_set_adc(unsigned short value) {
+  unsigned short* readings = (unsigned short*)&kernelADC;
+  unsigned char channel;
+  for (channel = 0; channel < ADC_ARRAY_LENGTH; ++channel) {
+    readings[channel] = value;
+  }
+}
+
+
+/**
+ * @brief Set the core variables the derived ones are looked up with
+ *
+ * Battery voltage and coolant temperature are put in the middle of the curves
+ * they are looked up in, see kernel_axis_point().
+ */
+static void kernel_set_core_vars(unsigned short rpm, unsigned short load) {
+  tablePage* tuneTables = TABLE_PAGE(currentTuneRPage);
+  CoreVars->RPM = rpm;
+  CoreVars->MAP = load;
+  CoreVars->TPS = load;
+  CoreVars->BRV = tuneTables->TablesA.SmallTablesA.injectorDeadTimeTable.Axis[TWODTABLEUS_LENGTH / 2];
+  CoreVars->CHT = tuneTables->TablesA.SmallTablesA.engineTempEnrichmentTablePercent.Axis[TWODTABLEUS_LENGTH / 2];
+}
+
+
+/**
+ * @brief Run the EMS kernels over their input sweeps
+ *
+ * The EMS is initialised as by main_freeems(), but the timers stay off, so no
+ * ISR disturbs the measurements.
+ */
+void bm_kernels() {
+  int x, y;
+
+  init();
+  ADCArrays = &kernelADC;
+  MathResult* result = &mathResults[tripleBufferWriteBegin(&mathResultBuffer)];
+  currentDwellMath = &result->dwell;
+  injectorMainPulseWidthsMath = result->injectorMainPulseWidths;
+  injectorStagedPulseWidthsMath = result->injectorStagedPulseWidths;
+
+  tablePage* fuelTables = TABLE_PAGE(currentFuelRPage);
+  tablePage* tuneTables = TABLE_PAGE(currentTuneRPage);
+
+  perf_printf("***Table lookups:\r\n");
+  for (x = 0; x < KERNEL_SWEEP; ++x) {
+    for (y = 0; y < KERNEL_SWEEP; ++y) {
+      unsigned short rpm = KERNEL_POINT(x, 0xFFFF);
+      unsigned short load = KERNEL_POINT(y, 0xFFFF);
+      KNMEAS(lookupPagedMainTableCellValue, rpm, load,
+             &fuelTables->TablesA.VETableMain, rpm, load);
+    }
+  }
+  for (x = 0; x < KERNEL_SWEEP; ++x) {
+    twoDTableUS* deadTimes = &tuneTables->TablesA.SmallTablesA.injectorDeadTimeTable;
+    unsigned short value = kernel_axis_point(deadTimes, x);
+    KNMEAS(lookupTwoDTableUS, value, 0, deadTimes, value);
+  }
+
+  perf_printf("***Saturating math:\r\n");
+  for (x = 0; x < KERNEL_SWEEP; ++x) {
+    unsigned short base = KERNEL_POINT(x, 0xFFFF);
+    KNMEAS(kernel_safeScale, base, 0, base);
+    KNMEAS(kernel_safeTrim, base, 0, base);
+  }
+
+  perf_printf("***Sensors:\r\n");
+  KVMEAS(sampleEachADC, 0, 0, &kernelADC);
+  for (x = 0; x < KERNEL_SWEEP; ++x) {
+    unsigned short reading = KERNEL_POINT(x, 0x3FF);
+    kernel_set_adc(reading);
+    KVMEAS(generateCoreVars, reading, 0);
+  }
+
+  perf_printf("***Calculations:\r\n");
+  for (x = 0; x < KERNEL_SWEEP; ++x) {
+    for (y = 0; y < KERNEL_SWEEP; ++y) {
+      unsigned short rpm = KERNEL_POINT(x, 0x3FFF);
+      unsigned short load = KERNEL_POINT(y, 0xFFFF);
+      kernel_set_core_vars(rpm, load);
+      KVMEAS(generateDerivedVars, rpm, load);
+      KVMEAS(calculateFuelAndIgnition, rpm, load);
+    }
+  }
+}
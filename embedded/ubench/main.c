@@ -21,6 +21,7 @@ int bm_loop(int n);
 int bm_long_loop(int n);
 
 int bm_io();
+void bm_kernels();
 
 int main(void) {
   hal_system_clock();
@@ -38,6 +39,9 @@ int main(void) {
   debug_puts("Entering I/O benchmarks...\r\n");
   bm_io();
 
+  debug_puts("Entering EMS kernel benchmarks...\r\n");
+  bm_kernels();
+
   bm_finish();
   return 0;
 }
@@ -0,0 +1,194 @@
+#!/usr/bin/python3
+################################################################################
+# Decoder for the deferred log of EMS builds with -D__LOG__ -D__LOG_DEFERRED__
+#
+# Example calls:
+# ./logdecode.py ems-default.elf ems.log
+# ./logdecode.py ems-default.elf ems.log --time > ems.txt
+#
+# The target prints each log_event() as !ID@TIME ARGS..., see
+# doc/log-format.txt. ID is the distance of the format string to the symbol
+# deferred_log_base, the format strings are read from the ELF file of the
+# very build that wrote the log. All other lines are copied unchanged.
+################################################################################
+
+import argparse
+import re
+import struct
+import sys
+
+################################################################################
+# Line formats
+
+# One record: !123@4567 8 9
+RE_RECORD = re.compile(r"^!(\d+)@(\d+)((?:\s+\d+)*)\s*$")
+# Records dropped by the target: !Overflow 3
+RE_OVERFLOW = re.compile(r"^!Overflow\s*(\d+)\s*$")
+# Conversions of the format strings
+RE_CONVERSION = re.compile(r"%([-+ 0#]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diuxXoc%])")
+
+BASE_SYMBOL = "deferred_log_base"
+
+################################################################################
+
+class Elf:
+    """Just enough of an ELF file to read strings by their address"""
+
+    SHT_SYMTAB = 2
+    SHT_NOBITS = 8
+    SHF_ALLOC = 2
+
+    def __init__(self, fileName):
+        with open(fileName, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % fileName)
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+        if self.is64:
+            shoff, = self.unpack("Q", 0x28)
+            shentsize, shnum = self.unpack("HH", 0x3A)
+        else:
+            shoff, = self.unpack("I", 0x20)
+            shentsize, shnum = self.unpack("HH", 0x2E)
+        self.sections = []
+        for index in range(shnum):
+            offset = shoff + index * shentsize
+            if self.is64:
+                name, stype, flags, addr, soff, size, link = self.unpack("IIQQQQI", offset)
+            else:
+                name, stype, flags, addr, soff, size, link = self.unpack("IIIIIII", offset)
+            self.sections.append((stype, flags, addr, soff, size, link))
+
+    def unpack(self, fmt, offset):
+        fmt = self.endian + fmt
+        return struct.unpack_from(fmt, self.data, offset)
+
+    def symbol(self, wanted):
+        """Address of the symbol named wanted"""
+        for stype, flags, addr, soff, size, link in self.sections:
+            if stype != self.SHT_SYMTAB:
+                continue
+            strOff = self.sections[link][3]
+            entSize = 24 if self.is64 else 16
+            for offset in range(soff, soff + size, entSize):
+                if self.is64:
+                    name, info, other, shndx, value = self.unpack("IBBHQ", offset)
+                else:
+                    name, value = self.unpack("II", offset)
+                end = self.data.index(b"\0", strOff + name)
+                if self.data[strOff + name:end].decode("ascii", "replace") == wanted:
+                    return value
+        raise KeyError("symbol %s not found, is the ELF file stripped?" % wanted)
+
+    def string(self, address):
+        """NUL terminated string at address"""
+        for stype, flags, addr, soff, size, link in self.sections:
+            if (flags & self.SHF_ALLOC) and stype != self.SHT_NOBITS \
+                    and addr <= address < addr + size:
+                start = soff + address - addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("latin-1")
+        return None
+
+################################################################################
+
+def formatRecord(fmt, args):
+    """printf() for integer conversions, args are unsigned 32 bit values"""
+    args = list(args)
+
+    def convert(m):
+        flags, width, precision, conv = m.groups()
+        if conv == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        if conv in "di" and value >= 0x80000000:
+            value -= 0x100000000
+        if conv == "c":
+            return chr(value & 0xFF)
+        pyConv = {"i": "d", "u": "d"}.get(conv, conv)
+        spec = "%" + flags + width + ("." + precision if precision else "") + pyConv
+        return spec % value
+
+    return RE_CONVERSION.sub(convert, fmt)
+
+
+class Decoder:
+
+    def __init__(self, elf):
+        self.elf = elf
+        self.base = elf.symbol(BASE_SYMBOL)
+        self.formats = {}
+        self.unknown = 0
+        self.overflows = 0
+
+    def format(self, ident):
+        if ident not in self.formats:
+            # Distances are printed modulo 2^32
+            if ident >= 0x80000000:
+                ident -= 0x100000000
+            self.formats[ident] = self.elf.string(self.base + ident)
+        return self.formats[ident]
+
+    def decode(self, line, withTime):
+        """Text of line"""
+        stripped = line.strip()
+        m = RE_RECORD.match(stripped)
+        if m:
+            fmt = self.format(int(m.group(1)))
+            args = [int(a) for a in m.group(3).split()]
+            if fmt is None:
+                self.unknown += 1
+                text = "<unknown format %s> %s" % (m.group(1), " ".join(m.group(3).split()))
+            else:
+                text = formatRecord(fmt, args).rstrip("\r\n")
+            if withTime:
+                text = "[%s] %s" % (m.group(2), text)
+            return text
+        m = RE_OVERFLOW.match(stripped)
+        if m:
+            self.overflows = int(m.group(1))
+            return "<%s records dropped in total>" % m.group(1)
+        return line.rstrip("\r\n")
+
+################################################################################
+
+def createParser():
+    parser = argparse.ArgumentParser(description = "Decoder for the deferred EMS log",
+                                     epilog = "Use - as log name to read from standard input.")
+    parser.add_argument("elf", help = "ELF file of the build that wrote the log")
+    parser.add_argument("log", help = "Log with deferred records")
+    parser.add_argument("--time", action = "store_true",
+                        help = "Prefix every record with its time stamp")
+    return parser
+
+
+def main():
+    args = createParser().parse_args()
+    try:
+        decoder = Decoder(Elf(args.elf))
+    except (OSError, ValueError, KeyError) as e:
+        print("Error: %s" % e, file = sys.stderr)
+        return 1
+
+    if args.log == "-":
+        stream = sys.stdin
+    else:
+        stream = open(args.log, "r", errors = "replace")
+    for line in stream:
+        text = decoder.decode(line, args.time)
+        if text is not None:
+            print(text)
+    if stream is not sys.stdin:
+        stream.close()
+
+    if decoder.overflows > 0:
+        print("Warning: target dropped %d records" % decoder.overflows, file = sys.stderr)
+    if decoder.unknown > 0:
+        print("Warning: %d records with unknown format, wrong ELF file?" % decoder.unknown,
+              file = sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
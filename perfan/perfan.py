@@ -0,0 +1,374 @@
+#!/usr/bin/python3
+################################################################################
+# Performance log analyser for EMS builds with performance logging (-P)
+#
+# Example calls:
+# ./perfan.py stats ems.log
+# ./perfan.py stats ems.log --csv ems.csv --json ems.json --hist
+# ./perfan.py diff before.log after.log --threshold 5
+#
+# The log format is described in doc/log-format.txt. Lines that are not
+# performance output are ignored, so a log may well contain debug output.
+################################################################################
+
+import argparse
+import bisect
+import csv
+import json
+import math
+import re
+import sys
+
+################################################################################
+# Line formats
+
+# Measurements of main loop code blocks: *r, *sr, *sii
+RE_MAIN = re.compile(r"^\*(sii|sr|r)(\d+)$")
+# Wrapped ISRs with path identifier: *pe123, *rta78, *i3h456, *pe123/150@789
+# The time after the slash includes nested ISRs and is not used
+RE_PATH = re.compile(r"^\*(rt|p|i\d+)([a-z])(\d+)(?:/\d+)?(?:@(\d+))?$")
+# Injector ISRs before the wrappers: *ih1-456
+RE_INJ_OLD = re.compile(r"^\*i([a-z])(\d+)-(\d+)$")
+# Wrapped ISRs without path identifier: *s123, older ones with channel *f1-123
+RE_SIMPLE = re.compile(r"^\*([sdf])(?:(\d+)-)?(\d+)(?:/\d+)?(?:@(\d+))?$")
+# Base measurement of the counter overhead: **MeasB 2: 12
+RE_BASE = re.compile(r"^\*\*MeasB\s*(\d+)\s*:\s*(\d+)$")
+# Records dropped by the target: **PerfOverflow 3
+RE_OVERFLOW = re.compile(r"^\*\*PerfOverflow\s*(\d+)$")
+# Totals of a profiling region: **Region coreVars 123456 78
+RE_REGION = re.compile(r"^\*\*Region\s*([A-Za-z]+?)\s*(\d+)\s+(\d+)$")
+
+# Path column for statistics over all paths of an ISR
+ALL_PATHS = "*"
+
+################################################################################
+
+class Run:
+    """All measurements read from one log"""
+
+    def __init__(self, name):
+        self.name = name
+        self.samples = {}   # (isr, path) -> list of cycle counts
+        self.base = None
+        self.overflows = 0
+        self.regions = {}   # name -> (cycles, entries), latest totals
+        self.ignored = 0
+
+    def add(self, isr, path, cycles):
+        self.samples.setdefault((isr, path), []).append(cycles)
+
+    def subtractBase(self):
+        if self.base is None:
+            return
+        for key in self.samples:
+            self.samples[key] = [max(0, c - self.base) for c in self.samples[key]]
+
+    def groups(self):
+        """Yields (isr, path, samples), preceded by one ALL_PATHS group for
+        every ISR with path identifiers"""
+        isrs = {}
+        for (isr, path) in self.samples:
+            isrs.setdefault(isr, []).append(path)
+        for isr in sorted(isrs):
+            paths = sorted(isrs[isr])
+            if paths != [""]:
+                merged = []
+                for path in paths:
+                    merged.extend(self.samples[(isr, path)])
+                yield (isr, ALL_PATHS, merged)
+            for path in paths:
+                yield (isr, path, self.samples[(isr, path)])
+
+################################################################################
+
+def parseLine(run, line):
+    m = RE_REGION.match(line.strip())
+    if m:
+        run.regions[m.group(1)] = (int(m.group(2)), int(m.group(3)))
+        return
+    line = "".join(line.split())
+    if not line.startswith("*"):
+        return
+
+    m = RE_BASE.match(line)
+    if m:
+        # The second measurement runs with warm caches, prefer it
+        if run.base is None or m.group(1) != "1":
+            run.base = int(m.group(2))
+        return
+    m = RE_OVERFLOW.match(line)
+    if m:
+        run.overflows = max(run.overflows, int(m.group(1)))
+        return
+    m = RE_MAIN.match(line)
+    if m:
+        run.add(m.group(1), "", int(m.group(2)))
+        return
+    m = RE_PATH.match(line)
+    if m:
+        run.add(m.group(1), m.group(2), int(m.group(3)))
+        return
+    m = RE_INJ_OLD.match(line)
+    if m:
+        run.add("i" + m.group(2), m.group(1), int(m.group(3)))
+        return
+    m = RE_SIMPLE.match(line)
+    if m:
+        isr = m.group(1)
+        if m.group(2) is not None:
+            isr += m.group(2)
+        run.add(isr, "", int(m.group(3)))
+        return
+    run.ignored += 1
+
+
+def readRun(fileName, subtractBase):
+    run = Run(fileName)
+    if fileName == "-":
+        stream = sys.stdin
+    else:
+        stream = open(fileName, "r", errors = "replace")
+    for line in stream:
+        parseLine(run, line)
+    if stream is not sys.stdin:
+        stream.close()
+    if subtractBase:
+        run.subtractBase()
+    if run.overflows > 0:
+        print("Warning: %s: target dropped %d measurements" % (fileName, run.overflows),
+              file = sys.stderr)
+    if subtractBase and run.base is None:
+        print("Warning: %s: no base measurement found, nothing subtracted" % fileName,
+              file = sys.stderr)
+    return run
+
+################################################################################
+# Statistics
+
+def percentile(ordered, p):
+    """Nearest rank percentile of an ascending list"""
+    rank = int(math.ceil(p / 100.0 * len(ordered)))
+    return ordered[max(0, rank - 1)]
+
+
+def median(ordered):
+    n = len(ordered)
+    if n % 2 == 1:
+        return float(ordered[n // 2])
+    return (ordered[n // 2 - 1] + ordered[n // 2]) / 2.0
+
+
+def summarise(samples):
+    ordered = sorted(samples)
+    return {
+        "count": len(ordered),
+        "min": ordered[0],
+        "median": median(ordered),
+        "mean": sum(ordered) / float(len(ordered)),
+        "p99": percentile(ordered, 99),
+        "max": ordered[-1],
+    }
+
+
+def histogram(samples, bins):
+    """Equally wide bins from min to max, returns a list of (low, high, count)"""
+    low = min(samples)
+    high = max(samples)
+    width = max(1, int(math.ceil((high - low + 1) / float(bins))))
+    edges = [low + i * width for i in range(bins + 1)]
+    counts = [0] * bins
+    for s in samples:
+        counts[min(bins - 1, bisect.bisect_right(edges, s) - 1)] += 1
+    return [(edges[i], edges[i + 1] - 1, counts[i]) for i in range(bins) if edges[i] <= high]
+
+
+def mannWhitney(a, b):
+    """Two sided Mann-Whitney U test with normal approximation, returns p"""
+    n1 = len(a)
+    n2 = len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    merged = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    rankSum = 0.0
+    tieTerm = 0.0
+    i = 0
+    while i < len(merged):
+        j = i
+        while j < len(merged) and merged[j][0] == merged[i][0]:
+            j += 1
+        rank = (i + 1 + j) / 2.0
+        rankSum += rank * sum(1 for k in range(i, j) if merged[k][1] == 0)
+        t = j - i
+        tieTerm += t * t * t - t
+        i = j
+    u = rankSum - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1.0))) if n > 1 else 0.0
+    if variance <= 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2.0) - 0.5) / math.sqrt(variance)
+    return math.erfc(max(0.0, z) / math.sqrt(2.0))
+
+################################################################################
+# Output
+
+STAT_COLUMNS = ["count", "min", "median", "mean", "p99", "max"]
+
+
+def formatValue(v):
+    if isinstance(v, float):
+        return "%.1f" % v
+    return str(v)
+
+
+def printTable(header, rows, out = sys.stdout):
+    widths = [len(h) for h in header]
+    text = [[formatValue(v) for v in row] for row in rows]
+    for row in text:
+        widths = [max(w, len(v)) for w, v in zip(widths, row)]
+    out.write("  ".join(h.rjust(w) for h, w in zip(header, widths)) + "\n")
+    for row in text:
+        out.write("  ".join(v.rjust(w) for v, w in zip(row, widths)) + "\n")
+
+
+def writeCsv(fileName, header, rows):
+    with open(fileName, "w", newline = "") as f:
+        writer = csv.writer(f)
+        writer.writerow(header)
+        for row in rows:
+            writer.writerow([formatValue(v) for v in row])
+
+
+def writeJson(fileName, data):
+    with open(fileName, "w") as f:
+        json.dump(data, f, indent = 2, sort_keys = True)
+        f.write("\n")
+
+################################################################################
+# Commands
+
+def cmdStats(args):
+    run = readRun(args.log, not args.raw)
+    header = ["isr", "path"] + STAT_COLUMNS
+    rows = []
+    data = {"log": run.name, "base": run.base, "overflows": run.overflows, "isrs": []}
+    for isr, path, samples in run.groups():
+        s = summarise(samples)
+        rows.append([isr, path] + [s[c] for c in STAT_COLUMNS])
+        entry = {"isr": isr, "path": path}
+        entry.update(s)
+        if args.hist or args.json:
+            entry["histogram"] = [{"low": l, "high": h, "count": c}
+                                  for l, h, c in histogram(samples, args.bins)]
+        data["isrs"].append(entry)
+
+    print("Base measurement: %s, overflows: %d" % (run.base, run.overflows))
+    printTable(header, rows)
+    if run.regions:
+        regionRows = []
+        data["regions"] = []
+        for name in sorted(run.regions):
+            cycles, entries = run.regions[name]
+            perEntry = cycles / float(entries) if entries else 0.0
+            regionRows.append([name, cycles, entries, perEntry])
+            data["regions"].append({"region": name, "cycles": cycles,
+                                    "entries": entries, "perEntry": perEntry})
+        print("")
+        printTable(["region", "cycles", "entries", "perEntry"], regionRows)
+    if args.hist:
+        for entry in data["isrs"]:
+            print("\n%s %s" % (entry["isr"], entry["path"]))
+            most = max(b["count"] for b in entry["histogram"])
+            for b in entry["histogram"]:
+                bar = "#" * int(round(40.0 * b["count"] / most))
+                print("%10d - %10d %8d %s" % (b["low"], b["high"], b["count"], bar))
+    if args.csv:
+        writeCsv(args.csv, header, rows)
+    if args.json:
+        writeJson(args.json, data)
+    return 0
+
+
+def cmdDiff(args):
+    runA = readRun(args.logA, not args.raw)
+    runB = readRun(args.logB, not args.raw)
+    groupsA = dict(((isr, path), samples) for isr, path, samples in runA.groups())
+    groupsB = dict(((isr, path), samples) for isr, path, samples in runB.groups())
+
+    header = ["isr", "path", "countA", "countB", "medianA", "medianB", "p99A", "p99B",
+              "maxA", "maxB", "change%", "p", "verdict"]
+    rows = []
+    data = {"logA": runA.name, "logB": runB.name, "threshold": args.threshold,
+            "alpha": args.alpha, "isrs": []}
+    significant = 0
+    for key in sorted(set(groupsA) | set(groupsB)):
+        if key not in groupsA or key not in groupsB:
+            which = "B" if key in groupsB else "A"
+            rows.append(list(key) + ["-"] * 10 + ["only " + which])
+            data["isrs"].append({"isr": key[0], "path": key[1], "verdict": "only " + which})
+            continue
+        sa = summarise(groupsA[key])
+        sb = summarise(groupsB[key])
+        change = 100.0 * (sb["median"] - sa["median"]) / sa["median"] if sa["median"] else 0.0
+        p = mannWhitney(groupsA[key], groupsB[key])
+        if p < args.alpha and abs(change) >= args.threshold:
+            verdict = "slower" if change > 0 else "faster"
+            significant += 1
+        else:
+            verdict = "same"
+        rows.append(list(key) + [sa["count"], sb["count"], sa["median"], sb["median"],
+                                 sa["p99"], sb["p99"], sa["max"], sb["max"],
+                                 change, "%.3g" % p, verdict])
+        data["isrs"].append({"isr": key[0], "path": key[1], "A": sa, "B": sb,
+                             "change": change, "p": p, "verdict": verdict})
+
+    print("A: %s (base %s)" % (runA.name, runA.base))
+    print("B: %s (base %s)" % (runB.name, runB.base))
+    printTable(header, rows)
+    if args.csv:
+        writeCsv(args.csv, header, rows)
+    if args.json:
+        writeJson(args.json, data)
+    # Like diff(1): 1 if there are significant differences
+    return 1 if significant > 0 else 0
+
+################################################################################
+
+def createParser():
+    parser = argparse.ArgumentParser(description = "Analysis of EMS performance logs",
+                                     epilog = "Use - as log name to read from standard input.")
+    sub = parser.add_subparsers(dest = "command")
+    sub.required = True
+
+    stats = sub.add_parser("stats", help = "Statistics per ISR and execution path")
+    stats.add_argument("log", help = "Performance log")
+    stats.add_argument("--hist", action = "store_true",
+                       help = "Print a histogram for every ISR and path")
+    stats.add_argument("--bins", type = int, default = 20,
+                       help = "Number of histogram bins (default is 20)")
+
+    diff = sub.add_parser("diff", help = "Compare two runs")
+    diff.add_argument("logA", help = "Reference performance log")
+    diff.add_argument("logB", help = "Performance log compared to the reference")
+    diff.add_argument("--threshold", type = float, default = 5.0,
+                      help = "Minimum change of the median in percent to be reported (default is 5)")
+    diff.add_argument("--alpha", type = float, default = 0.01,
+                      help = "Significance level of the Mann-Whitney U test (default is 0.01)")
+
+    for p in (stats, diff):
+        p.add_argument("--raw", action = "store_true",
+                       help = "Do not subtract the base measurement (**MeasB)")
+        p.add_argument("--csv", metavar = "FILE", help = "Write the table to FILE as CSV")
+        p.add_argument("--json", metavar = "FILE", help = "Write the results to FILE as JSON")
+    return parser
+
+
+def main():
+    args = createParser().parse_args()
+    if args.command == "stats":
+        return cmdStats(args)
+    return cmdDiff(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())